@@ -0,0 +1,107 @@
+#ifndef BENCH_HARNESS_H
+#define BENCH_HARNESS_H
+// 基准测试计时工具(只给bench目录下的程序用)
+// 每个测试先把迭代次数翻倍直到一次运行超过最短时间,再用这个次数重复运行几次取最快的一次
+#include <SDL3/SDL.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#define DEFALUT_BENCH_MIN_SECONDS 0.1 // 每次运行的最短时间
+#define DEFALUT_BENCH_REPEATS 5       // 重复运行次数(取最快的一次)
+#define MAX_BENCH_RESULTS 64
+#define MAX_BENCH_NAME 64
+
+// 测试函数:执行iterations次被测操作,返回生成的三角形数量(不生成几何的操作返回0)
+typedef long long (*BenchFunction)(void *userData, long long iterations);
+
+typedef struct
+{
+    char name[MAX_BENCH_NAME];
+    long long iterations;   // 最快的一次运行的迭代次数
+    double nsPerOp;         // 每次操作的纳秒数
+    double trianglesPerSec; // 每秒生成的三角形数量
+} BenchResult;
+
+typedef struct
+{
+    BenchResult results[MAX_BENCH_RESULTS];
+    int count;
+    double minSeconds;
+    int repeats;
+} BenchHarness;
+
+// 防止编译器把没有使用的计算结果优化掉
+static volatile float g_benchSink;
+
+static inline void BenchHarness_Init(BenchHarness *harness, double minSeconds, int repeats)
+{
+    memset(harness, 0, sizeof(BenchHarness));
+    harness->minSeconds = minSeconds > 0 ? minSeconds : DEFALUT_BENCH_MIN_SECONDS;
+    harness->repeats = repeats > 0 ? repeats : DEFALUT_BENCH_REPEATS;
+}
+
+static inline double BenchHarness_Time(BenchFunction function, void *userData, long long iterations, long long *triangles)
+{
+    Uint64 begin = SDL_GetPerformanceCounter();
+    *triangles = function(userData, iterations);
+    return (SDL_GetPerformanceCounter() - begin) / (double)SDL_GetPerformanceFrequency();
+}
+
+// 运行一个测试并记录结果,同时打印一行
+static inline const BenchResult *BenchHarness_Run(BenchHarness *harness, const char *name, BenchFunction function, void *userData)
+{
+    if (harness->count >= MAX_BENCH_RESULTS) return NULL;
+
+    // 确定迭代次数
+    long long iterations = 1;
+    long long triangles = 0;
+    while (BenchHarness_Time(function, userData, iterations, &triangles) < harness->minSeconds && iterations < (1ll << 40))
+    {
+        iterations *= 2;
+    }
+
+    // 重复运行,取最快的一次
+    double best = 0;
+    long long bestTriangles = 0;
+    for (int r = 0; r < harness->repeats; r++)
+    {
+        double seconds = BenchHarness_Time(function, userData, iterations, &triangles);
+        if (r == 0 || seconds < best)
+        {
+            best = seconds;
+            bestTriangles = triangles;
+        }
+    }
+
+    BenchResult *result = &harness->results[harness->count++];
+    snprintf(result->name, sizeof(result->name), "%s", name);
+    result->iterations = iterations;
+    result->nsPerOp = best * 1e9 / iterations;
+    result->trianglesPerSec = best > 0 ? bestTriangles / best : 0;
+    printf("%-36s %12.2f ns/op %14.0f tris/s %12lld iters\n", result->name, result->nsPerOp, result->trianglesPerSec, result->iterations);
+    fflush(stdout);
+    return result;
+}
+
+// 把所有结果写成JSON文件
+static inline bool BenchHarness_WriteJSON(const BenchHarness *harness, const char *path)
+{
+    FILE *file = fopen(path, "w");
+    if (!file)
+    {
+        fprintf(stderr, "无法写入%s\n", path);
+        return false;
+    }
+    fprintf(file, "{\n  \"min_seconds\": %g,\n  \"repeats\": %d,\n  \"benchmarks\": [\n", harness->minSeconds, harness->repeats);
+    for (int i = 0; i < harness->count; i++)
+    {
+        const BenchResult *result = &harness->results[i];
+        fprintf(file, "    {\"name\": \"%s\", \"iterations\": %lld, \"ns_per_op\": %.3f, \"triangles_per_sec\": %.0f}%s\n", result->name, result->iterations, result->nsPerOp, result->trianglesPerSec, i + 1 < harness->count ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    fclose(file);
+    return true;
+}
+
+#endif // BENCH_HARNESS_H
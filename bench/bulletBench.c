@@ -0,0 +1,161 @@
+// 子弹池基准测试:对比旧的结构体数组(AoS)逐个更新+逐个删除,和新的结构数组(SoA)向量化更新+批量压缩
+// 用法: bulletBench [逻辑帧数] [角色数量]
+#include "character.h"
+#include "presets.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define DEFALUT_BENCH_TICKS 2000
+#define DEFALUT_BENCH_CHARACTERS 16
+
+// 旧版子弹池的复刻(改动前的内存布局和更新方式,宽阶段同样查询网格),作为对照组
+typedef struct
+{
+    int bulletCount;
+    Bullet bullets[MAX_BULLET_COUNT];
+} AoSBulletPool;
+
+static void AoSBulletPool_Add(AoSBulletPool *pool, Bullet bullet)
+{
+    if (pool->bulletCount == MAX_BULLET_COUNT)
+    {
+        pool->bullets[0] = bullet;
+        return;
+    }
+    pool->bullets[pool->bulletCount++] = bullet;
+}
+
+static void AoSBulletPool_Remove(AoSBulletPool *pool, int index)
+{
+    pool->bullets[index] = pool->bullets[pool->bulletCount - 1];
+    pool->bulletCount--;
+}
+
+static bool AoSBullet_Update(Bullet *bullet, CharacterPool *characterPool)
+{
+    float lastX = bullet->x;
+    float lastY = bullet->y;
+    bullet->x += bullet->speed * bullet->direction.x;
+    bullet->y += bullet->speed * bullet->direction.y;
+    float radius = bullet->radius;
+    AABBBox box = {fminf(lastX, bullet->x) - radius, fmaxf(lastX, bullet->x) + radius, fminf(lastY, bullet->y) - radius, fmaxf(lastY, bullet->y) + radius};
+    Character *self = CharacterPool_Get(characterPool, 0);
+    if (self && bullet->flyCount > BULLET_SELF_HIT_DELAY && Bullet_Character_Collision(bullet->x, bullet->y, lastX, lastY, radius, self))
+    {
+        damage(self, bullet->damage, 0.25f);
+        return true;
+    }
+    int hitIndex = -1;
+    SpatialGridQuery query;
+    SpatialGrid_QueryBegin(&characterPool->grid, box, &query);
+    int i;
+    while ((i = SpatialGrid_QueryNext(&characterPool->grid, &query)) >= 0)
+    {
+        if (i == 0 || (hitIndex >= 0 && i > hitIndex)) continue;
+        Character *character = CharacterPool_Get(characterPool, i);
+        if (character && Bullet_Character_Collision(bullet->x, bullet->y, lastX, lastY, radius, character))
+        {
+            hitIndex = i;
+        }
+    }
+    if (hitIndex > 0)
+    {
+        damage(CharacterPool_Get(characterPool, hitIndex), bullet->damage, 1.0f);
+        return true;
+    }
+    bullet->flyCount++;
+    return bullet->flyCount > Max_FLY_COUNT;
+}
+
+static void AoSBulletPool_Update(AoSBulletPool *pool, CharacterPool *characterPool)
+{
+    for (int i = 0; i < pool->bulletCount; i++)
+    {
+        if (AoSBullet_Update(&pool->bullets[i], characterPool))
+        {
+            AoSBulletPool_Remove(pool, i);
+            i--;
+        }
+    }
+}
+
+// 生成一颗随机子弹,初始飞行帧数随机,让每一帧都有子弹到期
+static Bullet RandomBullet(void)
+{
+    Bullet bullet = {10, 20, 10, {1, 1, 1, 1}, 0, {0, 0}, 0, 0};
+    float angle = (float)(rand() % 6283) / 1000.0f;
+    bullet.direction = (Vector){SDL_cosf(angle), SDL_sinf(angle)};
+    bullet.x = (float)(rand() % 20000 - 10000);
+    bullet.y = (float)(rand() % 20000 - 10000);
+    bullet.flyCount = rand() % Max_FLY_COUNT;
+    return bullet;
+}
+
+static CharacterPool *CreatCharacters(int count)
+{
+    static CharacterPool pool;
+    CharacterPool_Init(&pool, count + 1);
+    SDL_FColor color = {1, 1, 1, 1};
+    for (int i = 0; i < count + 1; i++)
+    {
+        Vector direction = {(float)(rand() % 200 - 100), (float)(rand() % 200 - 100)};
+        CharacterPool_Creat(&pool, SNAKE, (float)(rand() % 20000 - 10000), (float)(rand() % 20000 - 10000), direction, 0, SNAKE1_radiusList, SNAKE1_distanceList, SNAKE1_flexibility, SNAKE1_bodyCount, color, color, NULL);
+    }
+    CharacterPool_RebuildGrid(&pool);
+    return &pool;
+}
+
+int main(int argc, char **argv)
+{
+    int ticks = argc > 1 ? atoi(argv[1]) : DEFALUT_BENCH_TICKS;
+    int characterCount = argc > 2 ? atoi(argv[2]) : DEFALUT_BENCH_CHARACTERS;
+    if (ticks <= 0) ticks = DEFALUT_BENCH_TICKS;
+    if (characterCount < 0) characterCount = 0;
+
+    // 子弹池很大,放在堆上
+    AoSBulletPool *aos = malloc(sizeof(AoSBulletPool));
+    BulletPool *soa = malloc(sizeof(BulletPool));
+    if (!aos || !soa)
+    {
+        fprintf(stderr, "bulletBench: out of memory\n");
+        return 1;
+    }
+    srand(1);
+    CharacterPool *characters = CreatCharacters(characterCount);
+
+    // 两组使用同样的随机序列,每帧都把子弹池补满
+    double elapsed[2] = {0, 0};
+    long long updated[2] = {0, 0};
+    for (int pass = 0; pass < 2; pass++)
+    {
+        srand(2);
+        aos->bulletCount = 0;
+        BulletPool_Init(soa);
+        for (int t = 0; t < ticks; t++)
+        {
+            int count = pass == 0 ? aos->bulletCount : soa->bulletCount;
+            for (int i = count; i < MAX_BULLET_COUNT; i++)
+            {
+                if (pass == 0) AoSBulletPool_Add(aos, RandomBullet());
+                else BulletPool_Add(soa, RandomBullet());
+            }
+            updated[pass] += MAX_BULLET_COUNT;
+            Uint64 start = SDL_GetPerformanceCounter();
+            if (pass == 0) AoSBulletPool_Update(aos, characters);
+            else BulletPool_Update(soa, characters);
+            elapsed[pass] += (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+        }
+    }
+
+    printf("bullets=%d ticks=%d characters=%d\n", MAX_BULLET_COUNT, ticks, characterCount + 1);
+    printf("%-12s %12s %16s\n", "layout", "total ms", "bullets/ms");
+    printf("%-12s %12.2f %16.0f\n", "AoS (old)", elapsed[0], updated[0] / elapsed[0]);
+    printf("%-12s %12.2f %16.0f\n", "SoA (new)", elapsed[1], updated[1] / elapsed[1]);
+    printf("speedup: %.2fx\n", elapsed[0] / elapsed[1]);
+
+    CharacterPool_Destroy(characters);
+    free(aos);
+    free(soa);
+    return 0;
+}
@@ -0,0 +1,189 @@
+// 流场基准测试:场地中间有一道挡在敌人和玩家之间的墙,敌人必须绕过墙的两端
+// 计时之前先检查寻路结果:墙里的格子查询失败,墙后的格子不会直接朝玩家走,从墙后沿流场一步步走能绕到玩家身边且不进入墙,不正确时返回1
+// 然后测量整个流场重新计算一次和N个敌人查询方向的耗时
+// 用法: flowBench [重新计算次数] [敌人数量...]
+#include "flowField.h"
+#include "rng.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFALUT_BENCH_UPDATES 200
+#define DEFALUT_BENCH_SEED 1
+#define BENCH_ARENA_HALF_SIZE 6400.0f // 场地半边长(和游戏里墙围住的场地差不多大)
+#define BENCH_WALK_MAX_STEPS 2000     // 检查时沿流场最多走的步数
+#define MAX_BENCH_SWEEP 32
+
+static const int DEFALUT_BENCH_SWEEP[] = {1000, 4000, 16000};
+
+// 玩家在原点,墙是x在[1000,1256]之间,y在[-3000,3000]之间的竖条;墙比格子宽,走半个格子不会跳过墙
+static const SDL_FPoint benchTarget = {0.0f, 0.0f};
+static const AABBBox benchWall = {1000.0f, 1256.0f, -3000.0f, 3000.0f};
+
+// 防止编译器把没有使用的计算结果优化掉
+static volatile float g_benchSink;
+
+static bool Bench_InWall(SDL_FPoint p) { return p.x >= benchWall.minX && p.x <= benchWall.maxX && p.y >= benchWall.minY && p.y <= benchWall.maxY; }
+
+// 从start沿流场每次走半个格子,检查能在限定步数里走到玩家所在的格子,途中不进入墙
+static bool Check_Walk(const FlowField *field, SDL_FPoint start)
+{
+    const float step = field->cellSize * 0.5f;
+    SDL_FPoint p = start;
+    for (int i = 0; i < BENCH_WALK_MAX_STEPS; i++)
+    {
+        if (Bench_InWall(p))
+        {
+            fprintf(stderr, "流场检查失败: 从(%g, %g)出发走进了墙里(%g, %g)\n", start.x, start.y, p.x, p.y);
+            return false;
+        }
+        float dx = p.x - benchTarget.x, dy = p.y - benchTarget.y;
+        if (dx * dx + dy * dy <= field->cellSize * field->cellSize) return true;
+
+        Vector direction;
+        if (!FlowField_Sample(field, p, benchTarget, &direction))
+        {
+            fprintf(stderr, "流场检查失败: 从(%g, %g)出发在(%g, %g)查询不到方向\n", start.x, start.y, p.x, p.y);
+            return false;
+        }
+        vector_Normalization(&direction);
+        p.x += direction.x * step;
+        p.y += direction.y * step;
+    }
+    fprintf(stderr, "流场检查失败: 从(%g, %g)出发走了%d步还没到玩家身边\n", start.x, start.y, BENCH_WALK_MAX_STEPS);
+    return false;
+}
+
+// 检查墙后的寻路
+static bool Check_FlowField(FlowField *field)
+{
+    Vector direction;
+    if (FlowField_Sample(field, (SDL_FPoint){(benchWall.minX + benchWall.maxX) * 0.5f, 0.0f}, benchTarget, &direction))
+    {
+        fprintf(stderr, "流场检查失败: 墙里的格子查询到了方向\n");
+        return false;
+    }
+
+    // 墙正后方的格子被墙挡住,不能直接朝玩家走(直接走会撞墙)
+    SDL_FPoint behind = {benchWall.maxX + field->cellSize * 2.0f, 0.0f};
+    if (!FlowField_Sample(field, behind, benchTarget, &direction))
+    {
+        fprintf(stderr, "流场检查失败: 墙后的格子查询不到方向\n");
+        return false;
+    }
+    Vector straight = vector_get(behind.x, behind.y, benchTarget.x, benchTarget.y);
+    vector_Normalization(&straight);
+    vector_Normalization(&direction);
+    if (vector_dot(direction, straight) > 0.99f)
+    {
+        fprintf(stderr, "流场检查失败: 墙后的格子直接朝玩家走\n");
+        return false;
+    }
+
+    // 墙后一排出发点(包括正后方和靠近墙两端的位置),以及墙前不受影响的点
+    for (float y = benchWall.minY; y <= benchWall.maxY; y += 500.0f)
+    {
+        if (!Check_Walk(field, (SDL_FPoint){benchWall.maxX + 400.0f, y})) return false;
+        if (!Check_Walk(field, (SDL_FPoint){benchWall.maxX + 2000.0f, y})) return false;
+    }
+    return Check_Walk(field, (SDL_FPoint){-3000.0f, 2000.0f});
+}
+
+// N个敌人随机分布在场地里,每个敌人查询一次方向
+static void Bench_Sample(const FlowField *field, int enemyCount, int repeats)
+{
+    SDL_FPoint *positions = (SDL_FPoint *)malloc(sizeof(SDL_FPoint) * enemyCount);
+    if (!positions)
+    {
+        fprintf(stderr, "内存分配失败: %d\n", enemyCount);
+        return;
+    }
+    Rng rng;
+    Rng_Seed(&rng, DEFALUT_BENCH_SEED);
+    for (int i = 0; i < enemyCount; i++)
+    {
+        positions[i] = (SDL_FPoint){(Rng_Float(&rng) * 2.0f - 1.0f) * BENCH_ARENA_HALF_SIZE, (Rng_Float(&rng) * 2.0f - 1.0f) * BENCH_ARENA_HALF_SIZE};
+    }
+
+    int routed = 0;
+    float sum = 0;
+    Uint64 begin = SDL_GetPerformanceCounter();
+    for (int r = 0; r < repeats; r++)
+    {
+        for (int i = 0; i < enemyCount; i++)
+        {
+            Vector direction;
+            if (FlowField_Sample(field, positions[i], benchTarget, &direction)) sum += direction.x;
+        }
+    }
+    double seconds = (SDL_GetPerformanceCounter() - begin) / (double)SDL_GetPerformanceFrequency();
+    g_benchSink = sum;
+
+    // 统计需要绕路(不是直接朝玩家走)的敌人
+    for (int i = 0; i < enemyCount; i++)
+    {
+        int x = (int)SDL_floorf((positions[i].x - field->minX) * field->invCellSize);
+        int y = (int)SDL_floorf((positions[i].y - field->minY) * field->invCellSize);
+        if (x < 0 || y < 0 || x >= field->width || y >= field->height) continue;
+        int cell = y * field->width + x;
+        if (field->cost[cell] != INT_MAX && !field->direct[cell]) routed++;
+    }
+    printf("%7d %8d %12.3f %12.2f\n", enemyCount, routed, seconds * 1000.0 / repeats, seconds * 1e9 / ((double)repeats * enemyCount));
+    fflush(stdout);
+    free(positions);
+}
+
+int main(int argc, char *argv[])
+{
+    int updates = argc > 1 ? atoi(argv[1]) : DEFALUT_BENCH_UPDATES;
+    if (updates <= 0) updates = DEFALUT_BENCH_UPDATES;
+
+    int sweep[MAX_BENCH_SWEEP];
+    int sweepCount = 0;
+    for (int i = 2; i < argc && sweepCount < MAX_BENCH_SWEEP; i++)
+    {
+        int n = atoi(argv[i]);
+        if (n > 0) sweep[sweepCount++] = n;
+    }
+    if (sweepCount == 0)
+    {
+        sweepCount = (int)SDL_arraysize(DEFALUT_BENCH_SWEEP);
+        memcpy(sweep, DEFALUT_BENCH_SWEEP, sizeof(DEFALUT_BENCH_SWEEP));
+    }
+
+    const AABBBox bounds = {-BENCH_ARENA_HALF_SIZE, BENCH_ARENA_HALF_SIZE, -BENCH_ARENA_HALF_SIZE, BENCH_ARENA_HALF_SIZE};
+    FlowField *field = FlowField_Create(bounds, DEFALUT_FLOW_FIELD_CELL_SIZE);
+    if (!field)
+    {
+        fprintf(stderr, "流场创建失败\n");
+        return 1;
+    }
+    FlowField_AddObstacle(field, benchWall);
+    FlowField_Update(field, benchTarget);
+    if (!Check_FlowField(field))
+    {
+        FlowField_Destroy(field);
+        return 1;
+    }
+
+    // 整个流场重新计算(玩家每走进一个新格子一次)
+    Uint64 begin = SDL_GetPerformanceCounter();
+    for (int i = 0; i < updates; i++)
+    {
+        FlowField_Invalidate(field);
+        FlowField_Update(field, benchTarget);
+    }
+    double seconds = (SDL_GetPerformanceCounter() - begin) / (double)SDL_GetPerformanceFrequency();
+    printf("格子: %dx%d, 重新计算%d次, 每次%.3f毫秒\n", field->width, field->height, updates, seconds * 1000.0 / updates);
+
+    printf("routed为需要绕墙的敌人数量, sample为所有敌人查询一次的毫秒数和每次查询的纳秒数\n");
+    printf("%7s %8s %12s %12s\n", "N", "routed", "sampleMs", "ns/sample");
+    for (int i = 0; i < sweepCount; i++)
+    {
+        Bench_Sample(field, sweep[i], updates);
+    }
+
+    FlowField_Destroy(field);
+    return 0;
+}
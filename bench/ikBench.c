@@ -0,0 +1,157 @@
+// 腿部求解基准测试:对比FABRIK迭代(LEG_SOLVER_FABRIK)和余弦定理解析解(LEG_SOLVER_ANALYTIC)
+// 两个角色池用同样的种子生成同样的蜥蜴,身体运动完全相同,只有腿的求解方式不同;只计时Character_UpdateLimbs
+// 同时统计两种方式脚和膝盖的位置差异(膝盖翻到另一侧时差异接近两倍腿长)
+// 用法: ikBench [逻辑帧数] [蜥蜴数量...]
+#include "character.h"
+#include "presets.h"
+#include "rng.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFALUT_BENCH_TICKS 600
+#define DEFALUT_BENCH_WARMUP_TICKS 60
+#define DEFALUT_BENCH_SPACING 300.0f // 每个蜥蜴平均占据的边长
+#define DEFALUT_BENCH_SEED 1          // 固定种子(每次运行生成的场景完全相同)
+#define MAX_BENCH_SWEEP 32
+
+static const int DEFALUT_BENCH_SWEEP[] = {1000, 2000, 4000, 8000};
+
+// 往已经初始化的池里生成count个蜥蜴,全部使用solver求解腿(每次用同样的种子,两个池里的蜥蜴完全相同)
+static bool Bench_SpawnLizards(CharacterPool *pool, int count, enum LegSolver solver)
+{
+    Rng rng;
+    Rng_Seed(&rng, DEFALUT_BENCH_SEED);
+    float size = sqrtf((float)count) * DEFALUT_BENCH_SPACING;
+    for (int i = 0; i < count; i++)
+    {
+        float x = (Rng_Float(&rng) - 0.5f) * size;
+        float y = (Rng_Float(&rng) - 0.5f) * size;
+        float angle = Rng_Float(&rng) * 6.2831853f;
+        float speed = 3.0f + Rng_Float(&rng) * 3.0f;
+        Character *lizard = CharacterPool_Creat(pool, LIZARD, x, y, (Vector){cosf(angle), sinf(angle)}, speed, LIZARD_radiusList, LIZARD_distanceList, LIZARD_flexibility, LIZARD_bodyCount, (SDL_FColor){1, 1, 1, 1}, (SDL_FColor){1, 1, 1, 1}, LIZARD_legs);
+        if (!lizard) return false;
+        lizard->legSolver = solver;
+    }
+    return true;
+}
+
+// 移动所有蜥蜴的身体(每个蜥蜴按自己的节奏左右转弯,两个池的运动完全相同)
+static void Bench_MoveBodies(CharacterPool *pool, int tick)
+{
+    for (int i = 0; i < pool->size; i++)
+    {
+        if ((tick / 40 + i) % 3 == 0)
+            Character_turn_left(&pool->characters[i]);
+        else if ((tick / 40 + i) % 3 == 1)
+            Character_turn_right(&pool->characters[i]);
+    }
+    Character_UpdateBodies(pool->characters, pool->size);
+}
+
+// 只更新腿,返回耗时(计数器单位)
+static Uint64 Bench_UpdateLegs(CharacterPool *pool)
+{
+    Uint64 begin = SDL_GetPerformanceCounter();
+    for (int i = 0; i < pool->size; i++)
+    {
+        Character_UpdateLimbs(&pool->characters[i]);
+    }
+    return SDL_GetPerformanceCounter() - begin;
+}
+
+// 两点距离
+static float Bench_Distance(SDL_FPoint a, SDL_FPoint b)
+{
+    return sqrtf((a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y));
+}
+
+static void Bench_Run(int lizardCount, int ticks)
+{
+    // 分配失败时CharacterPool_Init直接退出,所以两个池在这之后都可以销毁
+    CharacterPool fabrik, analytic;
+    CharacterPool_Init(&fabrik, lizardCount);
+    CharacterPool_Init(&analytic, lizardCount);
+    if (!Bench_SpawnLizards(&fabrik, lizardCount, LEG_SOLVER_FABRIK) || !Bench_SpawnLizards(&analytic, lizardCount, LEG_SOLVER_ANALYTIC))
+    {
+        fprintf(stderr, "生成蜥蜴失败: %d\n", lizardCount);
+        CharacterPool_Destroy(&fabrik);
+        CharacterPool_Destroy(&analytic);
+        return;
+    }
+
+    Uint64 fabrikTime = 0, analyticTime = 0;
+    float maxFootError = 0.0f, maxKneeError = 0.0f;
+    double footErrorSum = 0.0, kneeErrorSum = 0.0;
+    long long legCount = 0;
+    for (int t = 0; t < DEFALUT_BENCH_WARMUP_TICKS + ticks; t++)
+    {
+        Bench_MoveBodies(&fabrik, t);
+        Bench_MoveBodies(&analytic, t);
+        // 两种方式每帧从同样的腿开始求解(否则踏步时机不同,误差会一直累积),比较的是单次求解的差异
+        for (int i = 0; i < lizardCount; i++)
+        {
+            memcpy(analytic.characters[i].legs, fabrik.characters[i].legs, sizeof(fabrik.characters[i].legs));
+        }
+        Uint64 fabrikTick = Bench_UpdateLegs(&fabrik);
+        Uint64 analyticTick = Bench_UpdateLegs(&analytic);
+        if (t < DEFALUT_BENCH_WARMUP_TICKS) continue;
+        fabrikTime += fabrikTick;
+        analyticTime += analyticTick;
+
+        for (int i = 0; i < lizardCount; i++)
+        {
+            for (int leg = 0; leg < 4; leg++)
+            {
+                const Chain3 *a = &fabrik.characters[i].legs[leg];
+                const Chain3 *b = &analytic.characters[i].legs[leg];
+                float footError = Bench_Distance(a->head, b->head);
+                float kneeError = Bench_Distance(a->middle, b->middle);
+                maxFootError = SDL_max(maxFootError, footError);
+                maxKneeError = SDL_max(maxKneeError, kneeError);
+                footErrorSum += footError;
+                kneeErrorSum += kneeError;
+                legCount++;
+            }
+        }
+    }
+
+    double msPerCount = 1000.0 / (double)SDL_GetPerformanceFrequency() / ticks;
+    double fabrikMs = fabrikTime * msPerCount;
+    double analyticMs = analyticTime * msPerCount;
+    legCount = SDL_max(legCount, 1);
+    printf("%7d %10.3f %10.3f %8.2fx %9.3f %9.3f %9.3f %9.3f\n", lizardCount, fabrikMs, analyticMs, analyticMs > 0 ? fabrikMs / analyticMs : 0.0, footErrorSum / legCount, maxFootError, kneeErrorSum / legCount, maxKneeError);
+    fflush(stdout);
+
+    CharacterPool_Destroy(&fabrik);
+    CharacterPool_Destroy(&analytic);
+}
+
+int main(int argc, char *argv[])
+{
+    int ticks = argc > 1 ? atoi(argv[1]) : DEFALUT_BENCH_TICKS;
+    if (ticks <= 0) ticks = DEFALUT_BENCH_TICKS;
+
+    int sweep[MAX_BENCH_SWEEP];
+    int sweepCount = 0;
+    for (int i = 2; i < argc && sweepCount < MAX_BENCH_SWEEP; i++)
+    {
+        int n = atoi(argv[i]);
+        if (n > 0) sweep[sweepCount++] = n;
+    }
+    if (sweepCount == 0)
+    {
+        sweepCount = (int)SDL_arraysize(DEFALUT_BENCH_SWEEP);
+        memcpy(sweep, DEFALUT_BENCH_SWEEP, sizeof(DEFALUT_BENCH_SWEEP));
+    }
+
+    printf("逻辑帧: %d (预热%d), 只计时Character_UpdateLimbs\n", ticks, DEFALUT_BENCH_WARMUP_TICKS);
+    printf("fabrik和analytic为每帧平均毫秒数, foot/knee为两种方式脚和膝盖的平均/最大位置差异\n");
+    printf("%7s %10s %10s %9s %9s %9s %9s %9s\n", "N", "fabrik", "analytic", "speedup", "footAvg", "footMax", "kneeAvg", "kneeMax");
+    for (int i = 0; i < sweepCount; i++)
+    {
+        Bench_Run(sweep[i], ticks);
+    }
+    return 0;
+}
@@ -0,0 +1,287 @@
+// 基础图元的微基准测试:批次,多边形,相机变换和向量运算
+// 输出每次操作的纳秒数和每秒生成的三角形数量,并写入JSON文件,方便对比引擎改动前后的结果
+// 用法: microBench [输出JSON路径] [每次运行的最短毫秒数]
+// 计时之前先检查耳切法三角化的结果,不正确时返回1
+#include "benchHarness.h"
+#include "batchingRender.h"
+#include "camera.h"
+#include "polygon.h"
+#include "vector.h"
+#include <math.h>
+#include <stdlib.h>
+
+#define DEFALUT_BENCH_OUTPUT "microBench.json"
+#define BENCH_FLUSH_INTERVAL 1024     // 每画这么多次清空一次批次,批次大小保持稳定
+#define BENCH_POLYLINE_POINTS 32      // 折线的点数
+#define BENCH_TRANSFORM_VERTICES 4096 // 变换测试的顶点数量
+#define BENCH_TRIANGULATE_POINTS 64   // 三角化测试的多边形顶点数量(凹的星形)
+#define MAX_CHECK_POLYGON_POINTS 16   // 三角化检查用的多边形最多顶点数
+
+typedef struct
+{
+    BatchRenderer *batch;
+    Camera *camera;
+    float radius; // 圆的半径
+    SDL_FPoint polyline[BENCH_POLYLINE_POINTS];
+    SDL_FPoint star[BENCH_TRIANGULATE_POINTS];
+    int triangulateIndices[(BENCH_TRIANGULATE_POINTS - 2) * 3];
+} BenchContext;
+
+static const SDL_FColor benchColor = {0.2f, 0.6f, 0.9f, 1.0f};
+
+// 统计批次里的三角形并清空(重新设置相机)
+static long long Bench_FlushBatch(BenchContext *context)
+{
+    int triangles = 0;
+    Batch_GetStats(context->batch, NULL, NULL, &triangles);
+    Batch_Clear(context->batch);
+    Batch_SetCamera(context->batch, context->camera);
+    return triangles;
+}
+
+static long long Bench_AddTriangle(void *userData, long long iterations)
+{
+    BenchContext *context = userData;
+    long long triangles = 0;
+    for (long long i = 0; i < iterations; i++)
+    {
+        if (i % BENCH_FLUSH_INTERVAL == 0) triangles += Bench_FlushBatch(context);
+        float x = (float)(i & 255);
+        SDL_FPoint p1 = {x, 0}, p2 = {x + 10, 0}, p3 = {x, 10};
+        Batch_AddTriangle(context->batch, &p1, &p2, &p3, benchColor);
+    }
+    return triangles + Bench_FlushBatch(context);
+}
+
+static long long Bench_DrawCircle(void *userData, long long iterations)
+{
+    BenchContext *context = userData;
+    long long triangles = 0;
+    for (long long i = 0; i < iterations; i++)
+    {
+        if (i % BENCH_FLUSH_INTERVAL == 0) triangles += Bench_FlushBatch(context);
+        Polygon_DrawCircle(context->batch, (float)(i & 255), 0, context->radius, benchColor, context->camera);
+    }
+    return triangles + Bench_FlushBatch(context);
+}
+
+static long long Bench_DrawLines(void *userData, long long iterations)
+{
+    BenchContext *context = userData;
+    long long triangles = 0;
+    for (long long i = 0; i < iterations; i++)
+    {
+        if (i % BENCH_FLUSH_INTERVAL == 0) triangles += Bench_FlushBatch(context);
+        Polygon_DrawLines(context->batch, context->polyline, BENCH_POLYLINE_POINTS, 4.0f, benchColor, context->camera);
+    }
+    return triangles + Bench_FlushBatch(context);
+}
+
+// 旋转的精灵矩形(枪,道具),只生成顶点,所有精灵共用一次drawcall
+static long long Bench_AddSprite(void *userData, long long iterations)
+{
+    BenchContext *context = userData;
+    const SDL_FRect uv = {0.0f, 0.0f, 0.25f, 0.25f};
+    long long triangles = 0;
+    for (long long i = 0; i < iterations; i++)
+    {
+        if (i % BENCH_FLUSH_INTERVAL == 0) triangles += Bench_FlushBatch(context);
+        Batch_AddSprite(context->batch, &uv, (SDL_FPoint){(float)(i & 255), 0}, 40.0f, 80.0f, (float)(i % 360), benchColor);
+    }
+    return triangles + Bench_FlushBatch(context);
+}
+
+// 一次操作变换BENCH_TRANSFORM_VERTICES个顶点(Batch_Render里的变换阶段)
+static long long Bench_TransformVertices(void *userData, long long iterations)
+{
+    BenchContext *context = userData;
+    BatchRenderer *batch = context->batch;
+    Bench_FlushBatch(context);
+    BatchSpan span;
+    if (!Batch_Reserve(batch, BENCH_TRANSFORM_VERTICES, 0, &span)) return 0;
+    for (int i = 0; i < BENCH_TRANSFORM_VERTICES; i++)
+    {
+        Batch_WriteVertex(&span.vertices[i], (float)(i & 1023), (float)(i >> 10), benchColor);
+    }
+    for (long long i = 0; i < iterations; i++)
+    {
+        batch->transformedCount = 0; // 让同一批顶点重新变换
+        Batch_TransformVertices(batch);
+    }
+    g_benchSink = batch->vertices[0].position.x;
+    Bench_FlushBatch(context);
+    return 0;
+}
+
+// 静态几何注册时的三角化(耳切法,最坏O(n^3))
+static long long Bench_Triangulate(void *userData, long long iterations)
+{
+    BenchContext *context = userData;
+    long long triangles = 0;
+    for (long long i = 0; i < iterations; i++)
+    {
+        triangles += Polygon_Triangulate(context->star, BENCH_TRIANGULATE_POINTS, context->triangulateIndices);
+    }
+    g_benchSink = (float)context->triangulateIndices[0];
+    return triangles;
+}
+
+// 有向面积的两倍(逆时针为正)
+static float Check_Cross(SDL_FPoint a, SDL_FPoint b, SDL_FPoint c) { return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x); }
+
+// 检查一个多边形的三角化结果:三角形数量不超过n-2(共线点不生成三角形),下标在范围内,每个三角形都是逆时针且不退化,面积之和等于多边形面积
+static bool Check_Triangulate(const char *name, const SDL_FPoint *points, int pointCount)
+{
+    int indices[(MAX_CHECK_POLYGON_POINTS - 2) * 3];
+    int triangleCount = Polygon_Triangulate(points, pointCount, indices);
+    if (triangleCount <= 0 || triangleCount > pointCount - 2)
+    {
+        fprintf(stderr, "三角化检查失败(%s): 三角形数量%d,最多应为%d\n", name, triangleCount, pointCount - 2);
+        return false;
+    }
+
+    float polygonArea = 0;
+    for (int i = 0; i < pointCount; i++)
+    {
+        const SDL_FPoint *a = &points[i], *b = &points[(i + 1) % pointCount];
+        polygonArea += a->x * b->y - b->x * a->y;
+    }
+    polygonArea = fabsf(polygonArea);
+    float triangleArea = 0;
+    for (int t = 0; t < triangleCount; t++)
+    {
+        const int *triangle = &indices[t * 3];
+        for (int k = 0; k < 3; k++)
+        {
+            if (triangle[k] < 0 || triangle[k] >= pointCount)
+            {
+                fprintf(stderr, "三角化检查失败(%s): 下标%d越界\n", name, triangle[k]);
+                return false;
+            }
+        }
+        float area = Check_Cross(points[triangle[0]], points[triangle[1]], points[triangle[2]]);
+        if (area <= 0)
+        {
+            fprintf(stderr, "三角化检查失败(%s): 第%d个三角形退化或不是逆时针\n", name, t);
+            return false;
+        }
+        triangleArea += area;
+    }
+    if (fabsf(triangleArea - polygonArea) > polygonArea * 1e-4f)
+    {
+        fprintf(stderr, "三角化检查失败(%s): 三角形面积之和%g,多边形面积%g\n", name, triangleArea * 0.5f, polygonArea * 0.5f);
+        return false;
+    }
+    return true;
+}
+
+// 计时前先检查三角化的正确性:凸多边形,凹多边形,两种方向,共线点
+static bool Check_TriangulateShapes(void)
+{
+    const SDL_FPoint square[4] = {{0, 0}, {10, 0}, {10, 10}, {0, 10}};
+    const SDL_FPoint squareClockwise[4] = {{0, 0}, {0, 10}, {10, 10}, {10, 0}};
+    const SDL_FPoint lShape[6] = {{0, 0}, {20, 0}, {20, 5}, {5, 5}, {5, 20}, {0, 20}};
+    const SDL_FPoint comb[8] = {{0, 0}, {30, 0}, {30, 20}, {25, 20}, {25, 5}, {5, 5}, {5, 20}, {0, 20}};
+    const SDL_FPoint collinear[5] = {{0, 0}, {5, 0}, {10, 0}, {10, 10}, {0, 10}};
+    SDL_FPoint star[10];
+    SDL_FPoint starClockwise[10];
+    for (int i = 0; i < 10; i++)
+    {
+        float radius = i % 2 ? 45.0f : 100.0f;
+        float angle = i * (float)M_PI / 5;
+        star[i] = (SDL_FPoint){radius * cosf(angle), radius * sinf(angle)};
+        starClockwise[9 - i] = star[i];
+    }
+    return Check_Triangulate("square", square, 4) && Check_Triangulate("square(cw)", squareClockwise, 4) && Check_Triangulate("L", lShape, 6) && Check_Triangulate("comb", comb, 8) && Check_Triangulate("collinear", collinear, 5) && Check_Triangulate("star", star, 10) && Check_Triangulate("star(cw)", starClockwise, 10);
+}
+
+static long long Bench_WorldToScreen(void *userData, long long iterations)
+{
+    BenchContext *context = userData;
+    float sum = 0;
+    for (long long i = 0; i < iterations; i++)
+    {
+        SDL_FPoint p = Camera_WorldToScreen(context->camera, (float)(i & 1023), (float)(i & 511));
+        sum += p.x + p.y;
+    }
+    g_benchSink = sum;
+    return 0;
+}
+
+static long long Bench_ParametricPoint(void *userData, long long iterations)
+{
+    (void)userData;
+    float sum = 0;
+    Vector direction = {COS45, COS45};
+    for (long long i = 0; i < iterations; i++)
+    {
+        SDL_FPoint p = Get_FPoint_From_parametric_equation((SDL_FPoint){(float)(i & 1023), 0}, direction, 25.0f);
+        sum += p.x + p.y;
+    }
+    g_benchSink = sum;
+    return 0;
+}
+
+static long long Bench_Counterclockwise(void *userData, long long iterations)
+{
+    (void)userData;
+    Vector v = {1, 0};
+    for (long long i = 0; i < iterations; i++)
+    {
+        v = counterclockwise(v, 5.0f);
+    }
+    g_benchSink = v.x + v.y;
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *output = argc > 1 ? argv[1] : DEFALUT_BENCH_OUTPUT;
+    double minSeconds = argc > 2 ? atof(argv[2]) / 1000.0 : DEFALUT_BENCH_MIN_SECONDS;
+
+    // 圆的细分误差和游戏里一样;单位圆表在确定迭代次数时就算好了,不影响计时
+    Polygon_SetCircleMaxError(DEFALUT_CIRCLE_MAX_ERROR);
+    if (!Check_TriangulateShapes()) return 1;
+
+    BenchContext context;
+    context.batch = Batch_CreateRenderer(4096, 12288);
+    context.camera = Camera_Create(0.0f, 0.0f, 1920, 1080);
+    if (!context.batch || !context.camera)
+    {
+        fprintf(stderr, "初始化失败\n");
+        return 1;
+    }
+    for (int i = 0; i < BENCH_POLYLINE_POINTS; i++)
+    {
+        context.polyline[i] = (SDL_FPoint){i * 20.0f, (i % 2) * 15.0f};
+    }
+    for (int i = 0; i < BENCH_TRIANGULATE_POINTS; i++)
+    {
+        float radius = i % 2 ? 45.0f : 100.0f;
+        float angle = i * 2.0f * (float)M_PI / BENCH_TRIANGULATE_POINTS;
+        context.star[i] = (SDL_FPoint){radius * cosf(angle), radius * sinf(angle)};
+    }
+
+    BenchHarness harness;
+    BenchHarness_Init(&harness, minSeconds, DEFALUT_BENCH_REPEATS);
+
+    BenchHarness_Run(&harness, "Batch_AddTriangle", Bench_AddTriangle, &context);
+    context.radius = 10.0f;
+    BenchHarness_Run(&harness, "Polygon_DrawCircle(r=10)", Bench_DrawCircle, &context);
+    context.radius = 100.0f;
+    BenchHarness_Run(&harness, "Polygon_DrawCircle(r=100)", Bench_DrawCircle, &context);
+    BenchHarness_Run(&harness, "Polygon_DrawLines(32)", Bench_DrawLines, &context);
+    BenchHarness_Run(&harness, "Batch_AddSprite", Bench_AddSprite, &context);
+    BenchHarness_Run(&harness, "Batch_TransformVertices(4096)", Bench_TransformVertices, &context);
+    BenchHarness_Run(&harness, "Polygon_Triangulate(64)", Bench_Triangulate, &context);
+    BenchHarness_Run(&harness, "Camera_WorldToScreen", Bench_WorldToScreen, &context);
+    BenchHarness_Run(&harness, "Get_FPoint_From_parametric_equation", Bench_ParametricPoint, &context);
+    BenchHarness_Run(&harness, "counterclockwise", Bench_Counterclockwise, &context);
+
+    bool written = BenchHarness_WriteJSON(&harness, output);
+    if (written) printf("结果已写入%s\n", output);
+
+    Camera_Destroy(context.camera);
+    Batch_DestroyRenderer(context.batch);
+    return written ? 0 : 1;
+}
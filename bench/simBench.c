@@ -0,0 +1,177 @@
+// 无窗口的游戏逻辑基准测试:不创建窗口和渲染器,生成N个蛇和蜥蜴以及M颗子弹,尽快跑完固定数量的逻辑帧
+// 输出每秒逻辑帧数,每个阶段的耗时和内存占用;给出多个N时依次测试,得到随角色数量变化的曲线
+// 用法: simBench [逻辑帧数] [子弹数量] [线程数量(-1为CPU核数,0为单线程)] [角色数量...]
+#include "presets.h"
+#include "rng.h"
+#include "simulation.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef __linux__
+#include <sys/resource.h>
+#endif
+
+#define DEFALUT_BENCH_TICKS 600
+#define DEFALUT_BENCH_WARMUP_TICKS 60
+#define DEFALUT_BENCH_BULLETS 2000
+#define DEFALUT_BENCH_SPACING 300.0f // 每个角色平均占据的边长(生成区域随角色数量扩大,密度不变)
+#define DEFALUT_BENCH_SEED 1          // 固定种子(每次运行生成的场景完全相同)
+#define MAX_BENCH_SWEEP 32
+
+static const int DEFALUT_BENCH_SWEEP[] = {250, 500, 1000, 2000, 4000};
+
+static BulletPool g_bullets; // 子弹池很大,不放在栈上
+
+// 在边长为size的正方形区域内随机生成一个敌人(蛇和蜥蜴交替)
+static void Bench_SpawnEnemy(CharacterPool *pool, Rng *rng, float size, int index)
+{
+    float x = (Rng_Float(rng) - 0.5f) * size;
+    float y = (Rng_Float(rng) - 0.5f) * size;
+    float angle = Rng_Float(rng) * 6.2831853f;
+    Vector direction = {cosf(angle), sinf(angle)};
+    SDL_FColor color = {Rng_Float(rng), Rng_Float(rng), Rng_Float(rng), 1.0f};
+    SDL_FColor outLineColor = {1.0f, 1.0f, 1.0f, 1.0f};
+    float speed = 3.0f + Rng_Float(rng) * 3.0f;
+    if (index % 2 == 0)
+    {
+        CharacterPool_Creat(pool, SNAKE, x, y, direction, speed, SNAKE1_radiusList, SNAKE1_distanceList, SNAKE1_flexibility, SNAKE1_bodyCount, color, outLineColor, NULL);
+    }
+    else
+    {
+        CharacterPool_Creat(pool, LIZARD, x, y, direction, speed, LIZARD_radiusList, LIZARD_distanceList, LIZARD_flexibility, LIZARD_bodyCount, color, outLineColor, LIZARD_legs);
+    }
+}
+
+// 在区域内随机发射一颗子弹
+static void Bench_SpawnBullet(BulletPool *pool, Rng *rng, float size)
+{
+    Bullet bullet = ammo;
+    float angle = Rng_Float(rng) * 6.2831853f;
+    bullet.x = (Rng_Float(rng) - 0.5f) * size;
+    bullet.y = (Rng_Float(rng) - 0.5f) * size;
+    bullet.direction = (Vector){cosf(angle), sinf(angle)};
+    BulletPool_Add(pool, bullet);
+}
+
+// 进程的峰值常驻内存(KB),不支持的平台返回-1
+static long Bench_PeakMemoryKB(void)
+{
+#ifdef __linux__
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) return usage.ru_maxrss;
+#endif
+    return -1;
+}
+
+// 角色池,网格和子弹池占用的内存(KB)
+static long Bench_PoolMemoryKB(const CharacterPool *pool)
+{
+    return (long)((sizeof(BulletPool) + CharacterPool_MemoryBytes(pool)) / 1024);
+}
+
+// 测试一个角色数量,打印表格中的一行
+static void Bench_Run(int characterCount, int bulletCount, int ticks, JobSystem *jobs)
+{
+    CharacterPool pool;
+    CharacterPool_Init(&pool, characterCount + 1);
+    BulletPool_Init(&g_bullets);
+    Rng rng;
+    Rng_Seed(&rng, DEFALUT_BENCH_SEED);
+
+    float size = sqrtf((float)characterCount) * DEFALUT_BENCH_SPACING;
+
+    // 玩家在中心,不会死亡
+    Character *player = CharacterPool_Creat(&pool, LIZARD, 0, 0, (Vector){1, 0}, 0, LIZARD_radiusList, LIZARD_distanceList, LIZARD_flexibility, LIZARD_bodyCount, (SDL_FColor){1.0f, 0.5f, 0.0f, 1.0f}, (SDL_FColor){1, 1, 1, 1}, LIZARD_legs);
+    player->maxHP = player->HP = 1e30f;
+    for (int i = 0; i < characterCount; i++)
+    {
+        Bench_SpawnEnemy(&pool, &rng, size, i);
+    }
+    for (int i = 0; i < bulletCount; i++)
+    {
+        Bench_SpawnBullet(&g_bullets, &rng, size);
+    }
+
+    Simulation sim;
+    Simulation_Init(&sim, &pool, &g_bullets, jobs);
+
+    // 被打死的敌人和消失的子弹在每帧结束后补齐,保持负载不变(补齐的耗时单独统计)
+    Uint64 spawnTime = 0;
+    Uint64 begin = 0;
+    for (int t = 0; t < DEFALUT_BENCH_WARMUP_TICKS + ticks; t++)
+    {
+        if (t == DEFALUT_BENCH_WARMUP_TICKS)
+        {
+            Simulation_ResetStats(&sim);
+            spawnTime = 0;
+            begin = SDL_GetPerformanceCounter();
+        }
+        Simulation_Tick(&sim, NULL);
+
+        Uint64 spawnBegin = SDL_GetPerformanceCounter();
+        for (int i = pool.size - 1; i < characterCount; i++)
+        {
+            Bench_SpawnEnemy(&pool, &rng, size, i);
+        }
+        for (int i = g_bullets.liveCount; i < bulletCount; i++)
+        {
+            Bench_SpawnBullet(&g_bullets, &rng, size);
+        }
+        spawnTime += SDL_GetPerformanceCounter() - spawnBegin;
+    }
+    double seconds = (SDL_GetPerformanceCounter() - begin) / (double)SDL_GetPerformanceFrequency();
+    double msPerCount = 1000.0 / (double)SDL_GetPerformanceFrequency() / ticks;
+
+    printf("%7d %8d %10.1f %9.3f", characterCount, bulletCount, ticks / seconds, seconds * 1000.0 / ticks);
+    for (int p = 0; p < SIM_PHASE_COUNT; p++)
+    {
+        printf(" %10.3f", sim.phaseTime[p] * msPerCount);
+    }
+    printf(" %10.3f %9ld %9ld\n", spawnTime * msPerCount, Bench_PoolMemoryKB(&pool), Bench_PeakMemoryKB());
+    fflush(stdout);
+
+    CharacterPool_Destroy(&pool);
+    BulletPool_Destroy(&g_bullets);
+}
+
+int main(int argc, char *argv[])
+{
+    int ticks = argc > 1 ? atoi(argv[1]) : DEFALUT_BENCH_TICKS;
+    int bulletCount = argc > 2 ? atoi(argv[2]) : DEFALUT_BENCH_BULLETS;
+    int threadCount = argc > 3 ? atoi(argv[3]) : -1;
+    if (ticks <= 0) ticks = DEFALUT_BENCH_TICKS;
+    bulletCount = SDL_clamp(bulletCount, 0, MAX_BULLET_COUNT);
+
+    int sweep[MAX_BENCH_SWEEP];
+    int sweepCount = 0;
+    for (int i = 4; i < argc && sweepCount < MAX_BENCH_SWEEP; i++)
+    {
+        int n = atoi(argv[i]);
+        if (n > 0) sweep[sweepCount++] = n;
+    }
+    if (sweepCount == 0)
+    {
+        sweepCount = (int)SDL_arraysize(DEFALUT_BENCH_SWEEP);
+        memcpy(sweep, DEFALUT_BENCH_SWEEP, sizeof(DEFALUT_BENCH_SWEEP));
+    }
+
+    JobSystem *jobs = threadCount != 0 ? JobSystem_Create(threadCount) : NULL;
+
+    printf("逻辑帧: %d (预热%d), 子弹: %d, 线程: %d\n", ticks, DEFALUT_BENCH_WARMUP_TICKS, bulletCount, JobSystem_GetWorkerCount(jobs));
+    printf("各阶段和spawn为每帧平均毫秒数, pool为池占用内存, peak为进程峰值内存(KB, -1为不支持)\n");
+    printf("%7s %8s %10s %9s", "N", "bullets", "ticks/s", "ms/tick");
+    for (int p = 0; p < SIM_PHASE_COUNT; p++)
+    {
+        printf(" %10s", Simulation_PhaseName((SimulationPhase)p));
+    }
+    printf(" %10s %9s %9s\n", "spawn", "poolKB", "peakKB");
+
+    for (int i = 0; i < sweepCount; i++)
+    {
+        Bench_Run(sweep[i], bulletCount, ticks, jobs);
+    }
+
+    JobSystem_Destroy(jobs);
+    return 0;
+}
@@ -1,30 +1,88 @@
 #ifndef BATCHING_RENDER_H
 #define BATCHING_RENDER_H
 
+#include "camera.h"
+#include "frameArena.h"
 #include <SDL3/SDL.h>
 #include <stdbool.h>
 
-// 批次渲染器结构（纯色，无纹理）
+// 批次渲染器结构（纯色,或者整个批次共用一张纹理）
+// 设置了相机的批次存储世界坐标,渲染前一次性把所有顶点变换到屏幕坐标;没有设置相机的批次直接存储屏幕坐标
 typedef struct
 {
-    SDL_Vertex *vertices; // 顶点数组（存储屏幕坐标）
+    SDL_Vertex *vertices; // 顶点数组（世界坐标批次存世界坐标,否则存屏幕坐标）
     int *indices;         // 索引数组
     int vertexCount;      // 当前顶点数量
     int vertexCapacity;   // 顶点数组容量
     int indexCount;       // 当前索引数量
     int indexCapacity;    // 索引数组容量
+    FrameArena arena;     // 往这个批次里画图时用的临时内存(Batch_Clear时重置)
+
+    CameraTransform transform; // 本帧的相机变换快照
+    bool worldSpace;           // 是否设置了相机(顶点为世界坐标)
+    int transformedCount;      // 前transformedCount个顶点已经变换到屏幕坐标
+
+    int savedVertexCount; // 本帧共享顶点省下的顶点数量(和每个三角形单独3个顶点相比)
+
+    SDL_Texture *texture; // 整个批次共用的纹理(NULL为纯色),Batch_Clear后保留,批次不负责销毁
 } BatchRenderer;
 
+// Batch_Reserve预留出来的一段可写空间
+typedef struct
+{
+    SDL_Vertex *vertices; // 预留的顶点(需要全部写入)
+    int *indices;         // 预留的索引(需要全部写入,值为批次中的顶点索引)
+    int baseVertex;       // vertices[0]在批次中的顶点索引
+} BatchSpan;
+
+// 写入一个纯色顶点(往Batch_Reserve预留的空间里填顶点时使用)
+static inline void Batch_WriteVertex(SDL_Vertex *vertex, float x, float y, SDL_FColor color)
+{
+    vertex->position.x = x;
+    vertex->position.y = y;
+    vertex->color = color;
+    vertex->tex_coord.x = 0.0f; // 不使用纹理，设为0
+    vertex->tex_coord.y = 0.0f;
+}
+
+// 写入一个带纹理坐标的顶点(u,v为0~1的归一化纹理坐标)
+static inline void Batch_WriteTexturedVertex(SDL_Vertex *vertex, float x, float y, float u, float v, SDL_FColor color)
+{
+    vertex->position.x = x;
+    vertex->position.y = y;
+    vertex->color = color;
+    vertex->tex_coord.x = u;
+    vertex->tex_coord.y = v;
+}
+
 // 创建批次渲染器
 BatchRenderer *Batch_CreateRenderer(int initialVertexCapacity, int initialIndexCapacity);
 
 // 销毁批次渲染器
 void Batch_DestroyRenderer(BatchRenderer *batch);
 
-// 清空批次数据（重用渲染器）
+// 清空批次数据（重用渲染器），同时重置临时内存
 void Batch_Clear(BatchRenderer *batch);
 
-// 添加顶点到批次（屏幕坐标）
+// 设置本帧的相机:取一次变换快照,之后添加的顶点都是世界坐标(Batch_Clear后失效,每帧重新设置)
+// 之前添加的顶点保持原来的坐标系:屏幕坐标的顶点不会被变换,世界坐标的顶点用原来的快照变换
+void Batch_SetCamera(BatchRenderer *batch, const Camera *camera);
+
+// 设置整个批次共用的纹理(NULL为纯色),纯色图元的纹理坐标为0,所以同一批次里不要混用
+void Batch_SetTexture(BatchRenderer *batch, SDL_Texture *texture);
+
+// 本帧还没设置相机时取相机快照,绘图函数开头调用;camera为NULL时切回屏幕坐标(之前的世界坐标顶点先变换掉)
+void Batch_UseCamera(BatchRenderer *batch, const Camera *camera);
+
+// 把还没变换的顶点一次性变换到屏幕坐标(SSE每次处理两个顶点),Batch_Render会自动调用
+void Batch_TransformVertices(BatchRenderer *batch);
+
+// 一次预留vertexCount个顶点和indexCount个索引,通过span返回可写指针(只做一次容量检查)
+// 顶点和索引数量立即计入批次,调用者必须写满预留的空间;下一次往批次添加数据后指针失效
+// indexCount超过vertexCount的部分计入共享顶点省下的顶点数量
+bool Batch_Reserve(BatchRenderer *batch, int vertexCount, int indexCount, BatchSpan *span);
+
+// 添加顶点到批次（批次的坐标系）
 // 返回顶点索引，如果失败返回-1
 int Batch_AddVertex(BatchRenderer *batch, const SDL_Vertex *vertex);
 
@@ -32,15 +90,47 @@ int Batch_AddVertex(BatchRenderer *batch, const SDL_Vertex *vertex);
 bool Batch_AddIndex(BatchRenderer *batch, int index);
 
 // 直接添加一个三角形到批次（3个顶点，3个索引）
-// 注意：这里的点坐标必须是屏幕坐标！
+// 注意：点坐标使用批次的坐标系(设置了相机就是世界坐标,否则是屏幕坐标)
 bool Batch_AddTriangle(BatchRenderer *batch, const SDL_FPoint *p1, const SDL_FPoint *p2, const SDL_FPoint *p3, SDL_FColor color);
 
-// 渲染整个批次（单次drawcall）
+// 添加四边形(4个顶点,2个三角形:p1p2p3和p1p3p4),点按顺时针或逆时针顺序排列
+// 返回第一个顶点的索引,失败返回-1
+int Batch_AddQuad(BatchRenderer *batch, const SDL_FPoint *p1, const SDL_FPoint *p2, const SDL_FPoint *p3, const SDL_FPoint *p4, SDL_FColor color);
+
+// 添加带纹理的矩形:dst为批次坐标系里的矩形,uv为归一化纹理坐标里的矩形,color和纹理颜色相乘
+// 返回第一个顶点的索引,失败返回-1
+int Batch_AddTexturedQuad(BatchRenderer *batch, const SDL_FRect *dst, const SDL_FRect *uv, SDL_FColor color);
+
+// 添加旋转缩放后的带纹理矩形(精灵):center为中心,width/height为缩放后的大小,angle为逆时针角度(角度制)
+// 只用于屏幕坐标的批次(y轴向下,纹理的上方朝屏幕上方),angle为正时在屏幕上逆时针旋转
+// 返回第一个顶点的索引,失败返回-1
+int Batch_AddSprite(BatchRenderer *batch, const SDL_FRect *uv, SDL_FPoint center, float width, float height, float angle, SDL_FColor color);
+
+// 添加三角形扇形:中心点hub和边缘点rim[0..rimCount-1]组成三角形(hub,rim[i],rim[i+1]),closed为true时再连接最后一个点和第一个点
+// hub是第一个顶点,返回它的索引,失败返回-1
+int Batch_AddFan(BatchRenderer *batch, const SDL_FPoint *hub, const SDL_FPoint *rim, int rimCount, bool closed, SDL_FColor color);
+
+// 添加三角形带:每相邻三个点组成一个三角形(points[i],points[i+1],points[i+2])
+// 返回第一个顶点的索引,失败返回-1
+int Batch_AddStrip(BatchRenderer *batch, const SDL_FPoint *points, int pointCount, SDL_FColor color);
+
+// 用已经在批次里的三个顶点索引添加一个三角形(不添加新顶点)
+bool Batch_AddIndexedTriangle(BatchRenderer *batch, int i1, int i2, int i3);
+
+// 把src的顶点和索引追加到dst末尾(索引加上dst原有的顶点数量);dst没有纹理时使用src的纹理
+// src是世界坐标时,dst已有的顶点先按原来的坐标系变换掉,之后使用src的相机快照
+// 屏幕坐标的src追加到世界坐标的dst,或者src里有已经变换过的世界坐标顶点时返回false
+bool Batch_Append(BatchRenderer *dst, const BatchRenderer *src);
+
+// 渲染整个批次（单次drawcall,使用批次的纹理），世界坐标批次先变换到屏幕坐标
 bool Batch_Render(BatchRenderer *batch, SDL_Renderer *renderer);
 
 // 获取批次统计信息
 void Batch_GetStats(const BatchRenderer *batch, int *vertexCount, int *indexCount, int *triangleCount);
 
+// 获取本帧共享顶点省下的顶点数量
+int Batch_GetSavedVertexCount(const BatchRenderer *batch);
+
 // 检查批次是否为空
 bool Batch_IsEmpty(const BatchRenderer *batch);
 
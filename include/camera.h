@@ -1,7 +1,6 @@
 #ifndef CAMERA_H
 #define CAMERA_H
 #include <SDL3/SDL.h>
-#include <SDL3_image/SDL_image.h>
 #include <stdbool.h>
 
 #define DEFALUT_MIN_ZOOM 0.5f
@@ -12,6 +11,8 @@ typedef struct
 {
     // 相机位置（世界坐标）
     float x, y;
+    // 上一个逻辑帧开始时的位置(渲染插值用)
+    float prevX, prevY;
 
     // 相机缩放级别（1.0为原始大小，大于1.0为放大，小于1.0为缩小）
     float zoom;
@@ -27,6 +28,14 @@ typedef struct
     int screenWidth, screenHeight;
 } Camera;
 
+// 相机变换的快照(世界坐标到屏幕坐标的仿射变换):screenX = worldX * scaleX + offsetX, screenY = worldY * scaleY + offsetY
+// 每帧取一次,之后变换顶点不需要再读相机或重新计算屏幕中心
+typedef struct
+{
+    float scaleX, scaleY;   // zoom 和 -zoom(世界y轴向上,屏幕y轴向下)
+    float offsetX, offsetY; // 相机位置和屏幕中心合并后的平移量
+} CameraTransform;
+
 // 初始化相机
 Camera *Camera_Create(float x, float y, int screenWidth, int screenHeight);
 
@@ -42,6 +51,9 @@ void Camera_SetBounds(Camera *camera, float minX, float maxX, float minY, float
 // 世界坐标转换为屏幕坐标（考虑相机位置和缩放）
 SDL_FPoint Camera_WorldToScreen(const Camera *camera, float worldX, float worldY);
 
+// 获取当前相机的变换快照(camera为NULL时返回单位变换)
+CameraTransform Camera_GetTransform(const Camera *camera);
+
 // 屏幕坐标转换为世界坐标（考虑相机位置和缩放）
 SDL_FPoint Camera_ScreenToWorld(const Camera *camera, float screenX, float screenY);
 
@@ -60,6 +72,12 @@ void Camera_Zoom_Add(Camera *camera, float zoomDelta);
 // 重置相机
 void Camera_Reset(Camera *camera);
 
+// 记录当前位置作为上一个逻辑帧的位置(每个逻辑帧开始时调用)
+void Camera_SavePrevious(Camera *camera);
+
+// 返回位置插值后的相机副本:alpha为0时是上一个逻辑帧的位置,为1时是当前位置
+Camera Camera_Interpolate(const Camera *camera, float alpha);
+
 // 获取相机在世界坐标系中的视图矩形（可见区域）左上角坐标,加向右的宽度和向下的高度
 SDL_FRect Camera_GetViewRect(const Camera *camera);
 
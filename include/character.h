@@ -11,22 +11,35 @@
 
 #define MAX_BULLET_COUNT 5000
 #define Max_FLY_COUNT 6000
+#define BULLET_POOL_SLACK 256                  // 子弹池满了之后被挤掉的子弹先留在数组里,攒够这么多再统一压缩
+#define BULLET_POOL_CAPACITY (MAX_BULLET_COUNT + BULLET_POOL_SLACK)
+#define BULLET_DEAD_FLY_COUNT (1 << 30)         // 标记为死亡的子弹的飞行帧数(远大于寿命,和这一帧刚到期的子弹区分开)
+#define BULLET_SELF_HIT_DELAY 10               // 子弹飞行超过这么多帧之后才会打到自己
+
+#define MAX_BODY_COUNT 32                     // 每个角色最多的身体节点数(角色池按这个大小给每个角色预留节点)
+#define SPINE_SOLVER_LANES 16                 // 脊椎求解器一次同时处理的角色数量(4的倍数,每4个对应一个SSE寄存器)
+#define DEFALUT_CHARACTER_POOL_CAPACITY 1024 // 角色池默认容量(初始化后不再扩容)
+#define RENDER_CHUNKS_PER_WORKER 4           // 并行渲染时每个线程平均分到的角色段数(段越多负载越均衡)
+#define UPDATE_CHUNK_SIZE (SPINE_SOLVER_LANES * 4) // 并行逻辑帧每个任务处理的角色数(SPINE_SOLVER_LANES的倍数,脊椎求解的分组和串行时相同)
 
 #define CUTTING_DISTANCE 0.25f
 
 #include "batchingRender.h"
 #include "camera.h"
+#include "jobSystem.h"
+#include "spatialGrid.h"
 #include "vector.h"
 #include <SDL3/SDL.h>
-typedef struct
-{
-    float minX, maxX, minY, maxY;
-} AABBBox;
 enum CharacterType
 {
     SNAKE, // 0
     LIZARD // 1
 };
+enum LegSolver // 腿(三节点链条)的求解方式
+{
+    LEG_SOLVER_FABRIK,  // 两次FABRIK正反向迭代,膝盖方向不对时翻转后再迭代一次
+    LEG_SOLVER_ANALYTIC // 余弦定理直接求膝盖位置,一次完成
+};
 typedef struct // 怪物只追我近战,不发射子弹,子弹只打怪(打到自己掉四分之一的血)
 {
     // 属性
@@ -39,11 +52,31 @@ typedef struct // 怪物只追我近战,不发射子弹,子弹只打怪(打到
     int flyCount; // 已经飞行了多少帧,超过一定值就删掉
     Vector direction;
     float x, y;
-} Bullet; // 决定了伤害,速度,大小,颜色
-typedef struct
+} Bullet; // 决定了伤害,速度,大小,颜色(子弹池里不直接存Bullet,只作为发射时的模板)
+typedef struct // 结构数组(SoA)布局:每个属性一个数组,移动内核只需要连续读写热数据
 {
-    int bulletCount;
-    Bullet bullets[MAX_BULLET_COUNT]; // 最多有MAX_BULLET_COUNT个子弹同时出现,不再动态更新长度,简化
+    // 删除分两步:先标记死亡(flyCount超过寿命),再在BulletPool_Update末尾统一压缩,压缩保持剩余子弹的顺序
+    // 所以数组始终按发射先后排列,下标越小的子弹越老
+    int bulletCount; // 数组中的子弹数量(包括已标记死亡但还没压缩掉的)
+    int liveCount;   // 存活的子弹数量,最多有MAX_BULLET_COUNT个子弹同时存活
+    int evictCursor; // 池满时从这里往后找最老的存活子弹挤掉
+
+    // 热数据:每个逻辑帧都要读写
+    float x[BULLET_POOL_CAPACITY];
+    float y[BULLET_POOL_CAPACITY];
+    float vx[BULLET_POOL_CAPACITY];       // 每帧位移(速度乘方向)
+    float vy[BULLET_POOL_CAPACITY];
+    int flyCount[BULLET_POOL_CAPACITY];   // 已经飞行了多少帧,超过Max_FLY_COUNT就删掉
+
+    // 冷数据:只在碰撞和渲染时读取
+    float damage[BULLET_POOL_CAPACITY];
+    float radius[BULLET_POOL_CAPACITY];
+    SDL_FColor color[BULLET_POOL_CAPACITY];
+
+    // 渲染数据:BulletPool_Cull每帧生成,渲染只遍历可见的子弹
+    int visible[BULLET_POOL_CAPACITY]; // 可见子弹的下标
+    int visibleCount;
+    int culledCount; // 存活但在视野外的子弹数量
 } BulletPool;
 enum GunType
 {
@@ -75,6 +108,8 @@ typedef struct
     float radius;
     float distance;    // 约束下一个点的距离,它后面一个点必须在以这个距离为半径的圆上
     float flexibility; // 单位是角度,当前节点作为两段身体连接处时的最大灵活度(头尾节点没有),两个身体段形成的锐夹角的最大角度对应的角度(锐夹角越大身体越弯曲)
+    float cosFlex;     // flexibility的余弦(创建时算好,更新脊椎时不再调用三角函数)
+    float sinFlex;     // flexibility的正弦
 } node;
 typedef struct
 {
@@ -94,6 +129,7 @@ typedef struct // 头部的方向应该采取坦克炮塔的模式,有最大转
     node *body; // 用于检测碰撞,更新renderBody,更新渲染盒的身体
     int bodyCount;
     Chain3 legs[4];            // 四条腿(0,1是前腿,2,3是后腿)
+    enum LegSolver legSolver;  // 腿的求解方式,默认为LEG_SOLVER_ANALYTIC
     int frontLegPos;           // 前腿在第几个节点处
     int backLegPos;            // 后腿在第几个节点处
     float frontLegMaxDistance; // 前腿最大落后距离,超过了就要移动腿到新的位置
@@ -128,49 +164,61 @@ typedef struct // 头部的方向应该采取坦克炮塔的模式,有最大转
     Gun headGun;
     Gun tailGun;
 } Character;
+typedef struct // 角色在上一个逻辑帧开始时的位置(渲染时和当前位置插值)
+{
+    SDL_FPoint body[MAX_BODY_COUNT]; // 身体节点
+    SDL_FPoint legs[4][3];           // 每条腿的root,middle,head
+    SDL_FPoint headGun;              // 头枪位置
+    SDL_FPoint tailGun;              // 尾枪位置
+} CharacterSnapshot;
 typedef struct
 {
-    int capacity;           // 容量: 最多能容纳的角色数量
-    int size;               // 当前角色数量
-    Character **characters; // 角色指针数组
+    int capacity;                // 容量: 最多能容纳的角色数量(初始化时一次性分配,之后不再扩容)
+    int size;                    // 当前角色数量
+    Character *characters;       // 连续存放的角色数组
+    node *nodes;                 // 所有角色共用的身体节点区,第i个角色的节点从nodes[i*MAX_BODY_COUNT]开始
+    SpatialGrid grid;            // 角色包围盒的空间哈希网格(每个逻辑帧重建一次,用于碰撞的宽阶段)
+    AABBBox *gridBoxes;          // 重建网格用的包围盒数组(下标和characters一致)
+    bool gridValid;              // 网格是否和当前角色池一致(增删角色后失效)
+    SDL_FPoint *newHeads;        // 碰撞阶段算出的头部新位置(下标和characters一致,所有角色算完后再统一写回)
+    bool *hitPlayer;             // 碰撞阶段是否撞到了玩家(下标和characters一致)
+    CharacterSnapshot *previous; // 上一个逻辑帧开始时的位置(下标和characters一致)
+    int *visible;                // 本帧可见角色的下标(CharacterPool_Cull生成,渲染只遍历这个列表)
+    int visibleCount;            // 可见角色数量
+    int droppedCount;            // 角色池已满时被拒绝的生成次数(成波刷怪时池满是正常情况,只计数不报错)
 } CharacterPool;
-void Render_Texture(SDL_Renderer *renderer, SDL_Texture *texture, SDL_FPoint pos, float angle, float scale);
-bool AABBBoxCollision(AABBBox a, AABBBox b);
-AABBBox Rect_To_AABBBox(SDL_FRect rect);
-SDL_FRect AABBBox_To_Rect(AABBBox box);
-Character *Character_Creat(enum CharacterType type, float x, float y, Vector initialDirection, float initialSpeed, const float *radiusList, const float *distanceList, const float *flexibility, const int bodyCount, SDL_FColor color, SDL_FColor outLineColor, const Chain3 legs[2]); // 头部初始位置,初始方向向量,初始速度向量,半径列表,约束距离列表,身体节点数量,(应确保半径列表和约束距离列表的长度一致且等于身体节点数量)(legs里面0为前腿,1为后退)
-void Character_Destroy(Character *character);                                                                                                                                                                                                                                           // 销毁角色(死亡即销毁,生成新的角色重新初始化一个就行)
-
-void Character_check_render(Character *character, const Camera *camera); // 检测是否需要渲染--渲染盒是否和摄像机视口相交
+bool Character_Init(Character *character, node *body, enum CharacterType type, float x, float y, Vector initialDirection, float initialSpeed, const float *radiusList, const float *distanceList, const float *flexibility, const int bodyCount, SDL_FColor color, SDL_FColor outLineColor, const Chain3 legs[2]); // 在已分配好的内存上初始化角色,body至少要有bodyCount个节点;头部初始位置,初始方向向量,初始速度向量,半径列表,约束距离列表,身体节点数量,(应确保半径列表和约束距离列表的长度一致且等于身体节点数量)(legs里面0为前腿,1为后退)
 
 void AddPointToOutline(SDL_FPoint *points, int *count, SDL_FPoint p);
 
 void Character_render(const Character *character, SDL_Renderer *renderer, const Camera *camera, BatchRenderer *batch); // 从头到尾遍历角色的身体节点,运用平滑算法生成更多的顶点,按顺序画三角形即可;头尾的节点特殊处理(仅使用圆上的更多点)
 
-// 渲染枪
-void Gun_render(const Gun *gun, Vector direction, SDL_Renderer *renderer, const Camera *camera, SDL_Texture *textureList[3]);
 // 获取角色头部到鼠标的向量
 Vector Character_get_head_to_mouse_direction(const Character *character, SDL_Renderer *renderer, const Camera *camera);
 void Character_turn_to_vector(Character *character, Vector direction);
 void Character_directly_turn_to_mouse(Character *character, SDL_Renderer *renderer, const Camera *camera); // 角色直接面向鼠标方向(for debug)
 void Character_turn_to_mouse(Character *character, SDL_Renderer *renderer, const Camera *camera);          // 角色缓慢地面向鼠标方向
-void Character_update(Character *character, CharacterPool *pool, bool isPlayer);                           // 根据方向和速度更新角色的身体节点,然后更新渲染盒(渲染盒永远需要更新,规定角色生成后就始终要检测是否需要渲染,没有隐身状态)
+void Character_UpdateBodies(Character *characters, int count);                                             // 根据方向和速度更新连续存放的一组角色的身体节点,然后更新碰撞盒和渲染盒(每SPINE_SOLVER_LANES个角色一起求解脊椎,单个角色传count=1)
+void Character_UpdateLimbs(Character *character);                                                          // 更新枪的位置和腿的运动
 void Character_speed_add(Character *character, float addSpeed);                                            // 增加速度,注意速度限制
 void Character_speed_set(Character *character, float setSpeed);                                            // 设置速度,注意速度限制
 void Character_turn_left(Character *character);                                                            //
 void Character_turn_right(Character *character);                                                           //
 void Character_direction_set(Character *character, Vector direction);                                      // 设置方向,注意最后要归一化,确保方向永远是单位向量,模为1
 
-bool Character_HandleCollision(Character *self, const Character *another); // 检查并处理本角色头部与另一个角色整体的碰撞,(第二个参数为自己时,为处理自己头部与身子的碰撞)
+bool Character_CollideHead(const Character *self, SDL_FPoint *head, const Character *another); // 检查本角色头部与另一个角色整体的碰撞(第三个参数为自己时,为检查自己头部与身子的碰撞),只移动传入的头部位置head,不修改任何角色
 
 // 角色池部分
-// 初始化角色池
-void CharacterPool_Init(CharacterPool *pool, int initialCapacity);
+// 初始化角色池(一次性分配capacity个角色和它们的身体节点)
+void CharacterPool_Init(CharacterPool *pool, int capacity);
+
+// 角色池占用的内存(字节):每个位置的所有数组加上空间哈希网格当前的容量
+size_t CharacterPool_MemoryBytes(const CharacterPool *pool);
 
-// 向角色池中添加角色
-void CharacterPool_Add(CharacterPool *pool, Character *character);
+// 在角色池中生成一个角色(参数同Character_Init),角色池已满(计入droppedCount)或身体节点超过MAX_BODY_COUNT时返回NULL
+Character *CharacterPool_Creat(CharacterPool *pool, enum CharacterType type, float x, float y, Vector initialDirection, float initialSpeed, const float *radiusList, const float *distanceList, const float *flexibility, const int bodyCount, SDL_FColor color, SDL_FColor outLineColor, const Chain3 legs[2]);
 
-// 删除角色池中一个角色(改变顺序)
+// 删除角色池中一个角色(改变顺序,最后一个角色会被搬到index处)
 void CharacterPool_Remove(CharacterPool *pool, int index);
 
 // 从角色池中获取角色
@@ -179,14 +227,33 @@ Character *CharacterPool_Get(const CharacterPool *pool, int index);
 // 获取角色池大小
 int CharacterPool_Size(const CharacterPool *pool);
 
-// 更新角色池中的所有角色
-void CharacterPool_Update(CharacterPool *pool);
+// 用所有角色当前的碰撞盒重建空间哈希网格
+void CharacterPool_RebuildGrid(CharacterPool *pool);
+
+// 记录所有角色当前的位置作为上一个逻辑帧的位置(每个逻辑帧开始时调用)
+void CharacterPool_SavePrevious(CharacterPool *pool);
+
+// 生成第index个角色插值后的副本:alpha为0时是上一个逻辑帧的位置,为1时是当前位置;out的身体节点指向outBody(至少MAX_BODY_COUNT个)
+void CharacterPool_Interpolate(const CharacterPool *pool, int index, float alpha, Character *out, node *outBody);
+
+// 更新角色池中的所有角色(jobs为NULL时在当前线程执行,结果和线程数量无关)
+void CharacterPool_Update(CharacterPool *pool, JobSystem *jobs);
 
 // 检查所有怪物角色血量并更新分数
 void CharacterPool_Check_Enemy_HP(CharacterPool *pool, int *score);
 
-// 渲染角色池中的所有角色
-void CharacterPool_Render(CharacterPool *pool, SDL_Renderer *renderer, const Camera *camera, BatchRenderer *batch);
+// 剔除:用本帧的视野(世界坐标,整帧只算一次)筛出渲染盒和视野相交的角色,生成可见列表并设置needRender
+void CharacterPool_Cull(CharacterPool *pool, AABBBox view);
+
+// 上一次剔除的结果:画出的角色数量和被剔除的角色数量
+void CharacterPool_GetCullStats(const CharacterPool *pool, int *drawn, int *culled);
+
+// 渲染可见列表里的角色(需要先调用CharacterPool_Cull,alpha为插值系数,见CharacterPool_Interpolate)
+void CharacterPool_Render(CharacterPool *pool, SDL_Renderer *renderer, const Camera *camera, BatchRenderer *batch, float alpha);
+
+// 并行渲染角色池:可见列表按顺序切成chunkCount段,每段由线程池里的某个线程画进chunkBatches里对应的批次,
+// 最后按段的顺序追加到batch,结果和CharacterPool_Render完全相同;jobs为NULL或chunkCount<=1时退化为串行渲染
+void CharacterPool_RenderParallel(CharacterPool *pool, SDL_Renderer *renderer, const Camera *camera, BatchRenderer *batch, JobSystem *jobs, BatchRenderer **chunkBatches, int chunkCount, float alpha);
 // 清理角色池
 void CharacterPool_Clear(CharacterPool *pool);
 // 销毁角色池中的所有角色并释放内存
@@ -195,18 +262,22 @@ void CharacterPool_Destroy(CharacterPool *pool);
 //----------------------三节点链条部分----------------------------------
 SDL_FPoint Constrain(SDL_FPoint from, SDL_FPoint to, float distance);
 bool Chain3_Update(Chain3 *chain, SDL_FPoint rootPosition, SDL_FPoint finalPosition, Vector aimDirection);
+// 解析解:root固定在rootPosition,head尽量伸到finalPosition(够不着时伸直指向它),用余弦定理算出膝盖位置
+// 膝盖默认留在上一次所在的一侧,朝向和aimDirection不符时换到另一侧(和Chain3_Update翻转后再迭代的结果一致),返回是否换了一侧
+bool Chain3_SolveAnalytic(Chain3 *chain, SDL_FPoint rootPosition, SDL_FPoint finalPosition, Vector aimDirection);
 
 //----------子弹部分---------
 void BulletPool_Init(BulletPool *pool);
-void BulletPool_Add(BulletPool *pool, Bullet bullet);
-void BulletPool_Remove(BulletPool *pool, int index);
+void BulletPool_Add(BulletPool *pool, Bullet bullet); // 存活子弹满了时挤掉最老的一颗
+void BulletPool_Kill(BulletPool *pool, int index);    // 标记子弹死亡,下一次BulletPool_Update时统一删除
 void BulletPool_Clear(BulletPool *pool);
 void BulletPool_Destroy(BulletPool *pool);
-bool Bullet_Character_Collision(Bullet *bullet, Character *character);
-void damage(Character *character, Bullet *bullet, float k);
-bool Bullet_Update(Bullet *bullet, CharacterPool *characterPool);
+bool Bullet_Character_Collision(float x, float y, float lastX, float lastY, float radius, const Character *character);
+void damage(Character *character, float bulletDamage, float k);
 void BulletPool_Update(BulletPool *pool, CharacterPool *characterPool);
-void BulletPool_Render(BulletPool *pool, SDL_Renderer *renderer, const Camera *camera, BatchRenderer *batch);
+void BulletPool_Cull(BulletPool *pool, AABBBox view, float alpha);                                                     // 筛出插值位置在视野内的存活子弹,生成可见列表
+void BulletPool_GetCullStats(const BulletPool *pool, int *drawn, int *culled);                                       // 上一次剔除的结果:画出和被剔除的子弹数量
+void BulletPool_Render(BulletPool *pool, SDL_Renderer *renderer, const Camera *camera, BatchRenderer *batch, float alpha); // 渲染可见列表里的子弹(需要先调用BulletPool_Cull);子弹做匀速直线运动,上一个逻辑帧的位置直接由速度倒推
 
 // ------------枪械部分-------------
 void Gun_Try_Shoot(Gun *gun, BulletPool *pool, bool needShoot);
@@ -0,0 +1,54 @@
+#ifndef FLOW_FIELD_H
+#define FLOW_FIELD_H
+#include "spatialGrid.h"
+#include "vector.h"
+#include <SDL3/SDL.h>
+#include <stdbool.h>
+
+#define DEFALUT_FLOW_FIELD_CELL_SIZE 128.0f // 默认格子边长(世界坐标)
+#define FLOW_FIELD_STRAIGHT_COST 10         // 走到上下左右相邻格子的代价
+#define FLOW_FIELD_DIAGONAL_COST 14         // 走到斜对角格子的代价(约为10*sqrt(2))
+
+// 流场:把场地划分成格子,从目标所在的格子做一次Dijkstra,每个格子记下往目标走的方向
+// 所有敌人共用一个流场,每个敌人查询方向只需要一次数组访问,敌人数量再多也只需要更新一次流场
+// 格子和目标之间的矩形里没有障碍时(直线可达),查询直接返回指向目标的向量,开阔地带的行为和直接转向目标一样
+typedef struct
+{
+    float minX, minY; // 网格左下角(世界坐标)
+    float cellSize;
+    float invCellSize;
+    int width, height; // 格子数量
+    int cellCount;
+    bool *blocked;     // 被障碍占据的格子
+    int *blockedSum;   // 障碍数量的二维前缀和((width+1)*(height+1)),O(1)判断一个矩形里有没有障碍
+    bool sumValid;     // 前缀和和blocked一致
+    int *cost;         // 到目标格子的代价(到不了为INT_MAX)
+    Vector *direction; // 每个格子往目标走的方向(单位向量)
+    bool *direct;      // 格子和目标之间没有障碍,直接朝目标走
+    Uint64 *heap;      // Dijkstra的优先队列:高32位是代价,低32位是格子下标
+    int heapCapacity;
+    int targetCell;  // 上一次计算时目标所在的格子,-1表示需要重新计算
+    int updateCount; // 实际重新计算的次数
+} FlowField;
+
+// 创建覆盖bounds的流场(cellSize<=0时使用默认值),失败返回NULL
+FlowField *FlowField_Create(AABBBox bounds, float cellSize);
+
+// 销毁流场
+void FlowField_Destroy(FlowField *field);
+
+// 把和box重叠的格子标记为障碍(静态障碍,注册一次)
+void FlowField_AddObstacle(FlowField *field, AABBBox box);
+
+// 下一次FlowField_Update时强制重新计算
+void FlowField_Invalidate(FlowField *field);
+
+// 用目标位置更新流场:目标还在上一次的格子里时什么都不做,返回是否重新计算了
+// 只读写流场自己的内存,可以在线程池里和其它任务同时执行
+bool FlowField_Update(FlowField *field, SDL_FPoint target);
+
+// 查询position处往目标走的方向(target为目标的当前位置,直线可达时直接指向它)
+// position在场地外,在障碍里或者到不了目标时返回false
+bool FlowField_Sample(const FlowField *field, SDL_FPoint position, SDL_FPoint target, Vector *direction);
+
+#endif // FLOW_FIELD_H
@@ -0,0 +1,37 @@
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+#include <stdbool.h>
+#include <stddef.h>
+
+#define DEFALUT_FRAME_ARENA_SIZE (64 * 1024) // 默认帧内存大小(字节)
+#define FRAME_ARENA_ALIGN 16                  // 分配的对齐字节数(满足SSE加载)
+
+// 帧内存(线性分配器):创建时一次性申请一块内存,分配只移动指针,每帧开始时整体重置
+// 渲染函数里的临时数组从这里取,用完用Mark/Release归还,帧内不再调用malloc/free
+typedef struct
+{
+    unsigned char *base; // 内存起始地址
+    size_t capacity;     // 总大小
+    size_t used;         // 已分配的大小
+    size_t peak;         // 分配过的最大值(用于调整大小)
+} FrameArena;
+
+// 初始化帧内存(capacity为0时使用默认大小)
+bool FrameArena_Init(FrameArena *arena, size_t capacity);
+
+// 释放帧内存
+void FrameArena_Destroy(FrameArena *arena);
+
+// 重置帧内存(之前分配的内存全部失效)
+void FrameArena_Reset(FrameArena *arena);
+
+// 分配size字节,空间不足时返回NULL(不会扩容,已分配的指针永远有效直到重置)
+void *FrameArena_Alloc(FrameArena *arena, size_t size);
+
+// 记录当前位置,配合Release把这之后分配的内存一次性归还
+size_t FrameArena_Mark(const FrameArena *arena);
+
+// 归还到Mark记录的位置
+void FrameArena_Release(FrameArena *arena, size_t mark);
+
+#endif // FRAME_ARENA_H
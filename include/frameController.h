@@ -22,6 +22,9 @@ void FrameController_Init(FrameController *fc, int logicRate);
 // 更新时间并检查是否需要逻辑更新
 int FrameController_Update(FrameController *fc);
 
+// 获取渲染插值系数(距离上一个逻辑帧过去的时间占逻辑帧间隔的比例,0~1)
+float FrameController_GetAlpha(const FrameController *fc);
+
 // 增加渲染计数(每次更新完调用)
 void FrameController_AddRenderCount(FrameController *fc);
 
@@ -0,0 +1,44 @@
+#ifndef GLYPH_ATLAS_H
+#define GLYPH_ATLAS_H
+#include "batchingRender.h"
+#include <SDL3/SDL.h>
+#include <SDL3_ttf/SDL_ttf.h>
+#include <stdbool.h>
+
+#define GLYPH_ATLAS_FIRST_CHAR 32  // 图集里的第一个字符(空格)
+#define GLYPH_ATLAS_LAST_CHAR 126  // 图集里的最后一个字符(~)
+#define GLYPH_ATLAS_CHAR_COUNT (GLYPH_ATLAS_LAST_CHAR - GLYPH_ATLAS_FIRST_CHAR + 1)
+#define DEFALUT_GLYPH_ATLAS_WIDTH 512 // 图集纹理宽度,高度按需要的行数决定
+#define GLYPH_ATLAS_PADDING 1         // 字形之间留的空隙(线性过滤时不采样到相邻字形)
+
+// 一个字形在图集里的位置
+typedef struct
+{
+    SDL_FRect uv;  // 归一化纹理坐标
+    float width;   // 字形图像的像素宽度
+    float advance; // 画完这个字后笔的前进距离
+} Glyph;
+
+// 字形图集:启动时用字体把可打印ASCII字符渲染成白色字形拼到一张纹理上,之后画文字只往批次里写矩形
+// 和Draw_Text相比每帧不再创建表面和纹理,同一个批次里的所有文字一次drawcall画完
+typedef struct
+{
+    SDL_Texture *texture;
+    Glyph glyphs[GLYPH_ATLAS_CHAR_COUNT];
+    float lineHeight; // 字体高度(像素)
+} GlyphAtlas;
+
+// 用字体创建图集(需要渲染器来创建纹理),失败返回NULL
+GlyphAtlas *GlyphAtlas_Create(SDL_Renderer *renderer, TTF_Font *font);
+
+// 销毁图集和纹理
+void GlyphAtlas_Destroy(GlyphAtlas *atlas);
+
+// 文字按字体原始大小排版时的宽度(像素),图集里没有的字符跳过
+float GlyphAtlas_MeasureText(const GlyphAtlas *atlas, const char *text);
+
+// 把文字拉伸到rect里(和Draw_Text的效果一样),写入batch,batch需要用图集的纹理
+// 返回写入的字形数量
+int GlyphAtlas_DrawText(const GlyphAtlas *atlas, BatchRenderer *batch, SDL_FRect rect, SDL_FColor color, const char *text);
+
+#endif // GLYPH_ATLAS_H
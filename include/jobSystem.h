@@ -0,0 +1,53 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+#include <SDL3/SDL.h>
+#include <stdbool.h>
+
+#define MAX_JOB_WORKERS 16 // 最多的工作线程数量(含主线程)
+
+// 任务函数:jobIndex是任务编号(0..jobCount-1),workerIndex是执行它的线程编号(主线程为0)
+typedef void (*JobFunction)(void *userData, int jobIndex, int workerIndex);
+
+typedef struct JobSystem JobSystem;
+
+// 后台线程
+typedef struct
+{
+    JobSystem *jobs;    // 所属线程池
+    int workerIndex;    // 线程编号(从1开始)
+    SDL_Thread *thread; // SDL线程句柄
+} JobWorker;
+
+// 线程池:后台线程常驻,主线程提交一批任务后自己也参与执行,直到整批任务完成才返回
+// 任务编号按原子计数器依次领取,哪个线程执行哪个任务不固定,需要确定性的结果时按任务编号而不是线程编号存放输出
+struct JobSystem
+{
+    JobWorker workers[MAX_JOB_WORKERS - 1]; // 后台线程
+    int threadCount;                        // 后台线程数量(不含主线程)
+    SDL_Mutex *mutex;                       // 保护下面的状态
+    SDL_Condition *wakeCondition;           // 提交了新的一批任务
+    SDL_Condition *doneCondition;           // 后台线程都执行完了这一批任务
+    int generation;                         // 每提交一批任务加1,后台线程据此判断有没有新任务
+    int busyCount;                          // 还在执行这一批任务的后台线程数量
+    bool quit;                              // 通知后台线程退出
+
+    // 当前这一批任务
+    JobFunction function;
+    void *userData;
+    int jobCount;
+    SDL_AtomicInt nextJob; // 下一个待领取的任务编号
+};
+
+// 创建线程池(threadCount为后台线程数量,小于0时按CPU逻辑核心数减1)
+JobSystem *JobSystem_Create(int threadCount);
+
+// 销毁线程池(等待后台线程退出)
+void JobSystem_Destroy(JobSystem *jobs);
+
+// 参与执行任务的线程数量(含主线程),jobs为NULL时为1
+int JobSystem_GetWorkerCount(const JobSystem *jobs);
+
+// 并行执行jobCount个任务,全部完成后返回;jobs为NULL或没有后台线程时在主线程依次执行
+void JobSystem_ParallelFor(JobSystem *jobs, int jobCount, JobFunction function, void *userData);
+
+#endif // JOB_SYSTEM_H
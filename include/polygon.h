@@ -4,6 +4,12 @@
 #include "batchingRender.h"
 #include "camera.h"
 #include <SDL3/SDL.h>
+
+#define CIRCLE_MIN_SEGMENTS 4          // 圆的最少段数
+#define CIRCLE_MAX_SEGMENTS 64         // 圆的最多段数
+#define DEFALUT_CIRCLE_MAX_ERROR 0.5f  // 圆弧和弦之间允许的最大误差(屏幕像素)
+#define DEFALUT_GRID_MIN_SPACING 30.0f // 网格线在屏幕上的最小间距(像素),缩小到比这更密时网格间距翻倍
+
 typedef struct
 {
     SDL_FPoint p1, p2, p3, p4;
@@ -16,25 +22,50 @@ typedef struct
 // - batch: 目标批次
 // - x1,y1...: 世界坐标
 // - color: 三角形颜色
-// - camera: 相机（用于世界坐标到屏幕坐标的转换）
+// - camera: 相机（批次据此在渲染时统一把世界坐标转换到屏幕坐标）
 void Polygon_DrawTriangle(BatchRenderer *batch, float x1, float y1, float x2, float y2, float x3, float y3, SDL_FColor color, const Camera *camera);
 
 // 绘制凸多边形到批次（自动三角化）
 // 注意：points数组必须按顺时针或逆时针顺序排列，且多边形必须是凸的
 void Polygon_DrawConvex(BatchRenderer *batch, const SDL_FPoint *points, int pointCount, SDL_FColor color, const Camera *camera);
 
-// 绘制矩形到批次（由2个三角形组成）
+// 绘制矩形到批次（4个顶点,2个三角形）
 void Polygon_DrawRect(BatchRenderer *batch, float x, float y, float width, float height, SDL_FColor color, const Camera *camera);
 
-// 绘制圆形到批次（使用三角形扇形）
-void Polygon_DrawCircle(BatchRenderer *batch, float centerX, float centerY, float radius, int segments, SDL_FColor color, const Camera *camera);
+// 绘制圆形到批次（使用三角形扇形）,段数由屏幕上的半径(radius * zoom)决定
+void Polygon_DrawCircle(BatchRenderer *batch, float centerX, float centerY, float radius, SDL_FColor color, const Camera *camera);
+
+// ========== 圆的细分 ==========
+
+// 设置圆弧和弦之间允许的最大误差(屏幕像素),误差越大圆的段数越少;不调用时使用DEFALUT_CIRCLE_MAX_ERROR
+// 只改变段数的系数,在主线程没有渲染任务时调用;单位圆表在第一次使用时算好一次,和这里无关
+void Polygon_SetCircleMaxError(float maxError);
+
+// 按屏幕上的半径选择圆的段数(在CIRCLE_MIN_SEGMENTS和CIRCLE_MAX_SEGMENTS之间)
+int Polygon_CircleSegments(float screenRadius);
+
+// 获取段数为segments的单位圆(segments个点,从角度0开始逆时针),所有段数共用一张预先算好的表
+const SDL_FPoint *Polygon_UnitCircle(int segments);
+
+// 把一个圆写进预留好的空间:segments+1个顶点(第一个是圆心),segments*3个索引
+// baseVertex是vertices[0]在批次中的顶点索引
+void Polygon_WriteCircle(SDL_Vertex *vertices, int *indices, int baseVertex, float centerX, float centerY, float radius, int segments, SDL_FColor color);
 
 // 绘制粗线(矩行);width表示线的实际宽度
 four_SDL_FPoint Polygon_DrawLine(BatchRenderer *batch, float x1, float y1, float x2, float y2, float width, SDL_FColor color, const Camera *camera);
 
-// 按顺序绘制粗线数组(矩形);width表示线的实际宽度
+// 按顺序绘制粗线数组(矩形);width表示线的实际宽度,连接处复用相邻线段的顶点
 void Polygon_DrawLines(BatchRenderer *batch, SDL_FPoint *pointList, int pointCount, float width, SDL_FColor color, const Camera *camera);
 
+// 绘制覆盖相机视野的网格(横竖细线,每条线一个矩形,一次预留所有顶点);lineWidth为屏幕像素宽度
+// 网格间距从cellSize开始,屏幕上的间距小于minScreenSpacing时翻倍,所以线的数量只和屏幕大小有关,和缩放无关
+// 返回实际使用的网格间距(世界坐标),camera为NULL时什么都不画并返回0
+float Polygon_DrawGrid(BatchRenderer *batch, float cellSize, float minScreenSpacing, float lineWidth, SDL_FColor color, const Camera *camera);
+
+// 用耳切法把简单多边形(可以是凹多边形,不能自相交)三角化,points按顺时针或逆时针顺序排列
+// 结果写入outIndices(至少(pointCount-2)*3个,值为points的下标),返回三角形数量,失败返回0
+int Polygon_Triangulate(const SDL_FPoint *points, int pointCount, int *outIndices);
+
 // 立即渲染多边形（不使用批处理，保持兼容）
 void Polygon_RenderImmediate(SDL_Renderer *renderer, const SDL_FPoint *points, int pointCount, SDL_FColor color, const Camera *camera);
 
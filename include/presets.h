@@ -0,0 +1,40 @@
+#ifndef PRESETS_H
+#define PRESETS_H
+#include "character.h"
+#include <SDL3/SDL.h>
+
+// 游戏和基准测试共用的预设(基准测试生成的角色和子弹和游戏里完全相同)
+
+// 角色预设
+// 蛇1:
+#define SNAKE1_BODY_COUNT 16
+extern const int SNAKE1_bodyCount;
+extern const float SNAKE1_radiusList[SNAKE1_BODY_COUNT];
+extern const float SNAKE1_distanceList[SNAKE1_BODY_COUNT];
+extern const float SNAKE1_flexibility[SNAKE1_BODY_COUNT];
+// 蜥蜴
+#define LIZARD_BODY_COUNT 21
+extern const int LIZARD_bodyCount;
+extern const float LIZARD_radiusList[LIZARD_BODY_COUNT];
+extern const float LIZARD_distanceList[LIZARD_BODY_COUNT];
+extern const float LIZARD_flexibility[LIZARD_BODY_COUNT];
+extern const Chain3 LIZARD_legs[2];
+
+// 颜色预设
+extern const SDL_FColor darkGold;
+extern const SDL_FColor lightSkyBlue;
+extern const SDL_FColor purple;
+extern const SDL_FColor white;
+
+// 子弹预设
+extern const Bullet defalutBullet;
+extern const Bullet ammo;
+extern const Bullet bubble;
+extern const Bullet sniperBullet;
+
+// 枪预设
+extern const Gun shortGun;
+extern const Gun longGun;
+extern const Gun sniperGun;
+
+#endif // PRESETS_H
@@ -0,0 +1,86 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+#include <SDL3/SDL.h>
+#include <stdbool.h>
+
+#define PROFILER_MAX_EVENTS 65536          // 事件环形缓冲区的容量(满了覆盖最老的事件)
+#define PROFILER_HISTORY_FRAMES 600        // 保留最近多少帧的各区段耗时(60帧时约10秒)
+#define PROFILER_MAX_DEPTH 16              // 区段最多嵌套层数
+#define DEFALUT_PROFILER_DUMP_SECONDS 5.0f // 导出Chrome trace时默认导出最近几秒
+
+// 性能分析区段(一帧里按执行顺序排列,同一帧里的区段互不重叠,叠加柱状图按这个顺序堆叠)
+typedef enum
+{
+    // 逻辑帧
+    PROFILE_ZONE_AI,            // 玩家操作和敌人转向
+    PROFILE_ZONE_SPINE,         // 移动身体,求解脊椎
+    PROFILE_ZONE_COLLISION,     // 重建网格,角色之间的碰撞
+    PROFILE_ZONE_LEGS,          // 写回头部,枪和腿(两节点IK)
+    PROFILE_ZONE_BULLETS,       // 子弹移动和碰撞
+    PROFILE_ZONE_CLEANUP,       // 删除死亡的敌人
+    // 渲染帧
+    PROFILE_ZONE_BACKGROUND,    // 网格背景和静态几何
+    PROFILE_ZONE_GEOMETRY,      // 生成世界几何(墙,角色,子弹)
+    PROFILE_ZONE_BATCH_RENDER,  // Batch_Render
+    PROFILE_ZONE_SPRITES,       // 纹理(枪)
+    PROFILE_ZONE_UI,            // UI批次
+    PROFILE_ZONE_TEXT,          // 文字
+    PROFILE_ZONE_PRESENT,       // SDL_RenderPresent(包括等待垂直同步)
+    PROFILE_ZONE_COUNT
+} ProfileZone;
+
+// 一个已经结束的区段
+typedef struct
+{
+    Uint64 start; // 性能计数器
+    Uint64 end;
+    Uint8 zone;
+    Uint8 depth; // 嵌套层数(0为最外层)
+} ProfileEvent;
+
+// 一帧的统计(两次Profiler_FrameMark之间)
+typedef struct
+{
+    Uint64 start;
+    Uint64 end;
+    Uint64 zoneTime[PROFILE_ZONE_COUNT]; // 每个区段在这一帧里的累计耗时(性能计数器单位)
+} ProfileFrame;
+
+// 打开ENABLE_PROFILER编译时才记录区段,否则宏展开为空,没有任何开销
+// 只能在主线程使用(线程池里的任务不单独记录,包在提交任务的区段里)
+#ifdef ENABLE_PROFILER
+#define PROFILE_BEGIN(zone) Profiler_Begin(zone)
+#define PROFILE_END(zone) Profiler_End(zone)
+#define PROFILE_FRAME() Profiler_FrameMark()
+#else
+#define PROFILE_BEGIN(zone) ((void)0)
+#define PROFILE_END(zone) ((void)0)
+#define PROFILE_FRAME() ((void)0)
+#endif
+
+// 开始一个区段
+void Profiler_Begin(ProfileZone zone);
+
+// 结束一个区段(必须和最近一次Profiler_Begin配对)
+void Profiler_End(ProfileZone zone);
+
+// 标记一帧结束,同时开始下一帧
+void Profiler_FrameMark(void);
+
+// 已经记录的完整帧数(最多PROFILER_HISTORY_FRAMES)
+int Profiler_GetFrameCount(void);
+
+// 获取最近的第framesAgo个完整帧(0为上一帧),不存在时返回NULL
+const ProfileFrame *Profiler_GetFrame(int framesAgo);
+
+// 区段名称和叠加柱状图里的颜色
+const char *Profiler_GetZoneName(ProfileZone zone);
+SDL_FColor Profiler_GetZoneColor(ProfileZone zone);
+
+// 性能计数器单位转毫秒
+float Profiler_ToMilliseconds(Uint64 ticks);
+
+// 把最近seconds秒的帧和区段导出为Chrome trace_event格式的JSON(用chrome://tracing或Perfetto打开)
+bool Profiler_WriteChromeTrace(const char *path, float seconds);
+
+#endif // PROFILER_H
@@ -0,0 +1,68 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+#include <SDL3/SDL.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#define REPLAY_MAGIC 0x50525A4Cu // 文件开头的标记("LZRP")
+#define REPLAY_VERSION 2
+
+// 录像文件头(固定大小,按结构体直接读写,录像只在同一字节序的机器之间通用)
+typedef struct
+{
+    Uint32 magic;
+    Uint32 version;
+    Uint32 tickRate;   // 录制时的逻辑帧率
+    Uint32 frameCount; // 逻辑帧数量(录制结束时回写)
+    Uint64 seed;       // 随机数种子
+} ReplayHeader;
+
+// 一个逻辑帧的输入(固定大小),按逻辑帧顺序紧挨着存放在文件头后面
+typedef struct
+{
+    Uint16 buttons;      // 按键状态,每一位的含义由调用者决定
+    Uint8 action;        // 这一帧触发的一次性操作(比如选择武器),0为没有
+    Uint8 reserved;      // 对齐用,始终为0
+    float mouseX;        // 鼠标的世界坐标
+    float mouseY;
+    float zoom;          // 相机缩放(影响刷怪位置)
+    Uint32 rngChecksum;  // 这一帧开始时随机数状态的校验值(回放时用来检查是否同步)
+    Uint32 stateHash;    // 这一帧开始时游戏状态的哈希(随机数没有分叉但逻辑结果不同时也能发现)
+} ReplayFrame;
+
+typedef enum
+{
+    REPLAY_OFF,
+    REPLAY_RECORD, // 录制:每个逻辑帧写入一帧
+    REPLAY_PLAY    // 回放:每个逻辑帧读出一帧
+} ReplayMode;
+
+// 录像:记录每个逻辑帧的输入和随机数种子,回放时按逻辑帧原样送回,游戏逻辑的结果完全相同
+typedef struct
+{
+    ReplayMode mode;
+    FILE *file;
+    ReplayHeader header;
+    Uint32 cursor;      // 回放时下一帧的编号
+    Sint64 desyncFrame; // 回放时第一个随机数校验值或状态哈希不一致的帧,-1为一直同步
+} Replay;
+
+// 开始录制(覆盖已有文件),失败返回false
+bool Replay_BeginRecord(Replay *replay, const char *path, Uint64 seed, int tickRate);
+
+// 打开录像准备回放(检查文件头),失败返回false
+bool Replay_BeginPlay(Replay *replay, const char *path);
+
+// 录制一帧
+bool Replay_WriteFrame(Replay *replay, const ReplayFrame *frame);
+
+// 回放一帧,录像结束时返回false
+bool Replay_ReadFrame(Replay *replay, ReplayFrame *frame);
+
+// 回放时检查这一帧开始时的随机数校验值和状态哈希,记录第一个不一致的帧,返回是否一致
+bool Replay_CheckSync(Replay *replay, const ReplayFrame *frame, Uint32 rngChecksum, Uint32 stateHash);
+
+// 结束录制(回写帧数)或回放,关闭文件;可以重复调用
+void Replay_End(Replay *replay);
+
+#endif // REPLAY_H
@@ -0,0 +1,27 @@
+#ifndef RNG_H
+#define RNG_H
+#include <SDL3/SDL.h>
+
+// 确定性随机数(xorshift64*):同样的种子在任何平台上生成同样的序列
+// 游戏里所有影响逻辑的随机数都从这里取,种子写进录像,回放时结果完全相同
+typedef struct
+{
+    Uint64 state;
+} Rng;
+
+// 设置种子(任何值都可以,包括0)
+void Rng_Seed(Rng *rng, Uint64 seed);
+
+// 下一个32位随机数
+Uint32 Rng_Next(Rng *rng);
+
+// [0,n)的随机整数(n<=0时返回0)
+int Rng_Int(Rng *rng, int n);
+
+// [0,1)的随机小数
+float Rng_Float(Rng *rng);
+
+// 当前状态的低32位(录像里每个逻辑帧记录一次,回放时用来检查是否同步)
+Uint32 Rng_Checksum(const Rng *rng);
+
+#endif // RNG_H
@@ -0,0 +1,80 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+#include "character.h"
+#include "flowField.h"
+#include "jobSystem.h"
+#include "spatialGrid.h"
+#include <SDL3/SDL.h>
+#include <stdbool.h>
+
+// 一个逻辑帧里的各个阶段(按执行顺序)
+typedef enum
+{
+    SIM_PHASE_PLAYER,     // 玩家操作,射击,撞墙
+    SIM_PHASE_AI,         // 敌人按流场转向玩家
+    SIM_PHASE_CHARACTERS, // CharacterPool_Update
+    SIM_PHASE_BULLETS,    // BulletPool_Update(同时在另一个线程更新流场)
+    SIM_PHASE_CLEANUP,    // 删除死亡的敌人并计分
+    SIM_PHASE_COUNT
+} SimulationPhase;
+
+// 四面墙(玩家撞到后被推回)
+typedef enum
+{
+    SIM_WALL_UP,
+    SIM_WALL_DOWN,
+    SIM_WALL_LEFT,
+    SIM_WALL_RIGHT,
+    SIM_WALL_COUNT
+} SimulationWall;
+
+// 一个逻辑帧的玩家输入
+typedef struct
+{
+    bool moveForward;
+    bool turnLeft;
+    bool turnRight;
+    bool headShoot;
+    bool tailShoot;
+} SimulationInput;
+
+// 游戏逻辑:不依赖窗口和渲染器,游戏场景和无窗口的基准测试共用
+// 角色池的第0个角色是玩家
+typedef struct
+{
+    CharacterPool *characters;
+    BulletPool *bullets;
+    JobSystem *jobs;                       // 为NULL时在当前线程执行
+    FlowField *flowField;                  // 敌人寻路的流场(为NULL时敌人直线转向玩家)
+    AABBBox walls[SIM_WALL_COUNT];         // 四面墙的碰撞盒
+    bool haveWalls;                        // 是否有墙
+    int score;                             // 分数
+    Uint64 tickCount;                      // 已经执行的逻辑帧数
+    Uint64 phaseTime[SIM_PHASE_COUNT];     // 每个阶段累计耗时(性能计数器单位)
+} Simulation;
+
+// 初始化游戏逻辑(不拥有角色池,子弹池,线程池和流场)
+void Simulation_Init(Simulation *sim, CharacterPool *characters, BulletPool *bullets, JobSystem *jobs);
+
+// 设置四面墙(按SimulationWall的顺序)
+void Simulation_SetWalls(Simulation *sim, const AABBBox walls[SIM_WALL_COUNT]);
+
+// 设置敌人寻路的流场(障碍由调用者注册),设置后流场会在下一个逻辑帧重新计算
+void Simulation_SetFlowField(Simulation *sim, FlowField *field);
+
+// 执行一个逻辑帧
+void Simulation_Tick(Simulation *sim, const SimulationInput *input);
+
+// 获取玩家角色(角色池为空时返回NULL)
+Character *Simulation_GetPlayer(const Simulation *sim);
+
+// 游戏状态的哈希(玩家头部位置和血量,角色数量,分数),回放时和随机数校验值一起检查是否同步
+Uint32 Simulation_StateHash(const Simulation *sim);
+
+// 清零计时
+void Simulation_ResetStats(Simulation *sim);
+
+// 阶段名称
+const char *Simulation_PhaseName(SimulationPhase phase);
+
+#endif // SIMULATION_H
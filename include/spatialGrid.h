@@ -0,0 +1,70 @@
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+#include <SDL3/SDL.h>
+#include <stdbool.h>
+
+#define DEFALUT_GRID_CELL_SIZE 256.0f // 默认格子边长(世界坐标)
+
+typedef struct
+{
+    float minX, maxX, minY, maxY;
+} AABBBox;
+
+// 两个包围盒是否相交(包括边上)
+bool AABBBoxCollision(AABBBox a, AABBBox b);
+
+// 相机视野矩形(x,y为左上角,世界y轴向上)转包围盒
+AABBBox Rect_To_AABBBox(SDL_FRect rect);
+
+// 包围盒转矩形(x,y为左下角,和Polygon_DrawRect的参数一致)
+SDL_FRect AABBBox_To_Rect(AABBBox box);
+
+// 网格中的一条记录:某个物体占据了某个格子
+typedef struct
+{
+    int index;        // 物体编号(建网格时包围盒数组的下标)
+    int cellX, cellY; // 所在格子坐标(用于剔除哈希冲突)
+} SpatialGridEntry;
+
+// 均匀空间哈希网格(碰撞检测的宽阶段)
+// 每个逻辑帧用所有物体的包围盒重建一次,重建和查询的代价都和物体数量成线性关系
+typedef struct
+{
+    float cellSize;            // 格子边长
+    float invCellSize;         // 格子边长的倒数
+    int bucketCount;           // 哈希桶数量(2的幂)
+    int bucketCapacity;        // 桶数组容量
+    int *bucketStart;          // 每个桶在entries中的起始位置,长度为bucketCount+1
+    SpatialGridEntry *entries; // 按桶排好序的记录
+    int entryCount;            // 记录数量
+    int entryCapacity;         // 记录数组容量
+    int *firstCell;            // 每个物体覆盖的第一个格子(x,y),查询时用来去重
+    int objectCount;           // 物体数量
+    int objectCapacity;        // 物体数组容量
+} SpatialGrid;
+
+// 网格查询的遍历状态(只读网格,可以多个查询同时进行)
+typedef struct
+{
+    int x0, y0, x1, y1; // 查询覆盖的格子范围
+    int cx, cy;         // 当前遍历到的格子
+    int cursor, end;    // 当前桶内的遍历位置
+} SpatialGridQuery;
+
+// 初始化网格(cellSize<=0时使用默认值)
+void SpatialGrid_Init(SpatialGrid *grid, float cellSize);
+
+// 释放网格内存
+void SpatialGrid_Destroy(SpatialGrid *grid);
+
+// 用包围盒数组重建网格(包围盒的下标就是物体编号)
+bool SpatialGrid_Build(SpatialGrid *grid, const AABBBox *boxes, int count);
+
+// 开始查询与box重叠的格子里的物体
+void SpatialGrid_QueryBegin(const SpatialGrid *grid, AABBBox box, SpatialGridQuery *query);
+
+// 获取下一个候选物体编号(每个物体只返回一次),遍历结束返回-1
+int SpatialGrid_QueryNext(const SpatialGrid *grid, SpatialGridQuery *query);
+
+#endif // SPATIAL_GRID_H
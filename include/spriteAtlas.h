@@ -0,0 +1,38 @@
+#ifndef SPRITE_ATLAS_H
+#define SPRITE_ATLAS_H
+#include "batchingRender.h"
+#include <SDL3/SDL.h>
+#include <stdbool.h>
+
+#define MAX_ATLAS_SPRITES 32           // 图集里最多的图片数量
+#define DEFALUT_SPRITE_ATLAS_WIDTH 512 // 图集纹理宽度,高度按需要的行数决定
+#define SPRITE_ATLAS_PADDING 1         // 图片之间留的空隙
+
+// 一张图片在图集里的位置
+typedef struct
+{
+    SDL_FRect uv; // 归一化纹理坐标
+    float width;  // 原图的像素大小
+    float height;
+} Sprite;
+
+// 精灵图集:加载时把多张图片拼到一张纹理上,画图只往批次里写旋转后的矩形
+// 所有精灵共用一张纹理,同一个批次里的精灵一次drawcall画完,多一个精灵只多4个顶点
+typedef struct
+{
+    SDL_Texture *texture;
+    Sprite sprites[MAX_ATLAS_SPRITES]; // 下标和加载时的路径顺序一致
+    int count;
+} SpriteAtlas;
+
+// 按顺序加载count张图片并拼成图集(像素风格,使用最近邻采样),有图片加载失败时返回NULL
+SpriteAtlas *SpriteAtlas_Load(SDL_Renderer *renderer, const char *const paths[], int count);
+
+// 销毁图集和纹理
+void SpriteAtlas_Destroy(SpriteAtlas *atlas);
+
+// 画第index张图片:pos为屏幕位置(图片中心),angle为逆时针角度(角度制),scale为缩放系数
+// batch必须是屏幕坐标并且使用图集的纹理
+bool SpriteAtlas_Draw(const SpriteAtlas *atlas, BatchRenderer *batch, int index, SDL_FPoint pos, float angle, float scale);
+
+#endif // SPRITE_ATLAS_H
@@ -0,0 +1,62 @@
+#ifndef STATIC_GEOMETRY_H
+#define STATIC_GEOMETRY_H
+#include "batchingRender.h"
+#include "spatialGrid.h"
+#include <SDL3/SDL.h>
+#include <stdbool.h>
+
+// 静态几何里的一个网格(注册时三角化好,之后不再改变)
+typedef struct
+{
+    int firstVertex; // 在顶点数组里的起始位置
+    int vertexCount;
+    int firstIndex; // 在索引数组里的起始位置(索引值是整个图层里的顶点下标)
+    int indexCount;
+    AABBBox bounds; // 世界坐标包围盒(整个网格一起剔除)
+} StaticMesh;
+
+// 静态几何图层:墙和地面装饰这类不会移动的几何,注册一次,顶点一直以世界坐标保留
+// 剔除结果按一块比视野大一圈的区域缓存,视野还在这块区域里时不重新剔除
+// 每帧只把缓存的可见顶点复制进世界批次,相机变换由批次统一做(和角色一起一次drawcall)
+typedef struct
+{
+    SDL_Vertex *vertices; // 世界坐标顶点(注册后不变)
+    int vertexCount;
+    int vertexCapacity;
+    int *indices; // 所有网格的索引
+    int indexCount;
+    int indexCapacity;
+    StaticMesh *meshes;
+    int meshCount;
+    int meshCapacity;
+
+    SDL_Vertex *visibleVertices; // 可见网格的顶点(世界坐标,紧凑排列)
+    int visibleVertexCount;
+    int *visibleIndices; // 可见网格的索引(值为visibleVertices的下标)
+    int visibleIndexCount;
+    int visibleMeshCount;
+
+    AABBBox cullBox; // 上一次剔除用的区域(视野向外扩出一圈)
+    bool cacheValid; // 剔除之后没有注册新网格
+} StaticGeometry;
+
+// 创建静态几何图层
+StaticGeometry *StaticGeometry_Create(void);
+
+// 销毁静态几何图层
+void StaticGeometry_Destroy(StaticGeometry *layer);
+
+// 注册一个简单多边形(可以是凹多边形),用耳切法三角化一次;points为世界坐标,按顺时针或逆时针顺序排列
+// 返回网格编号,失败返回-1
+int StaticGeometry_AddPolygon(StaticGeometry *layer, const SDL_FPoint *points, int pointCount, SDL_FColor color);
+
+// 注册一个矩形(参数含义和Polygon_DrawRect一样),返回网格编号,失败返回-1
+int StaticGeometry_AddRect(StaticGeometry *layer, float x, float y, float width, float height, SDL_FColor color);
+
+// 把视野viewBox里的网格追加到世界坐标批次(batch必须已经Batch_SetCamera),视野超出缓存区域时才重新剔除
+bool StaticGeometry_AppendToBatch(StaticGeometry *layer, BatchRenderer *batch, AABBBox viewBox);
+
+// 获取统计:网格总数和当前缓存里可见的网格数
+void StaticGeometry_GetStats(const StaticGeometry *layer, int *meshCount, int *visibleMeshCount);
+
+#endif // STATIC_GEOMETRY_H
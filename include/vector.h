@@ -1,6 +1,8 @@
 #ifndef VECTOR_H
 #define VECTOR_H
 #define COS45 0.707107f
+#define COS30 0.866025f
+#define SIN30 0.5f
 #include <SDL3/SDL.h>
 typedef struct
 {
@@ -17,7 +19,12 @@ Vector counterclockwise_90(Vector v);                      // 逆时针转90度
 Vector clockwise_90(Vector v);                             // 顺时针转90度
 Vector counterclockwise_45(Vector v);                      // 逆时针转45度
 Vector clockwise_45(Vector v);                             // 顺时针转45度
+Vector counterclockwise_30(Vector v);                      // 逆时针转30度
+Vector clockwise_30(Vector v);                             // 顺时针转30度
+Vector counterclockwise_60(Vector v);                      // 逆时针转60度
+Vector clockwise_60(Vector v);                             // 顺时针转60度
 Vector counterclockwise(Vector v, float angle);            // 逆时针转angle度
 SDL_FPoint Get_FPoint_From_parametric_equation(const SDL_FPoint p0, Vector direction, float radius);
 float Angle_To_Rad(float angle); // 角度转弧度
+SDL_FPoint Lerp_FPoint(SDL_FPoint a, SDL_FPoint b, float t); // 从a到b线性插值(t为0时是a,为1时是b)
 #endif
\ No newline at end of file
@@ -1,6 +1,10 @@
 #include "batchingRender.h"
+#include <math.h>
 #include <stdlib.h>
 #include <string.h>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
 
 // 默认初始容量
 #define DEFAULT_VERTEX_CAPACITY 1024
@@ -33,11 +37,25 @@ BatchRenderer *Batch_CreateRenderer(int initialVertexCapacity, int initialIndexC
         return NULL;
     }
 
+    // 分配临时内存
+    if (!FrameArena_Init(&batch->arena, DEFALUT_FRAME_ARENA_SIZE))
+    {
+        free(batch->indices);
+        free(batch->vertices);
+        free(batch);
+        return NULL;
+    }
+
     // 初始化成员
     batch->vertexCount = 0;
     batch->vertexCapacity = initialVertexCapacity;
     batch->indexCount = 0;
     batch->indexCapacity = initialIndexCapacity;
+    batch->transform = Camera_GetTransform(NULL);
+    batch->worldSpace = false;
+    batch->transformedCount = 0;
+    batch->savedVertexCount = 0;
+    batch->texture = NULL;
 
     return batch;
 }
@@ -48,6 +66,7 @@ void Batch_DestroyRenderer(BatchRenderer *batch)
     if (!batch) return;
     if (batch->vertices) free(batch->vertices);
     if (batch->indices) free(batch->indices);
+    FrameArena_Destroy(&batch->arena);
     free(batch);
 }
 
@@ -58,12 +77,83 @@ void Batch_Clear(BatchRenderer *batch)
 
     batch->vertexCount = 0;
     batch->indexCount = 0;
+    FrameArena_Reset(&batch->arena);
+    batch->worldSpace = false;
+    batch->transformedCount = 0;
+    batch->savedVertexCount = 0;
+}
+
+// 设置本帧的相机
+void Batch_SetCamera(BatchRenderer *batch, const Camera *camera)
+{
+    if (!batch || !camera) return;
+    // 已经添加的顶点按原来的坐标系定下来(屏幕坐标不再变换,世界坐标用原来的快照变换)
+    Batch_TransformVertices(batch);
+    batch->transform = Camera_GetTransform(camera);
+    batch->worldSpace = true;
+}
+
+// 设置整个批次共用的纹理
+void Batch_SetTexture(BatchRenderer *batch, SDL_Texture *texture)
+{
+    if (!batch) return;
+    batch->texture = texture;
+}
+
+// 本帧还没设置相机时取相机快照,camera为NULL时切回屏幕坐标
+void Batch_UseCamera(BatchRenderer *batch, const Camera *camera)
+{
+    if (!batch) return;
+    if (camera && !batch->worldSpace)
+    {
+        Batch_SetCamera(batch, camera);
+    }
+    else if (!camera && batch->worldSpace)
+    {
+        // 之前的世界坐标顶点先变换掉,之后添加的屏幕坐标顶点不再变换
+        Batch_TransformVertices(batch);
+        batch->worldSpace = false;
+    }
+}
+
+// 把还没变换的顶点变换到屏幕坐标
+void Batch_TransformVertices(BatchRenderer *batch)
+{
+    if (!batch) return;
+    if (!batch->worldSpace)
+    {
+        batch->transformedCount = batch->vertexCount;
+        return;
+    }
+
+    const CameraTransform t = batch->transform;
+    int i = batch->transformedCount;
+#if defined(__SSE2__)
+    // 两个顶点的位置拼成一个(x0,y0,x1,y1),一次乘加
+    const __m128 scale = _mm_setr_ps(t.scaleX, t.scaleY, t.scaleX, t.scaleY);
+    const __m128 offset = _mm_setr_ps(t.offsetX, t.offsetY, t.offsetX, t.offsetY);
+    for (; i + 2 <= batch->vertexCount; i += 2)
+    {
+        __m64 *p0 = (__m64 *)&batch->vertices[i].position;
+        __m64 *p1 = (__m64 *)&batch->vertices[i + 1].position;
+        __m128 xy = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), p0), p1);
+        xy = _mm_add_ps(_mm_mul_ps(xy, scale), offset);
+        _mm_storel_pi(p0, xy);
+        _mm_storeh_pi(p1, xy);
+    }
+#endif
+    for (; i < batch->vertexCount; i++)
+    {
+        batch->vertices[i].position.x = batch->vertices[i].position.x * t.scaleX + t.offsetX;
+        batch->vertices[i].position.y = batch->vertices[i].position.y * t.scaleY + t.offsetY;
+    }
+    batch->transformedCount = batch->vertexCount;
 }
 
 // 确保顶点数组有足够空间
 static bool Batch_EnsureVertexCapacity(BatchRenderer *batch, int requiredCapacity)
 {
-    if (!batch || requiredCapacity <= 0) return false;
+    if (!batch || requiredCapacity < 0) return false;
 
     if (requiredCapacity <= batch->vertexCapacity) return true;
 
@@ -86,7 +176,7 @@ static bool Batch_EnsureVertexCapacity(BatchRenderer *batch, int requiredCapacit
 // 确保索引数组有足够空间
 static bool Batch_EnsureIndexCapacity(BatchRenderer *batch, int requiredCapacity)
 {
-    if (!batch || requiredCapacity <= 0) return false;
+    if (!batch || requiredCapacity < 0) return false;
 
     if (requiredCapacity <= batch->indexCapacity) return true;
 
@@ -106,7 +196,7 @@ static bool Batch_EnsureIndexCapacity(BatchRenderer *batch, int requiredCapacity
     return true;
 }
 
-// 添加顶点到批次（屏幕坐标）
+// 添加顶点到批次（批次的坐标系）
 int Batch_AddVertex(BatchRenderer *batch, const SDL_Vertex *vertex)
 {
     if (!batch || !vertex) return -1;
@@ -141,50 +231,217 @@ bool Batch_AddIndex(BatchRenderer *batch, int index)
 }
 
 // 直接添加一个三角形到批次（3个顶点，3个索引）
-// 注意：这里的点坐标必须是屏幕坐标！
+// 注意：点坐标使用批次的坐标系
 bool Batch_AddTriangle(BatchRenderer *batch, const SDL_FPoint *p1, const SDL_FPoint *p2, const SDL_FPoint *p3, SDL_FColor color)
 {
-    if (!batch || !p1 || !p2 || !p3) return false;
+    if (!p1 || !p2 || !p3) return false;
+
+    // 一次预留3个顶点和3个索引,直接写入批次
+    BatchSpan span;
+    if (!Batch_Reserve(batch, 3, 3, &span)) return false;
+
+    int base = span.baseVertex;
+    Batch_WriteVertex(&span.vertices[0], p1->x, p1->y, color);
+    Batch_WriteVertex(&span.vertices[1], p2->x, p2->y, color);
+    Batch_WriteVertex(&span.vertices[2], p3->x, p3->y, color);
+    span.indices[0] = base;
+    span.indices[1] = base + 1;
+    span.indices[2] = base + 2;
+    return true;
+}
+
+// 预留顶点和索引空间
+bool Batch_Reserve(BatchRenderer *batch, int vertexCount, int indexCount, BatchSpan *span)
+{
+    if (!batch || !span || vertexCount < 0 || indexCount < 0) return false;
 
-    // 确保有足够空间添加3个顶点和3个索引
-    if (!Batch_EnsureVertexCapacity(batch, batch->vertexCount + 3) || !Batch_EnsureIndexCapacity(batch, batch->indexCount + 3))
+    if (!Batch_EnsureVertexCapacity(batch, batch->vertexCount + vertexCount) || !Batch_EnsureIndexCapacity(batch, batch->indexCount + indexCount))
     {
         return false;
     }
 
-    // 创建三个顶点
-    SDL_Vertex vertices[3];
+    span->vertices = &batch->vertices[batch->vertexCount];
+    span->indices = &batch->indices[batch->indexCount];
+    span->baseVertex = batch->vertexCount;
+    batch->vertexCount += vertexCount;
+    batch->indexCount += indexCount;
 
-    vertices[0].position.x = p1->x;
-    vertices[0].position.y = p1->y;
-    vertices[0].color = color;
-    vertices[0].tex_coord.x = 0.0f; // 不使用纹理，设为0
-    vertices[0].tex_coord.y = 0.0f;
+    if (indexCount > vertexCount) batch->savedVertexCount += indexCount - vertexCount;
+    return true;
+}
 
-    vertices[1].position.x = p2->x;
-    vertices[1].position.y = p2->y;
-    vertices[1].color = color;
-    vertices[1].tex_coord.x = 0.0f;
-    vertices[1].tex_coord.y = 0.0f;
+// 添加四边形(4个顶点,6个索引)
+int Batch_AddQuad(BatchRenderer *batch, const SDL_FPoint *p1, const SDL_FPoint *p2, const SDL_FPoint *p3, const SDL_FPoint *p4, SDL_FColor color)
+{
+    if (!p1 || !p2 || !p3 || !p4) return -1;
+
+    BatchSpan span;
+    if (!Batch_Reserve(batch, 4, 6, &span)) return -1;
+
+    int base = span.baseVertex;
+    Batch_WriteVertex(&span.vertices[0], p1->x, p1->y, color);
+    Batch_WriteVertex(&span.vertices[1], p2->x, p2->y, color);
+    Batch_WriteVertex(&span.vertices[2], p3->x, p3->y, color);
+    Batch_WriteVertex(&span.vertices[3], p4->x, p4->y, color);
+    span.indices[0] = base;
+    span.indices[1] = base + 1;
+    span.indices[2] = base + 2;
+    span.indices[3] = base;
+    span.indices[4] = base + 2;
+    span.indices[5] = base + 3;
+    return base;
+}
 
-    vertices[2].position.x = p3->x;
-    vertices[2].position.y = p3->y;
-    vertices[2].color = color;
-    vertices[2].tex_coord.x = 0.0f;
-    vertices[2].tex_coord.y = 0.0f;
+// 添加带纹理的矩形(4个顶点,2个三角形)
+int Batch_AddTexturedQuad(BatchRenderer *batch, const SDL_FRect *dst, const SDL_FRect *uv, SDL_FColor color)
+{
+    if (!dst || !uv) return -1;
+
+    BatchSpan span;
+    if (!Batch_Reserve(batch, 4, 6, &span)) return -1;
+
+    int base = span.baseVertex;
+    Batch_WriteTexturedVertex(&span.vertices[0], dst->x, dst->y, uv->x, uv->y, color);
+    Batch_WriteTexturedVertex(&span.vertices[1], dst->x + dst->w, dst->y, uv->x + uv->w, uv->y, color);
+    Batch_WriteTexturedVertex(&span.vertices[2], dst->x + dst->w, dst->y + dst->h, uv->x + uv->w, uv->y + uv->h, color);
+    Batch_WriteTexturedVertex(&span.vertices[3], dst->x, dst->y + dst->h, uv->x, uv->y + uv->h, color);
+    span.indices[0] = base;
+    span.indices[1] = base + 1;
+    span.indices[2] = base + 2;
+    span.indices[3] = base;
+    span.indices[4] = base + 2;
+    span.indices[5] = base + 3;
+    return base;
+}
+
+// 添加旋转缩放后的精灵(4个顶点,2个三角形)
+int Batch_AddSprite(BatchRenderer *batch, const SDL_FRect *uv, SDL_FPoint center, float width, float height, float angle, SDL_FColor color)
+{
+    if (!uv) return -1;
+
+    BatchSpan span;
+    if (!Batch_Reserve(batch, 4, 6, &span)) return -1;
+
+    // 屏幕坐标y轴向下,逆时针旋转:(dx,dy) -> (dx*cos + dy*sin, -dx*sin + dy*cos)
+    const float radian = angle * (float)M_PI / 180.0f;
+    const float c = cosf(radian), s = sinf(radian);
+    const float hw = width * 0.5f, hh = height * 0.5f;
+    const float corners[4][2] = {{-hw, -hh}, {hw, -hh}, {hw, hh}, {-hw, hh}};
+    const float u[4] = {uv->x, uv->x + uv->w, uv->x + uv->w, uv->x};
+    const float v[4] = {uv->y, uv->y, uv->y + uv->h, uv->y + uv->h};
+    for (int i = 0; i < 4; i++)
+    {
+        float dx = corners[i][0], dy = corners[i][1];
+        Batch_WriteTexturedVertex(&span.vertices[i], center.x + dx * c + dy * s, center.y - dx * s + dy * c, u[i], v[i], color);
+    }
+
+    int base = span.baseVertex;
+    span.indices[0] = base;
+    span.indices[1] = base + 1;
+    span.indices[2] = base + 2;
+    span.indices[3] = base;
+    span.indices[4] = base + 2;
+    span.indices[5] = base + 3;
+    return base;
+}
+
+// 添加三角形扇形(rimCount+1个顶点)
+int Batch_AddFan(BatchRenderer *batch, const SDL_FPoint *hub, const SDL_FPoint *rim, int rimCount, bool closed, SDL_FColor color)
+{
+    if (!hub || !rim || rimCount < 2) return -1;
+
+    int triangleCount = closed ? rimCount : rimCount - 1;
+    BatchSpan span;
+    if (!Batch_Reserve(batch, rimCount + 1, triangleCount * 3, &span)) return -1;
+
+    int base = span.baseVertex;
+    Batch_WriteVertex(&span.vertices[0], hub->x, hub->y, color);
+    for (int i = 0; i < rimCount; i++)
+    {
+        Batch_WriteVertex(&span.vertices[i + 1], rim[i].x, rim[i].y, color);
+    }
+    for (int i = 0; i < triangleCount; i++)
+    {
+        span.indices[i * 3] = base;
+        span.indices[i * 3 + 1] = base + 1 + i;
+        span.indices[i * 3 + 2] = base + 1 + (i + 1 < rimCount ? i + 1 : 0);
+    }
+    return base;
+}
+
+// 添加三角形带(pointCount个顶点)
+int Batch_AddStrip(BatchRenderer *batch, const SDL_FPoint *points, int pointCount, SDL_FColor color)
+{
+    if (!points || pointCount < 3) return -1;
+
+    int triangleCount = pointCount - 2;
+    BatchSpan span;
+    if (!Batch_Reserve(batch, pointCount, triangleCount * 3, &span)) return -1;
+
+    int base = span.baseVertex;
+    for (int i = 0; i < pointCount; i++)
+    {
+        Batch_WriteVertex(&span.vertices[i], points[i].x, points[i].y, color);
+    }
+    for (int i = 0; i < triangleCount; i++)
+    {
+        span.indices[i * 3] = base + i;
+        span.indices[i * 3 + 1] = base + i + 1;
+        span.indices[i * 3 + 2] = base + i + 2;
+    }
+    return base;
+}
+
+// 用已有顶点添加三角形
+bool Batch_AddIndexedTriangle(BatchRenderer *batch, int i1, int i2, int i3)
+{
+    if (!batch || i1 < 0 || i2 < 0 || i3 < 0 || i1 >= batch->vertexCount || i2 >= batch->vertexCount || i3 >= batch->vertexCount) return false;
+
+    BatchSpan span;
+    if (!Batch_Reserve(batch, 0, 3, &span)) return false;
+
+    span.indices[0] = i1;
+    span.indices[1] = i2;
+    span.indices[2] = i3;
+    return true;
+}
+
+// 追加另一个批次
+bool Batch_Append(BatchRenderer *dst, const BatchRenderer *src)
+{
+    if (!dst || !src) return false;
+    if (src->vertexCount == 0 && src->indexCount == 0) return true;
 
-    // 添加顶点并获取索引
-    int baseIndex = batch->vertexCount;
-    for (int i = 0; i < 3; i++)
+    // 坐标系必须一致:屏幕坐标的src不能追加到世界坐标的dst;src里已经变换过的顶点追加后会被再变换一次
+    if (!src->worldSpace && dst->worldSpace) return false;
+    if (src->worldSpace && src->transformedCount > 0) return false;
+
+    // dst还没有使用src的相机快照时,先把dst已有的顶点按原来的坐标系定下来(和Batch_SetCamera一样)
+    if (src->worldSpace)
     {
-        batch->vertices[batch->vertexCount++] = vertices[i];
+        const CameraTransform *a = &dst->transform, *b = &src->transform;
+        if (!dst->worldSpace || a->scaleX != b->scaleX || a->scaleY != b->scaleY || a->offsetX != b->offsetX || a->offsetY != b->offsetY)
+        {
+            Batch_TransformVertices(dst);
+            dst->transform = src->transform;
+            dst->worldSpace = true;
+        }
     }
+    if (!dst->texture) dst->texture = src->texture;
+
+    BatchSpan span;
+    if (!Batch_Reserve(dst, src->vertexCount, src->indexCount, &span)) return false;
 
-    // 添加三角形索引（0, 1, 2）
-    batch->indices[batch->indexCount++] = baseIndex;
-    batch->indices[batch->indexCount++] = baseIndex + 1;
-    batch->indices[batch->indexCount++] = baseIndex + 2;
+    // Batch_Reserve按数量差计算了省下的顶点,这里换成src自己统计的值
+    dst->savedVertexCount -= src->indexCount > src->vertexCount ? src->indexCount - src->vertexCount : 0;
+    dst->savedVertexCount += src->savedVertexCount;
 
+    memcpy(span.vertices, src->vertices, sizeof(SDL_Vertex) * src->vertexCount);
+    const int base = span.baseVertex;
+    for (int i = 0; i < src->indexCount; i++)
+    {
+        span.indices[i] = src->indices[i] + base;
+    }
     return true;
 }
 
@@ -193,7 +450,8 @@ bool Batch_Render(BatchRenderer *batch, SDL_Renderer *renderer)
 {
     if (!batch || !renderer || batch->vertexCount == 0) return false;
 
-    // 注意：批次中的顶点已经是屏幕坐标，不需要应用相机变换！
+    // 世界坐标的顶点在这里统一变换到屏幕坐标
+    Batch_TransformVertices(batch);
 
     // 渲染几何体
     bool success = false;
@@ -202,14 +460,14 @@ bool Batch_Render(BatchRenderer *batch, SDL_Renderer *renderer)
     {
         // 使用索引渲染
         success = SDL_RenderGeometry(renderer,
-                                     NULL, // 没有纹理
+                                     batch->texture, // 纯色批次为NULL
                                      batch->vertices, batch->vertexCount, batch->indices, batch->indexCount);
     }
     else
     {
         // 如果没有索引，则按三角形列表渲染（每3个顶点一个三角形）
         success = SDL_RenderGeometry(renderer,
-                                     NULL, // 没有纹理
+                                     batch->texture, // 纯色批次为NULL
                                      batch->vertices, batch->vertexCount, NULL, 0);
     }
 
@@ -241,5 +499,8 @@ void Batch_GetStats(const BatchRenderer *batch, int *vertexCount, int *indexCoun
     }
 }
 
+// 获取本帧共享顶点省下的顶点数量
+int Batch_GetSavedVertexCount(const BatchRenderer *batch) { return batch ? batch->savedVertexCount : 0; }
+
 // 检查批次是否为空
 bool Batch_IsEmpty(const BatchRenderer *batch) { return !batch || (batch->vertexCount == 0 && batch->indexCount == 0); }
\ No newline at end of file
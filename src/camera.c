@@ -9,6 +9,8 @@ Camera *Camera_Create(float x, float y, int screenWidth, int screenHeight)
     // 设置初始位置
     camera->x = x;
     camera->y = y;
+    camera->prevX = x;
+    camera->prevY = y;
 
     // 设置默认缩放
     camera->zoom = 1.0f;
@@ -97,6 +99,21 @@ SDL_FPoint Camera_WorldToScreen(const Camera *camera, float worldX, float worldY
     return screenPoint;
 }
 
+// 获取相机变换快照:把Camera_WorldToScreen的公式展开成 缩放+平移
+// screenX = worldX * zoom + (screenWidth/2 - cameraX * zoom)
+// screenY = worldY * (-zoom) + (screenHeight/2 + cameraY * zoom)
+CameraTransform Camera_GetTransform(const Camera *camera)
+{
+    CameraTransform transform = {1.0f, 1.0f, 0.0f, 0.0f};
+    if (!camera) return transform;
+
+    transform.scaleX = camera->zoom;
+    transform.scaleY = -camera->zoom;
+    transform.offsetX = camera->screenWidth / 2.0f - camera->x * camera->zoom;
+    transform.offsetY = camera->screenHeight / 2.0f + camera->y * camera->zoom;
+    return transform;
+}
+
 // 屏幕坐标转换为世界坐标
 SDL_FPoint Camera_ScreenToWorld(const Camera *camera, float screenX, float screenY)
 {
@@ -213,6 +230,23 @@ void Camera_Reset(Camera *camera)
     camera->zoom = 1.0f;
 }
 
+// 记录当前位置作为上一个逻辑帧的位置
+void Camera_SavePrevious(Camera *camera)
+{
+    if (!camera) return;
+    camera->prevX = camera->x;
+    camera->prevY = camera->y;
+}
+
+// 返回位置插值后的相机副本
+Camera Camera_Interpolate(const Camera *camera, float alpha)
+{
+    Camera result = *camera;
+    result.x = camera->prevX + (camera->x - camera->prevX) * alpha;
+    result.y = camera->prevY + (camera->y - camera->prevY) * alpha;
+    return result;
+}
+
 // camera.c 中的 Camera_GetViewRect 函数
 SDL_FRect Camera_GetViewRect(const Camera *camera)
 {
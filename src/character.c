@@ -1,26 +1,15 @@
 #include "character.h"
 #include "polygon.h"
+#include "profiler.h"
 #include "vector.h"
 #include <math.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
-
-// 渲染纹理,带目标位置(屏幕位置),旋转中心和旋转角度(角度制逆时针),和缩放系数,旋转中心默认为纹理中心
-void Render_Texture(SDL_Renderer *renderer, SDL_Texture *texture, SDL_FPoint pos, float angle, float scale)
-{
-    float texWidth, texHeight;
-    SDL_GetTextureSize(texture, &texWidth, &texHeight);
-    texWidth *= scale;
-    texHeight *= scale;
-    SDL_FRect dst = {pos.x - texWidth / 2, pos.y - texHeight / 2, texWidth, texHeight};
-    SDL_RenderTextureRotated(renderer, texture, NULL, &dst, -angle, NULL, SDL_FLIP_NONE);
-}
-
-// 两个包围盒是否发生碰撞
-bool AABBBoxCollision(AABBBox a, AABBBox b) { return !(a.minY > b.maxY || a.minX > b.maxX || b.minY > a.maxY || b.minX > a.maxX); }
-
-AABBBox Rect_To_AABBBox(SDL_FRect rect) { return (AABBBox){rect.x, rect.x + rect.w, rect.y - rect.h, rect.y}; }
-SDL_FRect AABBBox_To_Rect(AABBBox box) { return (SDL_FRect){box.minX, box.minY, box.maxX - box.minX, box.maxY - box.minY}; }
+#include <string.h>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
 
 // 更新角色的AABB包围盒
 void Character_UpdateAABBBox(Character *character)
@@ -59,15 +48,13 @@ void Character_UpdateAABBBox(Character *character)
     character->box.maxY = maxY;
 }
 
-// 创建并初始化角色
-Character *Character_Creat(enum CharacterType type, float x, float y, Vector initialDirection, float initialSpeed, const float *radiusList, const float *distanceList, const float *flexibility, const int bodyCount, SDL_FColor color, SDL_FColor outLineColor, const Chain3 legs[2])
+// 在已分配好的内存上初始化角色(身体节点也由调用者提供,至少要有bodyCount个)
+bool Character_Init(Character *character, node *body, enum CharacterType type, float x, float y, Vector initialDirection, float initialSpeed, const float *radiusList, const float *distanceList, const float *flexibility, const int bodyCount, SDL_FColor color, SDL_FColor outLineColor, const Chain3 legs[2])
 {
-    if (!radiusList || !distanceList || bodyCount <= 0)
+    if (!character || !body || !radiusList || !distanceList || bodyCount <= 0)
     {
-        return NULL;
+        return false;
     }
-    Character *character = (Character *)malloc(sizeof(Character));
-    if (!character) return NULL;
 
     // 赋值类型
     character->type = type;
@@ -75,13 +62,13 @@ Character *Character_Creat(enum CharacterType type, float x, float y, Vector ini
     {
         if (!legs)
         {
-            free(character);
-            return NULL;
+            return false;
         }
         character->legs[0] = legs[0];
         character->legs[1] = legs[0];
         character->legs[2] = legs[1];
         character->legs[3] = legs[1];
+        character->legSolver = LEG_SOLVER_ANALYTIC;
         character->frontLegPos = 2;
         character->backLegPos = 6;
         character->frontLegMaxDistance = 70.0f;
@@ -92,19 +79,16 @@ Character *Character_Creat(enum CharacterType type, float x, float y, Vector ini
         character->forwardDis[1] = 5.0f;
     }
 
-    // 分配节点
-    character->body = (node *)malloc(bodyCount * sizeof(node));
-    if (!character->body)
-    {
-        free(character);
-        return NULL;
-    }
+    // 节点放在调用者提供的内存里
+    character->body = body;
     vector_Normalization(&initialDirection);
     for (int i = 0; i < bodyCount; i++)
     {
         character->body[i].radius = radiusList[i];
         character->body[i].distance = distanceList[i];
         character->body[i].flexibility = flexibility[i];
+        character->body[i].cosFlex = cosf(Angle_To_Rad(flexibility[i]));
+        character->body[i].sinFlex = sinf(Angle_To_Rad(flexibility[i]));
         if (i == 0)
         {
             character->body[i].x = x;
@@ -141,21 +125,9 @@ Character *Character_Creat(enum CharacterType type, float x, float y, Vector ini
     character->HP = character->maxHP = 100.0f;
     character->haveHeadGun = false;
     character->haveTailGun = false;
-    printf("初始化完成\n");
-    return character;
+    return true;
 }
 
-// 销毁角色
-void Character_Destroy(Character *character)
-{
-    if (!character) return;
-    if (character->body) free(character->body);
-    free(character);
-}
-
-// 更新是否需要渲染
-void Character_check_render(Character *character, const Camera *camera) { character->needRender = AABBBoxCollision(character->renderBox, Rect_To_AABBBox(Camera_GetViewRect(camera))); }
-
 void AddPointToOutline(SDL_FPoint *points, int *count, SDL_FPoint p)
 {
     points[*count] = p;
@@ -173,7 +145,7 @@ void Character_render(const Character *character, SDL_Renderer *renderer, const
         for (int i = 0; i < 4; i++)
         {
             Chain3 leg = character->legs[i];
-            Polygon_DrawCircle(batch, leg.head.x, leg.head.y, leg.headRadius, 10, character->color, camera);
+            Polygon_DrawCircle(batch, leg.head.x, leg.head.y, leg.headRadius, character->color, camera);
             Vector rootToMiddle = vector_get(leg.root.x, leg.root.y, leg.middle.x, leg.middle.y);
             Vector middleToHead = vector_get(leg.middle.x, leg.middle.y, leg.head.x, leg.head.y);
             Vector rootDraw = counterclockwise_90(rootToMiddle);
@@ -196,19 +168,23 @@ void Character_render(const Character *character, SDL_Renderer *renderer, const
             SDL_FPoint head1 = Get_FPoint_From_parametric_equation(leg.head, headDraw, leg.headRadius);
             SDL_FPoint head2 = Get_FPoint_From_parametric_equation(leg.head, negate_vector(headDraw), leg.headRadius);
 
-            // 画填充
-            Polygon_DrawTriangle(batch, leg.root.x, leg.root.y, root1.x, root1.y, middle1.x, middle1.y, character->color, camera);
-            Polygon_DrawTriangle(batch, leg.root.x, leg.root.y, root2.x, root2.y, middle2.x, middle2.y, character->color, camera);
-            // Polygon_DrawTriangle(batch, leg.root.x, leg.root.y, root1.x, root1.y, middle2.x, middle2.y, character->color, camera);
-            // Polygon_DrawTriangle(batch, leg.root.x, leg.root.y, root2.x, root2.y, middle1.x, middle1.y, character->color, camera);
-            Polygon_DrawTriangle(batch, leg.root.x, leg.root.y, leg.middle.x, leg.middle.y, middle1.x, middle1.y, character->color, camera);
-            Polygon_DrawTriangle(batch, leg.root.x, leg.root.y, leg.middle.x, leg.middle.y, middle2.x, middle2.y, character->color, camera);
-            Polygon_DrawTriangle(batch, leg.head.x, leg.head.y, head1.x, head1.y, middle1.x, middle1.y, character->color, camera);
-            Polygon_DrawTriangle(batch, leg.head.x, leg.head.y, head2.x, head2.y, middle2.x, middle2.y, character->color, camera);
-            // Polygon_DrawTriangle(batch, leg.head.x, leg.head.y, head1.x, head1.y, middle2.x, middle2.y, character->color, camera);
-            // Polygon_DrawTriangle(batch, leg.head.x, leg.head.y, head2.x, head2.y, middle1.x, middle1.y, character->color, camera);
-            Polygon_DrawTriangle(batch, leg.head.x, leg.head.y, leg.middle.x, leg.middle.y, middle1.x, middle1.y, character->color, camera);
-            Polygon_DrawTriangle(batch, leg.head.x, leg.head.y, leg.middle.x, leg.middle.y, middle2.x, middle2.y, character->color, camera);
+            // 画填充:9个顶点,8个三角形,一次预留后直接写入批次
+            Batch_UseCamera(batch, camera);
+            BatchSpan span;
+            if (Batch_Reserve(batch, 9, 24, &span))
+            {
+                // 顶点:0根 1根1 2根2 3中 4中1 5中2 6头 7头1 8头2
+                const SDL_FPoint legPoints[9] = {leg.root, root1, root2, leg.middle, middle1, middle2, leg.head, head1, head2};
+                static const int legIndices[24] = {0, 1, 4, 0, 2, 5, 0, 3, 4, 0, 3, 5, 6, 7, 4, 6, 8, 5, 6, 3, 4, 6, 3, 5};
+                for (int k = 0; k < 9; k++)
+                {
+                    Batch_WriteVertex(&span.vertices[k], legPoints[k].x, legPoints[k].y, character->color);
+                }
+                for (int k = 0; k < 24; k++)
+                {
+                    span.indices[k] = span.baseVertex + legIndices[k];
+                }
+            }
 
             // 画描边
             SDL_FPoint top = Get_FPoint_From_parametric_equation(leg.head, middleToHead, leg.headRadius);
@@ -223,11 +199,20 @@ void Character_render(const Character *character, SDL_Renderer *renderer, const
     }
 
     // 关于描边,用画两个三角形表示一条粗线段,总顶点数量为:4*(节点数量+1)
-    // 申请一块内存空间存放顶点位置,最后统一提交给批批渲染器
+    // 从批次的帧内存里取一块空间存放顶点位置,最后统一提交给批批渲染器
+    size_t arenaMark = FrameArena_Mark(&batch->arena);
     int pointCountL = 0;
-    SDL_FPoint *outlinePointsL = (SDL_FPoint *)malloc(sizeof(SDL_FPoint) * (2 * character->bodyCount + 4)); // 左边的描边
+    SDL_FPoint *outlinePointsL = (SDL_FPoint *)FrameArena_Alloc(&batch->arena, sizeof(SDL_FPoint) * (2 * character->bodyCount + 4)); // 左边的描边
     int pointCountR = 0;
-    SDL_FPoint *outlinePointsR = (SDL_FPoint *)malloc(sizeof(SDL_FPoint) * (2 * character->bodyCount + 4)); // 右边的描边
+    SDL_FPoint *outlinePointsR = (SDL_FPoint *)FrameArena_Alloc(&batch->arena, sizeof(SDL_FPoint) * (2 * character->bodyCount + 4)); // 右边的描边
+    // 身体填充是一条三角形带:左右点交替排列,总点数为4*节点数量
+    int stripCount = 0;
+    SDL_FPoint *bodyStrip = (SDL_FPoint *)FrameArena_Alloc(&batch->arena, sizeof(SDL_FPoint) * (4 * character->bodyCount));
+    if (!outlinePointsL || !outlinePointsR || !bodyStrip)
+    {
+        FrameArena_Release(&batch->arena, arenaMark);
+        return;
+    }
 
     // 头部取点(特殊处理)
     node *head = &character->body[0];
@@ -236,18 +221,16 @@ void Character_render(const Character *character, SDL_Renderer *renderer, const
     Vector renderDirection = vector_get(character->body[1].x, character->body[1].y, headPoint.x, headPoint.y); // 渲染头部使用的方向向量,由头部后面一两个节点计算出来
     // 填充
     SDL_FPoint headTop = Get_FPoint_From_parametric_equation(headPoint, renderDirection, head->radius * character->headInside);
-    SDL_FPoint headLeft30 = Get_FPoint_From_parametric_equation(headPoint, counterclockwise(renderDirection, 30), head->radius * character->head30Inside);
-    SDL_FPoint headRight30 = Get_FPoint_From_parametric_equation(headPoint, counterclockwise(renderDirection, -30), head->radius * character->head30Inside);
-    SDL_FPoint headLeft60 = Get_FPoint_From_parametric_equation(headPoint, counterclockwise(renderDirection, 60), head->radius * character->head60Inside);
-    SDL_FPoint headRight60 = Get_FPoint_From_parametric_equation(headPoint, counterclockwise(renderDirection, -60), head->radius * character->head60Inside);
+    SDL_FPoint headLeft30 = Get_FPoint_From_parametric_equation(headPoint, counterclockwise_30(renderDirection), head->radius * character->head30Inside);
+    SDL_FPoint headRight30 = Get_FPoint_From_parametric_equation(headPoint, clockwise_30(renderDirection), head->radius * character->head30Inside);
+    SDL_FPoint headLeft60 = Get_FPoint_From_parametric_equation(headPoint, counterclockwise_60(renderDirection), head->radius * character->head60Inside);
+    SDL_FPoint headRight60 = Get_FPoint_From_parametric_equation(headPoint, clockwise_60(renderDirection), head->radius * character->head60Inside);
     SDL_FPoint headLeft = Get_FPoint_From_parametric_equation(headPoint, counterclockwise_90(renderDirection), head->radius);
     SDL_FPoint headRight = Get_FPoint_From_parametric_equation(headPoint, clockwise_90(renderDirection), head->radius);
-    Polygon_DrawTriangle(batch, headPoint.x, headPoint.y, headTop.x, headTop.y, headLeft30.x, headLeft30.y, character->color, camera);
-    Polygon_DrawTriangle(batch, headPoint.x, headPoint.y, headTop.x, headTop.y, headRight30.x, headRight30.y, character->color, camera);
-    Polygon_DrawTriangle(batch, headPoint.x, headPoint.y, headLeft30.x, headLeft30.y, headLeft60.x, headLeft60.y, character->color, camera);
-    Polygon_DrawTriangle(batch, headPoint.x, headPoint.y, headRight30.x, headRight30.y, headRight60.x, headRight60.y, character->color, camera);
-    Polygon_DrawTriangle(batch, headPoint.x, headPoint.y, headLeft60.x, headLeft60.y, headLeft.x, headLeft.y, character->color, camera);
-    Polygon_DrawTriangle(batch, headPoint.x, headPoint.y, headRight60.x, headRight60.y, headRight.x, headRight.y, character->color, camera);
+    // 头部:以头部节点为中心的三角形扇形
+    Batch_UseCamera(batch, camera);
+    SDL_FPoint headRim[7] = {headLeft, headLeft60, headLeft30, headTop, headRight30, headRight60, headRight};
+    Batch_AddFan(batch, &headPoint, headRim, 7, false, character->color);
     // 描边左
     AddPointToOutline(outlinePointsL, &pointCountL, headRight30); // 额外添加右30度点,以获得描边平滑
     AddPointToOutline(outlinePointsL, &pointCountL, headTop);
@@ -265,9 +248,9 @@ void Character_render(const Character *character, SDL_Renderer *renderer, const
     SDL_FPoint lastBodyLeft = headLeft;
     SDL_FPoint lastBodyRight = headRight;
 
-    // 初始化lastLeft2和lastRight2为头部连接点
-    SDL_FPoint lastLeft2 = headLeft;
-    SDL_FPoint lastRight2 = headRight;
+    // 三角形带从头部连接点开始
+    AddPointToOutline(bodyStrip, &stripCount, headLeft);
+    AddPointToOutline(bodyStrip, &stripCount, headRight);
 
     // printf("开始身体绘制，节点数: %d\n", character->bodyCount);
 
@@ -291,12 +274,11 @@ void Character_render(const Character *character, SDL_Renderer *renderer, const
         SDL_FPoint left2 = Get_far_point(lastBodyLeft, nowBodyLeft, CUTTING_DISTANCE);
         SDL_FPoint right2 = Get_far_point(lastBodyRight, nowBodyRight, CUTTING_DISTANCE);
 
-        // 用平滑点绘制连接两个身体节点的四边形（用两个三角形表示）
-        Polygon_DrawTriangle(batch, lastLeft2.x, lastLeft2.y, lastRight2.x, lastRight2.y, left1.x, left1.y, character->color, camera);
-        Polygon_DrawTriangle(batch, left1.x, left1.y, right1.x, right1.y, lastRight2.x, lastRight2.y, character->color, camera);
-        // 用平滑点绘制身体内部的四边形( 用两个三角形表示)
-        Polygon_DrawTriangle(batch, left1.x, left1.y, right1.x, right1.y, left2.x, left2.y, character->color, camera);
-        Polygon_DrawTriangle(batch, left2.x, left2.y, right2.x, right2.y, right1.x, right1.y, character->color, camera);
+        // 平滑点依次加入三角形带:和上一节点之间的连接四边形,以及身体内部的四边形
+        AddPointToOutline(bodyStrip, &stripCount, left1);
+        AddPointToOutline(bodyStrip, &stripCount, right1);
+        AddPointToOutline(bodyStrip, &stripCount, left2);
+        AddPointToOutline(bodyStrip, &stripCount, right2);
         // 描边左
         if (i != 1)
         {
@@ -318,8 +300,6 @@ void Character_render(const Character *character, SDL_Renderer *renderer, const
         }
 
         // 更新上一节点的信息
-        lastLeft2 = left2;
-        lastRight2 = right2;
         lastBodyLeft = nowBodyLeft;
         lastBodyRight = nowBodyRight;
     }
@@ -334,14 +314,13 @@ void Character_render(const Character *character, SDL_Renderer *renderer, const
     SDL_FPoint tailTop = Get_FPoint_From_parametric_equation(tailPoint, tailDirection, tail->radius);
     SDL_FPoint tailLeft45 = Get_FPoint_From_parametric_equation(tailPoint, counterclockwise_45(tailDirection), tail->radius);
     SDL_FPoint tailRight45 = Get_FPoint_From_parametric_equation(tailPoint, clockwise_45(tailDirection), tail->radius);
-    // 渲染身体和尾巴连接处
-    Polygon_DrawTriangle(batch, lastLeft2.x, lastLeft2.y, lastRight2.x, lastRight2.y, lastBodyLeft.x, lastBodyLeft.y, character->color, camera);
-    Polygon_DrawTriangle(batch, lastRight2.x, lastRight2.y, lastBodyLeft.x, lastBodyLeft.y, lastBodyRight.x, lastBodyRight.y, character->color, camera);
-    // 渲染尾巴的四个三角形
-    Polygon_DrawTriangle(batch, tailPoint.x, tailPoint.y, tailTop.x, tailTop.y, tailLeft45.x, tailLeft45.y, character->color, camera);
-    Polygon_DrawTriangle(batch, tailPoint.x, tailPoint.y, tailTop.x, tailTop.y, tailRight45.x, tailRight45.y, character->color, camera);
-    Polygon_DrawTriangle(batch, tailPoint.x, tailPoint.y, tailLeft45.x, tailLeft45.y, lastBodyRight.x, lastBodyRight.y, character->color, camera);
-    Polygon_DrawTriangle(batch, tailPoint.x, tailPoint.y, tailRight45.x, tailRight45.y, lastBodyLeft.x, lastBodyLeft.y, character->color, camera);
+    // 身体和尾巴连接处是三角形带的最后一段
+    AddPointToOutline(bodyStrip, &stripCount, lastBodyLeft);
+    AddPointToOutline(bodyStrip, &stripCount, lastBodyRight);
+    Batch_AddStrip(batch, bodyStrip, stripCount, character->color);
+    // 渲染尾巴:以尾部节点为中心的三角形扇形(四个三角形)
+    SDL_FPoint tailRim[5] = {lastBodyRight, tailLeft45, tailTop, tailRight45, lastBodyLeft};
+    Batch_AddFan(batch, &tailPoint, tailRim, 5, false, character->color);
     // 描边左
     AddPointToOutline(outlinePointsL, &pointCountL, lastBodyLeft);
     AddPointToOutline(outlinePointsL, &pointCountL, tailRight45);
@@ -355,15 +334,14 @@ void Character_render(const Character *character, SDL_Renderer *renderer, const
     // 渲染描边
     Polygon_DrawLines(batch, outlinePointsL, pointCountL, DEFALUT_OUTLINE_WIDTH, character->outLineColor, camera);
     Polygon_DrawLines(batch, outlinePointsR, pointCountR, DEFALUT_OUTLINE_WIDTH, character->outLineColor, camera);
-    // 释放描边顶点数组的内存
-    SDL_free(outlinePointsL);
-    SDL_free(outlinePointsR);
+    // 归还描边和三角形带顶点数组的临时内存
+    FrameArena_Release(&batch->arena, arenaMark);
 
     // 渲染眼睛
     SDL_FPoint leftEye = Get_FPoint_From_parametric_equation(headPoint, counterclockwise_90(renderDirection), head->radius * character->eyeInside);
     SDL_FPoint rightEye = Get_FPoint_From_parametric_equation(headPoint, clockwise_90(renderDirection), head->radius * character->eyeInside);
-    Polygon_DrawCircle(batch, leftEye.x, leftEye.y, character->eyeRadius, 8, character->eyeColor, camera);
-    Polygon_DrawCircle(batch, rightEye.x, rightEye.y, character->eyeRadius, 8, character->eyeColor, camera);
+    Polygon_DrawCircle(batch, leftEye.x, leftEye.y, character->eyeRadius, character->eyeColor, camera);
+    Polygon_DrawCircle(batch, rightEye.x, rightEye.y, character->eyeRadius, character->eyeColor, camera);
 
     // 渲染包围盒(for debug)
     /*
@@ -374,12 +352,6 @@ void Character_render(const Character *character, SDL_Renderer *renderer, const
     */
 }
 
-// 渲染枪
-void Gun_render(const Gun *gun, Vector direction, SDL_Renderer *renderer, const Camera *camera, SDL_Texture *textureList[3])
-{
-    float angle = 57.3 * atan2f(direction.y, direction.x);
-    Render_Texture(renderer, textureList[gun->type], Camera_WorldToScreen(camera, gun->x, gun->y), angle - 90, 5 * camera->zoom);
-}
 // 获取角色头节点指向鼠标的方向(不进行归一化处理)
 Vector Character_get_head_to_mouse_direction(const Character *character, SDL_Renderer *renderer, const Camera *camera)
 {
@@ -421,21 +393,21 @@ void Character_turn_to_mouse(Character *character, SDL_Renderer *renderer, const
     Character_turn_to_vector(character, headToMouse);
 }
 
-// 检查并处理本角色头部与另一个角色整体的碰撞,(第二个参数为自己时,为处理自己头部与身子的碰撞)
-bool Character_HandleCollision(Character *self, const Character *another)
+// 碰撞的计算部分:头部位置由调用者保存,角色本身只读,这样所有角色可以同时对同一份状态做碰撞
+bool Character_CollideHead(const Character *self, SDL_FPoint *head, const Character *another)
 {
-    if (!self || !another || self->bodyCount < 5) // 至少需要5个节点才可能自我碰撞
+    if (!self || !another || !head || self->bodyCount < 5) // 至少需要5个节点才可能自我碰撞
         return false;
 
     bool collisionOccurred = false;
-    node *head = &self->body[0];
+    const node *headNode = &self->body[0];
 
     // 只检查头部与身体其他部分的碰撞（除了直接相连的几个节点）
     // 跳过头部直接相连的节点以避免误检
-    float biggerHeadRadius = head->radius * 1.35f * fmaxf(1.0f, fmaxf(self->headInside, fmaxf(self->head30Inside, self->head60Inside)));
+    float biggerHeadRadius = headNode->radius * 1.35f * fmaxf(1.0f, fmaxf(self->headInside, fmaxf(self->head30Inside, self->head60Inside)));
     for (int i = (self == another ? 4 : 0); i < another->bodyCount; i++)
     {
-        node *bodyPart = &another->body[i];
+        const node *bodyPart = &another->body[i];
 
         // 计算头部与身体节点之间的距离
         float dx = head->x - bodyPart->x;
@@ -462,7 +434,7 @@ bool Character_HandleCollision(Character *self, const Character *another)
             float penetrationDepth = collisionDistance - distance;
 
             // 将头部和身体节点分开（各移动一半距离）
-            // 注意：这里我们只移动头部，因为身体其他部分由Character_update维护
+            // 注意：这里我们只移动头部，因为身体其他部分由Character_UpdateBodies维护
             head->x += separationX * penetrationDepth * 0.5f;
             head->y += separationY * penetrationDepth * 0.5f;
         }
@@ -471,68 +443,268 @@ bool Character_HandleCollision(Character *self, const Character *another)
     return collisionOccurred;
 }
 
-// 根据方向和速度更新角色的身体节点,然后更新渲染盒(渲染盒永远需要更新,规定角色生成后就始终要检测是否需要渲染,没有隐身状态)
-void Character_update(Character *character, CharacterPool *pool, bool isPlayer)
+// 脊椎求解器:把一组角色的身体节点按结构数组排好(第i个节点的第k个通道就是第k个角色的第i个节点),
+// 每个节点依次跟随前一个节点,同一组内的角色互不相关,所以可以在SIMD通道里同时求解
+typedef struct
 {
-    // 添加空指针检查
-    if (!character || !character->body || !pool) return;
+    float x[MAX_BODY_COUNT][SPINE_SOLVER_LANES];
+    float y[MAX_BODY_COUNT][SPINE_SOLVER_LANES];
+    float distance[MAX_BODY_COUNT][SPINE_SOLVER_LANES];
+    float radius[MAX_BODY_COUNT][SPINE_SOLVER_LANES]; // 只用于写回时计算碰撞盒
+    float cosFlex[MAX_BODY_COUNT][SPINE_SOLVER_LANES];
+    float sinFlex[MAX_BODY_COUNT][SPINE_SOLVER_LANES];
+} SpineBatch;
+// 转置搬运依赖node的成员顺序:(x,y,radius,distance)和(distance,flexibility,cosFlex,sinFlex)各自连续
+_Static_assert(offsetof(node, distance) == 3 * sizeof(float) && offsetof(node, sinFlex) == 6 * sizeof(float), "node layout changed, update Character_UpdateBodyGroup");
+
+// 求解一个节点:p1是已经放好的前一个节点,segLen是上一段身体(p2到p1)的长度,p0被拉到p1后面distance处,且两段夹角不超过灵活度
+// 逆时针和顺时针两个极限方向哪个离原方向更近,只取决于叉积的符号,不用真的把两个方向都转出来
+// 极限方向是上一段身体转过一个角度得到的,长度就是segLen,所以每个节点只需要一次开方和一次除法
+static inline void Spine_SolveNodeScalar(float px, float py, float p1x, float p1y, float *p0x, float *p0y, float *segLen, float distance, float cosFlex, float sinFlex)
+{
+    float dx = *p0x - p1x;
+    float dy = *p0y - p1y;
+    float len = sqrtf(dx * dx + dy * dy);
+    // cos(夹角)<cosFlex 等价于 dot<cosFlex*|d|*|p|,任一长度为0时不做限制
+    if (dx * px + dy * py < cosFlex * len * *segLen)
+    {
+        float s = (px * dy - py * dx) * sinFlex > 0 ? sinFlex : -sinFlex;
+        dx = px * cosFlex - py * s;
+        dy = py * cosFlex + px * s;
+        len = *segLen;
+    }
+    float scale = len != 0 ? distance / len : 0.0f;
+    *p0x = p1x + dx * scale;
+    *p0y = p1y + dy * scale;
+    *segLen = len != 0 ? distance : 0.0f;
+}
 
-    // 移动头节点,然后更新身体节点
+static void Spine_Solve(SpineBatch *batch, int nodeCount)
+{
+    // 第一段身体没有前一段,不限制角度(segLen为0时比较恒为假)
+    float segLen[SPINE_SOLVER_LANES] = {0};
+#if defined(__SSE2__)
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+    for (int i = 1; i < nodeCount; i++)
+    {
+        // 同一个节点上的各组通道互不依赖,放在内层循环里让它们的延迟互相重叠
+        for (int k = 0; k < SPINE_SOLVER_LANES; k += 4)
+        {
+            __m128 p1x = _mm_loadu_ps(&batch->x[i - 1][k]);
+            __m128 p1y = _mm_loadu_ps(&batch->y[i - 1][k]);
+            __m128 px = i >= 2 ? _mm_sub_ps(p1x, _mm_loadu_ps(&batch->x[i - 2][k])) : zero;
+            __m128 py = i >= 2 ? _mm_sub_ps(p1y, _mm_loadu_ps(&batch->y[i - 2][k])) : zero;
+            __m128 dx = _mm_sub_ps(_mm_loadu_ps(&batch->x[i][k]), p1x);
+            __m128 dy = _mm_sub_ps(_mm_loadu_ps(&batch->y[i][k]), p1y);
+            __m128 pLen = _mm_loadu_ps(&segLen[k]);
+            __m128 cosFlex = _mm_loadu_ps(&batch->cosFlex[i - 1][k]);
+            __m128 sinFlex = _mm_loadu_ps(&batch->sinFlex[i - 1][k]);
+            __m128 len = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+
+            // 夹角超过限制的通道换成极限方向
+            __m128 dot = _mm_add_ps(_mm_mul_ps(dx, px), _mm_mul_ps(dy, py));
+            __m128 overLimit = _mm_cmplt_ps(dot, _mm_mul_ps(_mm_mul_ps(cosFlex, len), pLen));
+            __m128 turn = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(px, dy), _mm_mul_ps(py, dx)), sinFlex);
+            __m128 s = _mm_xor_ps(sinFlex, _mm_andnot_ps(_mm_cmpgt_ps(turn, zero), signBit)); // 叉积不为正时取-sinFlex
+            __m128 limitX = _mm_sub_ps(_mm_mul_ps(px, cosFlex), _mm_mul_ps(py, s));
+            __m128 limitY = _mm_add_ps(_mm_mul_ps(py, cosFlex), _mm_mul_ps(px, s));
+            dx = _mm_or_ps(_mm_and_ps(overLimit, limitX), _mm_andnot_ps(overLimit, dx));
+            dy = _mm_or_ps(_mm_and_ps(overLimit, limitY), _mm_andnot_ps(overLimit, dy));
+            len = _mm_or_ps(_mm_and_ps(overLimit, pLen), _mm_andnot_ps(overLimit, len));
+
+            // 沿方向放到前一个节点后面distance处(长度为0的通道留在前一个节点上)
+            __m128 nonZero = _mm_cmpneq_ps(len, zero);
+            __m128 distance = _mm_loadu_ps(&batch->distance[i - 1][k]);
+            __m128 scale = _mm_and_ps(nonZero, _mm_div_ps(distance, len));
+            _mm_storeu_ps(&batch->x[i][k], _mm_add_ps(p1x, _mm_mul_ps(dx, scale)));
+            _mm_storeu_ps(&batch->y[i][k], _mm_add_ps(p1y, _mm_mul_ps(dy, scale)));
+            _mm_storeu_ps(&segLen[k], _mm_and_ps(nonZero, distance));
+        }
+    }
+#else
+    for (int i = 1; i < nodeCount; i++)
+    {
+        for (int k = 0; k < SPINE_SOLVER_LANES; k++)
+        {
+            float px = i >= 2 ? batch->x[i - 1][k] - batch->x[i - 2][k] : 0.0f;
+            float py = i >= 2 ? batch->y[i - 1][k] - batch->y[i - 2][k] : 0.0f;
+            Spine_SolveNodeScalar(px, py, batch->x[i - 1][k], batch->y[i - 1][k], &batch->x[i][k], &batch->y[i][k], &segLen[k], batch->distance[i - 1][k], batch->cosFlex[i - 1][k], batch->sinFlex[i - 1][k]);
+        }
+    }
+#endif
+}
+
+// 移动头节点
+static void Character_MoveHead(Character *character)
+{
     vector_Normalization(&character->direction);
     character->body[0].x += character->speed * character->direction.x;
     character->body[0].y += character->speed * character->direction.y;
-    for (int i = 1; i < character->bodyCount; i++)
+}
+
+// 把一个角色从第start个节点开始的身体节点搬进第lane个通道
+// 空通道和节点数不足的通道填距离为0的节点(求解后原地不动),结果都不写回
+static void Spine_GatherLane(SpineBatch *batch, const Character *character, int lane, int start, int nodeCount)
+{
+    int bodyCount = 0;
+    float lastX = 0.0f, lastY = 0.0f;
+    if (character)
     {
-        // 更新身体节点的位置
-        Vector direction_Last_To_Now = vector_get(character->body[i - 1].x, character->body[i - 1].y, character->body[i].x, character->body[i].y);
-        // 限制身体段之间的夹角(脊椎最大灵活度),核心作用:改变direction_Last_To_Now,在角度超过限制的情况下
-        if (i >= 2)
+        const node *body = character->body;
+        bodyCount = character->bodyCount;
+        for (int i = start; i < bodyCount; i++)
         {
-            Vector direction_2Last_To_Last = vector_get(character->body[i - 2].x, character->body[i - 2].y, character->body[i - 1].x, character->body[i - 1].y);
-            float cosOriginalAngle = vector_dot(direction_Last_To_Now, direction_2Last_To_Last) / (vector_norm(direction_Last_To_Now) * vector_norm(direction_2Last_To_Last));
-            float cosMaxAngle = cosf(Angle_To_Rad(character->body[i - 1].flexibility));
-            if (cosOriginalAngle < cosMaxAngle)
-            {
-                Vector counterclockwiseAngle = counterclockwise(direction_2Last_To_Last, character->body[i - 1].flexibility);
-                Vector clockwiseAngle = counterclockwise(direction_2Last_To_Last, -character->body[i - 1].flexibility);
-                if (vector_dot(counterclockwiseAngle, direction_Last_To_Now) > vector_dot(clockwiseAngle, direction_Last_To_Now))
-                {
-                    direction_Last_To_Now = counterclockwiseAngle;
-                }
-                else
-                {
-                    direction_Last_To_Now = clockwiseAngle;
-                }
-            }
+            batch->x[i][lane] = body[i].x;
+            batch->y[i][lane] = body[i].y;
+            batch->distance[i][lane] = body[i].distance;
+            batch->radius[i][lane] = body[i].radius;
+            batch->cosFlex[i][lane] = body[i].cosFlex;
+            batch->sinFlex[i][lane] = body[i].sinFlex;
         }
-        // 获取当前身体节点的新位置
-        SDL_FPoint newPoint = Get_FPoint_From_parametric_equation((SDL_FPoint){character->body[i - 1].x, character->body[i - 1].y}, direction_Last_To_Now, character->body[i - 1].distance);
-        character->body[i].x = newPoint.x;
-        character->body[i].y = newPoint.y;
-    }
-
-    // 更新自己的碰撞盒
-    Character_UpdateAABBBox(character);
-    // 更新渲染盒
-    character->renderBox.minX = character->box.minX - 50;
-    character->renderBox.maxX = character->box.maxX + 50;
-    character->renderBox.minY = character->box.minY - 50;
-    character->renderBox.maxY = character->box.maxY + 50;
-    // 处理与自己(从第4个身体节点开始检测)和其它角色(全部的身体节点)的碰撞
-    for (int i = 0; i < CharacterPool_Size(pool); i++)
-    {
-        Character *other = CharacterPool_Get(pool, i);
-        // 添加空指针检查
-        if (!other) continue;
-        if (AABBBoxCollision(character->box, other->box))
-        {
-            bool collision = Character_HandleCollision(character, other);
-            if (!isPlayer && i == 0 && collision)
-            {
-                other->HP -= 0.1f;
-            }
+        lastX = body[bodyCount - 1].x;
+        lastY = body[bodyCount - 1].y;
+    }
+    for (int i = bodyCount > start ? bodyCount : start; i < nodeCount; i++)
+    {
+        batch->x[i][lane] = lastX;
+        batch->y[i][lane] = lastY;
+        batch->distance[i][lane] = 0.0f;
+        batch->radius[i][lane] = 0.0f;
+        batch->cosFlex[i][lane] = 1.0f;
+        batch->sinFlex[i][lane] = 0.0f;
+    }
+}
+
+// 把第lane个通道从第start个节点开始的求解结果写回角色,box是前start个节点已经算出的碰撞盒,最后得到完整的碰撞盒和渲染盒
+static void Spine_ScatterLane(const SpineBatch *batch, Character *character, int lane, int start, AABBBox box)
+{
+    node *body = character->body;
+    for (int i = start; i < character->bodyCount; i++)
+    {
+        float x = batch->x[i][lane];
+        float y = batch->y[i][lane];
+        float radius = body[i].radius;
+        body[i].x = x;
+        body[i].y = y;
+        box.minX = x - radius < box.minX ? x - radius : box.minX;
+        box.maxX = x + radius > box.maxX ? x + radius : box.maxX;
+        box.minY = y - radius < box.minY ? y - radius : box.minY;
+        box.maxY = y + radius > box.maxY ? y + radius : box.maxY;
+    }
+    character->box = box;
+    character->renderBox = (AABBBox){box.minX - 50, box.maxX + 50, box.minY - 50, box.maxY + 50};
+}
+
+// 更新最多SPINE_SOLVER_LANES个角色的身体:把节点搬进结构数组,一起求解,再写回去
+static void Character_UpdateBodyGroup(Character *const *group, int count)
+{
+    SpineBatch batch;
+    int nodeCount = 0;
+    for (int k = 0; k < count; k++)
+    {
+        Character_MoveHead(group[k]);
+        if (group[k]->bodyCount > nodeCount) nodeCount = group[k]->bodyCount;
+    }
+    int k = 0;
+#if defined(__SSE2__)
+    // 4个角色一组,每个节点用两次4x4转置把(x,y,radius,distance)和(distance,flexibility,cosFlex,sinFlex)换成按通道排列
+    for (; k + 4 <= count; k += 4)
+    {
+        const node *b0 = group[k]->body, *b1 = group[k + 1]->body, *b2 = group[k + 2]->body, *b3 = group[k + 3]->body;
+        int common = SDL_min(SDL_min(group[k]->bodyCount, group[k + 1]->bodyCount), SDL_min(group[k + 2]->bodyCount, group[k + 3]->bodyCount));
+        for (int i = 0; i < common; i++)
+        {
+            __m128 r0 = _mm_loadu_ps(&b0[i].x), r1 = _mm_loadu_ps(&b1[i].x), r2 = _mm_loadu_ps(&b2[i].x), r3 = _mm_loadu_ps(&b3[i].x);
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+            _mm_storeu_ps(&batch.x[i][k], r0);
+            _mm_storeu_ps(&batch.y[i][k], r1);
+            _mm_storeu_ps(&batch.radius[i][k], r2);
+            _mm_storeu_ps(&batch.distance[i][k], r3);
+            __m128 q0 = _mm_loadu_ps(&b0[i].distance), q1 = _mm_loadu_ps(&b1[i].distance), q2 = _mm_loadu_ps(&b2[i].distance), q3 = _mm_loadu_ps(&b3[i].distance);
+            _MM_TRANSPOSE4_PS(q0, q1, q2, q3);
+            _mm_storeu_ps(&batch.cosFlex[i][k], q2);
+            _mm_storeu_ps(&batch.sinFlex[i][k], q3);
+        }
+        for (int lane = k; lane < k + 4; lane++)
+        {
+            Spine_GatherLane(&batch, group[lane], lane, common, nodeCount);
         }
     }
+#endif
+    for (; k < SPINE_SOLVER_LANES; k++)
+    {
+        Spine_GatherLane(&batch, k < count ? group[k] : NULL, k, 0, nodeCount);
+    }
+    Spine_Solve(&batch, nodeCount);
+    // 写回节点,顺便算出碰撞盒(和Character_UpdateAABBBox结果相同,省掉再遍历一次身体)
+    k = 0;
+#if defined(__SSE2__)
+    for (; k + 4 <= count; k += 4)
+    {
+        node *b0 = group[k]->body, *b1 = group[k + 1]->body, *b2 = group[k + 2]->body, *b3 = group[k + 3]->body;
+        int common = SDL_min(SDL_min(group[k]->bodyCount, group[k + 1]->bodyCount), SDL_min(group[k + 2]->bodyCount, group[k + 3]->bodyCount));
+        __m128 headRadius = _mm_add_ps(_mm_loadu_ps(batch.radius[0] + k), _mm_loadu_ps(batch.radius[0] + k));
+        __m128 minX = _mm_sub_ps(_mm_loadu_ps(batch.x[0] + k), headRadius);
+        __m128 maxX = _mm_add_ps(_mm_loadu_ps(batch.x[0] + k), headRadius);
+        __m128 minY = _mm_sub_ps(_mm_loadu_ps(batch.y[0] + k), headRadius);
+        __m128 maxY = _mm_add_ps(_mm_loadu_ps(batch.y[0] + k), headRadius);
+        for (int i = 0; i < common; i++)
+        {
+            __m128 x = _mm_loadu_ps(&batch.x[i][k]);
+            __m128 y = _mm_loadu_ps(&batch.y[i][k]);
+            __m128 radius = _mm_loadu_ps(&batch.radius[i][k]);
+            // (x,y)交错成两对,每个角色只写自己节点的前8个字节
+            __m128 xy01 = _mm_unpacklo_ps(x, y);
+            __m128 xy23 = _mm_unpackhi_ps(x, y);
+            _mm_storel_pi((__m64 *)&b0[i].x, xy01);
+            _mm_storeh_pi((__m64 *)&b1[i].x, xy01);
+            _mm_storel_pi((__m64 *)&b2[i].x, xy23);
+            _mm_storeh_pi((__m64 *)&b3[i].x, xy23);
+            minX = _mm_min_ps(minX, _mm_sub_ps(x, radius));
+            maxX = _mm_max_ps(maxX, _mm_add_ps(x, radius));
+            minY = _mm_min_ps(minY, _mm_sub_ps(y, radius));
+            maxY = _mm_max_ps(maxY, _mm_add_ps(y, radius));
+        }
+        float boxes[4][4];
+        _mm_storeu_ps(boxes[0], minX);
+        _mm_storeu_ps(boxes[1], maxX);
+        _mm_storeu_ps(boxes[2], minY);
+        _mm_storeu_ps(boxes[3], maxY);
+        for (int lane = 0; lane < 4; lane++)
+        {
+            Spine_ScatterLane(&batch, group[k + lane], k + lane, common, (AABBBox){boxes[0][lane], boxes[1][lane], boxes[2][lane], boxes[3][lane]});
+        }
+    }
+#endif
+    for (; k < count; k++)
+    {
+        const node *head = group[k]->body;
+        Spine_ScatterLane(&batch, group[k], k, 0, (AABBBox){head->x - head->radius * 2, head->x + head->radius * 2, head->y - head->radius * 2, head->y + head->radius * 2});
+    }
+}
+
+// 根据方向和速度更新一组角色的身体节点,然后更新碰撞盒和渲染盒(渲染盒永远需要更新,规定角色生成后就始终要检测是否需要渲染,没有隐身状态)
+void Character_UpdateBodies(Character *characters, int count)
+{
+    if (!characters) return;
+    for (int start = 0; start < count; start += SPINE_SOLVER_LANES)
+    {
+        Character *group[SPINE_SOLVER_LANES];
+        int groupCount = SDL_min(SPINE_SOLVER_LANES, count - start);
+        for (int k = 0; k < groupCount; k++)
+        {
+            group[k] = &characters[start + k];
+        }
+        Character_UpdateBodyGroup(group, groupCount);
+    }
+}
+
+// 更新枪的位置和腿的运动
+void Character_UpdateLimbs(Character *character)
+{
+    // 添加空指针检查
+    if (!character || !character->body) return;
 
     // 更新枪的位置
     if (character->haveHeadGun)
@@ -590,9 +762,14 @@ void Character_update(Character *character, CharacterPool *pool, bool isPlayer)
                 {
                     finalPoint = character->legs[i].head;
                 }
-                if (Chain3_Update(&character->legs[i], character->legs[i].root, finalPoint, (i <= 1 ? bodyDir : negate_vector(bodyDir))))
+                Vector aimDirection = (i <= 1 ? bodyDir : negate_vector(bodyDir));
+                if (character->legSolver == LEG_SOLVER_ANALYTIC)
+                {
+                    Chain3_SolveAnalytic(&character->legs[i], character->legs[i].root, finalPoint, aimDirection);
+                }
+                else if (Chain3_Update(&character->legs[i], character->legs[i].root, finalPoint, aimDirection))
                 {
-                    Chain3_Update(&character->legs[i], character->legs[i].root, finalPoint, (i <= 1 ? bodyDir : negate_vector(bodyDir)));
+                    Chain3_Update(&character->legs[i], character->legs[i].root, finalPoint, aimDirection);
                 }
             }
         }
@@ -613,57 +790,133 @@ void Character_speed_set(Character *character, float setSpeed)
 void Character_turn_left(Character *character) { character->direction = counterclockwise(character->direction, character->turnSpeed); }
 void Character_turn_right(Character *character) { character->direction = counterclockwise(character->direction, -character->turnSpeed); }
 //  ---------------------角色池部分----------------------------------
-//  初始化角色池
-void CharacterPool_Init(CharacterPool *pool, int initialCapacity)
+// 每个位置占用的字节数(CharacterPool_Init里每分配一个按容量的数组,这里就要加上它的元素大小)
+static size_t CharacterPool_SlotBytes(void)
+{
+    return sizeof(Character) + MAX_BODY_COUNT * sizeof(node) + sizeof(AABBBox) + sizeof(SDL_FPoint) + sizeof(bool) + sizeof(CharacterSnapshot) + sizeof(int);
+}
+
+// 角色池占用的内存
+size_t CharacterPool_MemoryBytes(const CharacterPool *pool)
+{
+    if (!pool) return 0;
+    size_t bytes = (size_t)pool->capacity * CharacterPool_SlotBytes();
+    bytes += (size_t)pool->grid.bucketCapacity * sizeof(int) + (size_t)pool->grid.entryCapacity * sizeof(SpatialGridEntry) + (size_t)pool->grid.objectCapacity * sizeof(int);
+    return bytes;
+}
+
+//  初始化角色池:角色和身体节点都放在初始化时一次性分配好的连续内存里,之后生成和删除角色都不再调用malloc/free
+void CharacterPool_Init(CharacterPool *pool, int capacity)
 {
     if (!pool) return;
 
-    pool->capacity = initialCapacity;
+    pool->capacity = capacity;
     pool->size = 0;
-    pool->characters = (Character **)malloc(initialCapacity * sizeof(Character *));
-
-    if (!pool->characters)
+    pool->characters = (Character *)malloc(capacity * sizeof(Character));
+    pool->nodes = (node *)malloc((size_t)capacity * MAX_BODY_COUNT * sizeof(node));
+    pool->gridBoxes = (AABBBox *)malloc(capacity * sizeof(AABBBox));
+    pool->newHeads = (SDL_FPoint *)malloc(capacity * sizeof(SDL_FPoint));
+    pool->hitPlayer = (bool *)malloc(capacity * sizeof(bool));
+    pool->previous = (CharacterSnapshot *)malloc(capacity * sizeof(CharacterSnapshot));
+    pool->visible = (int *)malloc(capacity * sizeof(int));
+    pool->visibleCount = 0;
+    pool->droppedCount = 0;
+
+    if (!pool->characters || !pool->nodes || !pool->gridBoxes || !pool->newHeads || !pool->hitPlayer || !pool->previous || !pool->visible)
     {
         fprintf(stderr, "Failed to allocate memory for character pool\n");
         exit(1);
     }
 
-    // 初始化指针数组为NULL
-    memset(pool->characters, 0, initialCapacity * sizeof(Character *));
+    // 初始化空间哈希网格
+    SpatialGrid_Init(&pool->grid, DEFALUT_GRID_CELL_SIZE);
+    pool->gridValid = false;
 }
 
-// 向角色池中添加角色
-void CharacterPool_Add(CharacterPool *pool, Character *character)
+// 记录角色当前的位置
+static void Character_SaveSnapshot(const Character *character, CharacterSnapshot *snapshot)
 {
-    if (!pool || !character) return;
-
-    // 如果需要扩容
-    if (pool->size >= pool->capacity)
+    for (int i = 0; i < character->bodyCount; i++)
+    {
+        snapshot->body[i] = (SDL_FPoint){character->body[i].x, character->body[i].y};
+    }
+    for (int i = 0; i < 4; i++)
     {
-        int newCapacity = pool->capacity * 2;
-        Character **temp = (Character **)realloc(pool->characters, newCapacity * sizeof(Character *));
+        snapshot->legs[i][0] = character->legs[i].root;
+        snapshot->legs[i][1] = character->legs[i].middle;
+        snapshot->legs[i][2] = character->legs[i].head;
+    }
+    snapshot->headGun = (SDL_FPoint){character->headGun.x, character->headGun.y};
+    snapshot->tailGun = (SDL_FPoint){character->tailGun.x, character->tailGun.y};
+}
 
-        if (!temp)
-        {
-            fprintf(stderr, "Failed to resize character pool\n");
-            return;
-        }
+// 记录所有角色当前的位置作为上一个逻辑帧的位置
+void CharacterPool_SavePrevious(CharacterPool *pool)
+{
+    if (!pool) return;
+    for (int i = 0; i < pool->size; i++)
+    {
+        Character_SaveSnapshot(&pool->characters[i], &pool->previous[i]);
+    }
+}
 
-        pool->characters = temp;
-        pool->capacity = newCapacity;
+// 生成第index个角色插值后的副本(只混合位置,方向,速度等其它属性用当前值)
+void CharacterPool_Interpolate(const CharacterPool *pool, int index, float alpha, Character *out, node *outBody)
+{
+    const Character *character = &pool->characters[index];
+    const CharacterSnapshot *previous = &pool->previous[index];
+    *out = *character;
+    out->body = outBody;
+    for (int i = 0; i < character->bodyCount; i++)
+    {
+        SDL_FPoint p = Lerp_FPoint(previous->body[i], (SDL_FPoint){character->body[i].x, character->body[i].y}, alpha);
+        outBody[i] = character->body[i];
+        outBody[i].x = p.x;
+        outBody[i].y = p.y;
+    }
+    for (int i = 0; i < 4; i++)
+    {
+        out->legs[i].root = Lerp_FPoint(previous->legs[i][0], character->legs[i].root, alpha);
+        out->legs[i].middle = Lerp_FPoint(previous->legs[i][1], character->legs[i].middle, alpha);
+        out->legs[i].head = Lerp_FPoint(previous->legs[i][2], character->legs[i].head, alpha);
+    }
+    SDL_FPoint headGun = Lerp_FPoint(previous->headGun, (SDL_FPoint){character->headGun.x, character->headGun.y}, alpha);
+    SDL_FPoint tailGun = Lerp_FPoint(previous->tailGun, (SDL_FPoint){character->tailGun.x, character->tailGun.y}, alpha);
+    out->headGun.x = headGun.x;
+    out->headGun.y = headGun.y;
+    out->tailGun.x = tailGun.x;
+    out->tailGun.y = tailGun.y;
+}
 
-        // 初始化新增的空间为NULL
-        for (int i = pool->size; i < pool->capacity; i++)
-        {
-            pool->characters[i] = NULL;
-        }
+// 在角色池末尾生成一个角色,第index个角色的身体节点固定在节点区的第index段
+Character *CharacterPool_Creat(CharacterPool *pool, enum CharacterType type, float x, float y, Vector initialDirection, float initialSpeed, const float *radiusList, const float *distanceList, const float *flexibility, const int bodyCount, SDL_FColor color, SDL_FColor outLineColor, const Chain3 legs[2])
+{
+    if (!pool) return NULL;
+    if (pool->size >= pool->capacity)
+    {
+        pool->droppedCount++;
+        return NULL;
+    }
+    if (bodyCount > MAX_BODY_COUNT)
+    {
+        fprintf(stderr, "Character body count %d exceeds MAX_BODY_COUNT\n", bodyCount);
+        return NULL;
     }
 
-    pool->characters[pool->size] = character;
+    Character *character = &pool->characters[pool->size];
+    if (!Character_Init(character, &pool->nodes[pool->size * MAX_BODY_COUNT], type, x, y, initialDirection, initialSpeed, radiusList, distanceList, flexibility, bodyCount, color, outLineColor, legs))
+    {
+        return NULL;
+    }
+    // 新角色没有上一个逻辑帧,插值时停在生成位置
+    Character_SaveSnapshot(character, &pool->previous[pool->size]);
     pool->size++;
+    pool->gridValid = false;
+    return character;
 }
 
-// 删除角色池中一个角色(改变顺序):先销毁要删除的角色,然后让i处的指针直接指向最后一个角色,然后把最后一个位置设为NULL使其无法继续掌管之前的数据,最后减少计数器
+// 删除角色池中一个角色(改变顺序):把最后一个角色连同它的身体节点搬到被删除的位置,然后减少计数器,代价和角色数量无关
+// 注意:被搬动的角色地址会改变,外部不要长期持有除玩家(0号,永远不会被删除)以外的角色指针
 void CharacterPool_Remove(CharacterPool *pool, int index)
 {
     if (!pool || index < 0 || index >= pool->size || pool->size == 0)
@@ -671,15 +924,17 @@ void CharacterPool_Remove(CharacterPool *pool, int index)
         return;
     }
 
-    // 先销毁要删除的角色
-    Character_Destroy(pool->characters[index]);
-
-    // 将最后一个元素移到被删除的位置
-    pool->characters[index] = pool->characters[pool->size - 1];
-
-    // 将最后一个位置设为NULL并减少计数
-    pool->characters[pool->size - 1] = NULL;
+    int last = pool->size - 1;
+    if (index != last)
+    {
+        node *slot = &pool->nodes[index * MAX_BODY_COUNT];
+        pool->characters[index] = pool->characters[last];
+        memcpy(slot, pool->characters[last].body, pool->characters[last].bodyCount * sizeof(node));
+        pool->characters[index].body = slot;
+        pool->previous[index] = pool->previous[last];
+    }
     pool->size--;
+    pool->gridValid = false;
 }
 
 // 从角色池中获取角色
@@ -690,7 +945,7 @@ Character *CharacterPool_Get(const CharacterPool *pool, int index)
         return NULL;
     }
 
-    return pool->characters[index];
+    return &pool->characters[index];
 }
 
 // 获取角色池大小
@@ -700,18 +955,93 @@ int CharacterPool_Size(const CharacterPool *pool)
     return pool->size;
 }
 
-// 更新角色池中的所有角色
-void CharacterPool_Update(CharacterPool *pool)
+// 用所有角色当前的碰撞盒重建空间哈希网格
+void CharacterPool_RebuildGrid(CharacterPool *pool)
 {
     if (!pool) return;
 
     for (int i = 0; i < pool->size; i++)
     {
-        Character *character = pool->characters[i];
-        if (character)
+        pool->gridBoxes[i] = pool->characters[i].box;
+    }
+    pool->gridValid = SpatialGrid_Build(&pool->grid, pool->gridBoxes, pool->size);
+}
+
+// 逻辑帧第一阶段:移动一段角色的身体(段的起点是SPINE_SOLVER_LANES的倍数,分组和串行时相同)
+static void CharacterPool_UpdateBodiesJob(void *userData, int jobIndex, int workerIndex)
+{
+    CharacterPool *pool = (CharacterPool *)userData;
+    int begin = jobIndex * UPDATE_CHUNK_SIZE;
+    Character_UpdateBodies(&pool->characters[begin], SDL_min(UPDATE_CHUNK_SIZE, pool->size - begin));
+}
+
+// 逻辑帧第二阶段:每个角色对第一阶段结束时的状态做碰撞,头部新位置先存到newHeads,不修改任何角色
+static void CharacterPool_CollideJob(void *userData, int jobIndex, int workerIndex)
+{
+    CharacterPool *pool = (CharacterPool *)userData;
+    int end = SDL_min((jobIndex + 1) * UPDATE_CHUNK_SIZE, pool->size);
+    for (int i = jobIndex * UPDATE_CHUNK_SIZE; i < end; i++)
+    {
+        const Character *character = &pool->characters[i];
+        SDL_FPoint head = {character->body[0].x, character->body[0].y};
+        bool hitPlayer = false;
+
+        SpatialGridQuery query;
+        SpatialGrid_QueryBegin(&pool->grid, character->box, &query);
+        int j;
+        while ((j = SpatialGrid_QueryNext(&pool->grid, &query)) >= 0)
         {
-            Character_update(character, pool, (i == 0));
+            const Character *other = &pool->characters[j];
+            if (AABBBoxCollision(character->box, other->box) && Character_CollideHead(character, &head, other) && i != 0 && j == 0)
+            {
+                hitPlayer = true;
+            }
         }
+        pool->newHeads[i] = head;
+        pool->hitPlayer[i] = hitPlayer;
+    }
+}
+
+// 逻辑帧第三阶段:写回头部位置,再更新枪和腿(只读写角色自己)
+static void CharacterPool_UpdateLimbsJob(void *userData, int jobIndex, int workerIndex)
+{
+    CharacterPool *pool = (CharacterPool *)userData;
+    int end = SDL_min((jobIndex + 1) * UPDATE_CHUNK_SIZE, pool->size);
+    for (int i = jobIndex * UPDATE_CHUNK_SIZE; i < end; i++)
+    {
+        Character *character = &pool->characters[i];
+        character->body[0].x = pool->newHeads[i].x;
+        character->body[0].y = pool->newHeads[i].y;
+        Character_UpdateLimbs(character);
+    }
+}
+
+// 更新角色池中的所有角色
+// 1.并行移动所有角色的身体 2.用本帧的碰撞盒重建一次网格 3.并行对同一份状态做碰撞 4.并行写回头部并更新四肢 5.按角色顺序结算对玩家的伤害
+// 每个角色的结果只取决于上一阶段结束时的状态,和角色的处理顺序、线程数量都无关
+void CharacterPool_Update(CharacterPool *pool, JobSystem *jobs)
+{
+    if (!pool || pool->size == 0) return;
+
+    int chunkCount = (pool->size + UPDATE_CHUNK_SIZE - 1) / UPDATE_CHUNK_SIZE;
+    PROFILE_BEGIN(PROFILE_ZONE_SPINE);
+    JobSystem_ParallelFor(jobs, chunkCount, CharacterPool_UpdateBodiesJob, pool);
+    PROFILE_END(PROFILE_ZONE_SPINE);
+
+    PROFILE_BEGIN(PROFILE_ZONE_COLLISION);
+    CharacterPool_RebuildGrid(pool);
+    JobSystem_ParallelFor(jobs, chunkCount, CharacterPool_CollideJob, pool);
+    PROFILE_END(PROFILE_ZONE_COLLISION);
+
+    PROFILE_BEGIN(PROFILE_ZONE_LEGS);
+    JobSystem_ParallelFor(jobs, chunkCount, CharacterPool_UpdateLimbsJob, pool);
+    PROFILE_END(PROFILE_ZONE_LEGS);
+
+    // 怪物撞到玩家时玩家掉血(0号角色是玩家)
+    Character *player = &pool->characters[0];
+    for (int i = 1; i < pool->size; i++)
+    {
+        if (pool->hitPlayer[i]) player->HP -= 0.1f;
     }
 }
 
@@ -723,46 +1053,122 @@ void CharacterPool_Check_Enemy_HP(CharacterPool *pool, int *score)
 
     for (int i = 1; i < pool->size; i++)
     {
-        Character *character = pool->characters[i];
-        if (character && character->HP <= 0)
+        Character *character = &pool->characters[i];
+        if (character->HP <= 0)
         {
             *score += character->maxHP;
             CharacterPool_Remove(pool, i);
+            i--; // 最后一个角色被搬到了i处,下一次循环要检查它
         }
     }
 }
 
-// 渲染角色池中的所有角色
-void CharacterPool_Render(CharacterPool *pool, SDL_Renderer *renderer, const Camera *camera, BatchRenderer *batch)
+// 渲染第index个角色:先用当前的渲染盒判断是否可见,可见时画插值后的副本(alpha为1时直接画当前状态)
+static void CharacterPool_RenderOne(CharacterPool *pool, int index, SDL_Renderer *renderer, const Camera *camera, BatchRenderer *batch, float alpha)
 {
-    if (!pool || !renderer || !camera || !batch) return;
-
-    for (int i = 0; i < pool->size; i++)
+    Character *character = &pool->characters[index];
+    if (alpha >= 1.0f)
     {
-        Character *character = pool->characters[i];
-        if (character)
-        {
-            Character_check_render(character, camera);
-            Character_render(character, renderer, camera, batch);
-        }
+        Character_render(character, renderer, camera, batch);
+        return;
     }
+    Character view;
+    node viewBody[MAX_BODY_COUNT];
+    CharacterPool_Interpolate(pool, index, alpha, &view, viewBody);
+    Character_render(&view, renderer, camera, batch);
 }
 
-// 清理角色池
-void CharacterPool_Clear(CharacterPool *pool)
+// 剔除视野外的角色,生成可见列表
+void CharacterPool_Cull(CharacterPool *pool, AABBBox view)
 {
     if (!pool) return;
 
+    int count = 0;
     for (int i = 0; i < pool->size; i++)
     {
-        if (pool->characters[i])
-        {
-            Character_Destroy(pool->characters[i]);
-            pool->characters[i] = NULL;
-        }
+        Character *character = &pool->characters[i];
+        character->needRender = AABBBoxCollision(character->renderBox, view);
+        if (character->needRender) pool->visible[count++] = i;
     }
+    pool->visibleCount = count;
+}
 
+// 上一次剔除的结果
+void CharacterPool_GetCullStats(const CharacterPool *pool, int *drawn, int *culled)
+{
+    if (drawn) *drawn = pool ? pool->visibleCount : 0;
+    if (culled) *culled = pool ? pool->size - pool->visibleCount : 0;
+}
+
+// 渲染可见列表里的角色
+void CharacterPool_Render(CharacterPool *pool, SDL_Renderer *renderer, const Camera *camera, BatchRenderer *batch, float alpha)
+{
+    if (!pool || !renderer || !camera || !batch) return;
+
+    for (int i = 0; i < pool->visibleCount; i++)
+    {
+        CharacterPool_RenderOne(pool, pool->visible[i], renderer, camera, batch, alpha);
+    }
+}
+
+// 并行渲染的参数
+typedef struct
+{
+    CharacterPool *pool;
+    SDL_Renderer *renderer;
+    const Camera *camera;
+    BatchRenderer **chunkBatches;
+    int chunkCount;
+    float alpha;
+} CharacterRenderJob;
+
+// 渲染一段角色到这一段自己的批次(只写自己的角色和批次,不需要加锁)
+static void CharacterPool_RenderChunk(void *userData, int jobIndex, int workerIndex)
+{
+    CharacterRenderJob *job = (CharacterRenderJob *)userData;
+    BatchRenderer *chunkBatch = job->chunkBatches[jobIndex];
+    int begin = (int)((long long)job->pool->visibleCount * jobIndex / job->chunkCount);
+    int end = (int)((long long)job->pool->visibleCount * (jobIndex + 1) / job->chunkCount);
+
+    Batch_Clear(chunkBatch);
+    Batch_SetCamera(chunkBatch, job->camera);
+    for (int i = begin; i < end; i++)
+    {
+        CharacterPool_RenderOne(job->pool, job->pool->visible[i], job->renderer, job->camera, chunkBatch, job->alpha);
+    }
+}
+
+// 并行渲染角色池
+void CharacterPool_RenderParallel(CharacterPool *pool, SDL_Renderer *renderer, const Camera *camera, BatchRenderer *batch, JobSystem *jobs, BatchRenderer **chunkBatches, int chunkCount, float alpha)
+{
+    if (!pool || !renderer || !camera || !batch) return;
+    if (!jobs || !chunkBatches || chunkCount <= 1 || pool->visibleCount < chunkCount)
+    {
+        CharacterPool_Render(pool, renderer, camera, batch, alpha);
+        return;
+    }
+
+    CharacterRenderJob job = {pool, renderer, camera, chunkBatches, chunkCount, alpha};
+    JobSystem_ParallelFor(jobs, chunkCount, CharacterPool_RenderChunk, &job);
+
+    // 按角色顺序拼接,绘制顺序和串行渲染一致
+    Batch_UseCamera(batch, camera);
+    for (int i = 0; i < chunkCount; i++)
+    {
+        Batch_Append(batch, chunkBatches[i]);
+    }
+}
+
+// 清理角色池
+void CharacterPool_Clear(CharacterPool *pool)
+{
+    if (!pool) return;
+
+    // 角色都在角色池自己的内存里,清空只需要重置计数
     pool->size = 0;
+    pool->visibleCount = 0;
+    pool->droppedCount = 0;
+    pool->gridValid = false;
 }
 
 // 销毁角色池中的所有角色并释放内存
@@ -770,22 +1176,32 @@ void CharacterPool_Destroy(CharacterPool *pool)
 {
     if (!pool) return;
 
-    // 销毁所有角色
-    for (int i = 0; i < pool->size; i++)
-    {
-        if (pool->characters[i])
-        {
-            Character_Destroy(pool->characters[i]);
-            pool->characters[i] = NULL;
-        }
-    }
-
-    // 释放指针数组内存
+    // 释放角色和身体节点的内存
     if (pool->characters)
     {
         free(pool->characters);
         pool->characters = NULL;
     }
+    if (pool->nodes)
+    {
+        free(pool->nodes);
+        pool->nodes = NULL;
+    }
+    if (pool->gridBoxes)
+    {
+        free(pool->gridBoxes);
+        pool->gridBoxes = NULL;
+    }
+    free(pool->newHeads);
+    pool->newHeads = NULL;
+    free(pool->hitPlayer);
+    pool->hitPlayer = NULL;
+    free(pool->previous);
+    pool->previous = NULL;
+    free(pool->visible);
+    pool->visible = NULL;
+    pool->visibleCount = 0;
+    SpatialGrid_Destroy(&pool->grid);
 
     pool->size = 0;
     pool->capacity = 0;
@@ -850,51 +1266,131 @@ bool Chain3_Update(Chain3 *chain, SDL_FPoint rootPosition, SDL_FPoint finalPosit
     return false;
 }
 
-// 子弹部分
-void BulletPool_Init(BulletPool *pool) { pool->bulletCount = 0; }
-void BulletPool_Add(BulletPool *pool, Bullet bullet)
+// 两节骨骼的解析解
+bool Chain3_SolveAnalytic(Chain3 *chain, SDL_FPoint rootPosition, SDL_FPoint finalPosition, Vector aimDirection)
 {
-    if (pool->bulletCount == MAX_BULLET_COUNT)
+    if (!chain) return false;
+
+    const float a = chain->distanceMR;
+    const float b = chain->distanceMH;
+    float dx = finalPosition.x - rootPosition.x;
+    float dy = finalPosition.y - rootPosition.y;
+    float d = sqrtf(dx * dx + dy * dy);
+
+    // root到目标的单位方向;目标和root重合时沿用上一次head的方向
+    Vector dir;
+    if (d > 0.0001f)
     {
-        pool->bullets[0] = bullet;
-        return;
+        dir = (Vector){dx / d, dy / d};
     }
-    pool->bullets[pool->bulletCount] = bullet;
-    pool->bulletCount++;
-}
-void BulletPool_Remove(BulletPool *pool, int index)
-{
-    if (index >= pool->bulletCount)
+    else
     {
-        pool->bulletCount--;
-        return;
+        dir = vector_get(rootPosition.x, rootPosition.y, chain->head.x, chain->head.y);
+        if (vector_norm(dir) < 0.0001f) dir = aimDirection;
+        vector_Normalization(&dir);
     }
-    pool->bullets[index] = pool->bullets[pool->bulletCount - 1];
-    pool->bulletCount--;
+
+    // 够不着时伸直,太近时折叠(和FABRIK收敛的位置一样)
+    d = SDL_clamp(d, fabsf(a - b), a + b);
+    if (d < 0.0001f) d = 0.0001f;
+
+    // 余弦定理:膝盖在root-head连线上的投影距离x和到连线的距离h
+    float x = (a * a - b * b + d * d) / (2.0f * d);
+    float h = sqrtf(SDL_max(a * a - x * x, 0.0f));
+    Vector normal = counterclockwise_90(dir);
+
+    // 膝盖先放在上一次所在的一侧
+    Vector oldMiddle = vector_get(rootPosition.x, rootPosition.y, chain->middle.x, chain->middle.y);
+    float side = vector_dot(oldMiddle, normal) < 0 ? -1.0f : 1.0f;
+
+    // 和Chain3_Update一样检查膝盖朝向:middle->root与middle->head之和(=dir*(d-2x)-normal*2h*side)应该和aimDirection同向
+    // 不符时换到另一侧;两侧都不符时Chain3_Update第二次调用又会翻回来,所以留在原来一侧
+    float along = (d - 2.0f * x) * vector_dot(dir, aimDirection);
+    float across = 2.0f * h * vector_dot(normal, aimDirection);
+    bool flipped = along - across * side < 0 && along + across * side >= 0;
+    if (flipped) side = -side;
+
+    chain->root = rootPosition;
+    chain->middle = (SDL_FPoint){rootPosition.x + dir.x * x + normal.x * h * side, rootPosition.y + dir.y * x + normal.y * h * side};
+    chain->head = (SDL_FPoint){rootPosition.x + dir.x * d, rootPosition.y + dir.y * d};
+    return flipped;
 }
 
-// 清理子弹池
-void BulletPool_Clear(BulletPool *pool)
+// 子弹部分
+void BulletPool_Init(BulletPool *pool)
 {
-    Bullet nullBullet = {};
-    for (int i = 0; i < pool->bulletCount; i++)
+    pool->bulletCount = 0;
+    pool->liveCount = 0;
+    pool->evictCursor = 0;
+    pool->visibleCount = 0;
+    pool->culledCount = 0;
+}
+// 把子弹模板拆开写进各个数组
+static void BulletPool_Write(BulletPool *pool, int index, const Bullet *bullet)
+{
+    pool->x[index] = bullet->x;
+    pool->y[index] = bullet->y;
+    pool->vx[index] = bullet->speed * bullet->direction.x;
+    pool->vy[index] = bullet->speed * bullet->direction.y;
+    pool->flyCount[index] = bullet->flyCount;
+    pool->damage[index] = bullet->damage;
+    pool->radius[index] = bullet->radius;
+    pool->color[index] = bullet->bulletColor;
+}
+void BulletPool_Kill(BulletPool *pool, int index)
+{
+    if (index < 0 || index >= pool->bulletCount || pool->flyCount[index] > Max_FLY_COUNT) return;
+    pool->flyCount[index] = BULLET_DEAD_FLY_COUNT;
+    pool->liveCount--;
+}
+static void BulletPool_Compact(BulletPool *pool);
+void BulletPool_Add(BulletPool *pool, Bullet bullet)
+{
+    // 存活子弹满了:挤掉最老的一颗(游标只会往后走,直到下一次压缩才归零,所以均摊是常数时间)
+    if (pool->liveCount >= MAX_BULLET_COUNT)
     {
-        pool->bullets[i] = nullBullet;
+        while (pool->evictCursor < pool->bulletCount && pool->flyCount[pool->evictCursor] > Max_FLY_COUNT)
+        {
+            pool->evictCursor++;
+        }
+        BulletPool_Kill(pool, pool->evictCursor);
     }
-    pool->bulletCount = 0;
+    // 一帧内挤掉的子弹超过了预留空间,提前压缩一次
+    if (pool->bulletCount == BULLET_POOL_CAPACITY)
+    {
+        BulletPool_Compact(pool);
+    }
+    BulletPool_Write(pool, pool->bulletCount, &bullet);
+    pool->bulletCount++;
+    if (bullet.flyCount <= Max_FLY_COUNT) pool->liveCount++;
 }
 
+// 清理子弹池
+void BulletPool_Clear(BulletPool *pool) { BulletPool_Init(pool); }
+
 void BulletPool_Destroy(BulletPool *pool) { BulletPool_Clear(pool); }
-bool Bullet_Character_Collision(Bullet *bullet, Character *character)
+
+// 子弹这一帧扫过的胶囊体(从上一帧位置到当前位置,半径为子弹半径)和角色身体是否相交
+bool Bullet_Character_Collision(float x, float y, float lastX, float lastY, float radius, const Character *character)
 {
-    AABBBox bulletBox = {bullet->x - bullet->radius, bullet->x + bullet->radius, bullet->y - bullet->radius, bullet->y + bullet->radius};
+    AABBBox bulletBox = {fminf(lastX, x) - radius, fmaxf(lastX, x) + radius, fminf(lastY, y) - radius, fmaxf(lastY, y) + radius};
 
     if (!AABBBoxCollision(bulletBox, character->box)) return false;
+    float moveX = x - lastX;
+    float moveY = y - lastY;
+    float moveSquared = moveX * moveX + moveY * moveY;
     for (int i = 0; i < character->bodyCount; i++)
     {
-        float dx = character->body[i].x - bullet->x;
-        float dy = character->body[i].y - bullet->y;
-        float CollisionDis = character->body[i].radius + bullet->radius;
+        // 节点到子弹运动线段的最近点
+        float t = 0.0f;
+        if (moveSquared > 0.0f)
+        {
+            t = ((character->body[i].x - lastX) * moveX + (character->body[i].y - lastY) * moveY) / moveSquared;
+            t = SDL_clamp(t, 0.0f, 1.0f);
+        }
+        float dx = character->body[i].x - (lastX + moveX * t);
+        float dy = character->body[i].y - (lastY + moveY * t);
+        float CollisionDis = character->body[i].radius + radius;
         if (dx * dx + dy * dy <= CollisionDis * CollisionDis)
         {
             return true;
@@ -902,53 +1398,206 @@ bool Bullet_Character_Collision(Bullet *bullet, Character *character)
     }
     return false;
 }
-void damage(Character *character, Bullet *bullet, float k) { character->HP -= bullet->damage * k; }
-bool Bullet_Update(Bullet *bullet, CharacterPool *characterPool) // 返回值表示是否要删掉该子弹
+void damage(Character *character, float bulletDamage, float k) { character->HP -= bulletDamage * k; }
+
+// 移动和寿命内核:所有子弹前进一帧,飞行帧数加一(SSE/AVX2一次处理4/8颗子弹,剩下的用标量处理)
+static void BulletPool_Integrate(BulletPool *pool)
 {
-    bool remove = false;
-    bullet->x += bullet->speed * bullet->direction.x;
-    bullet->y += bullet->speed * bullet->direction.y;
-    AABBBox box = {bullet->x - bullet->radius, bullet->x + bullet->radius, bullet->y - bullet->radius, bullet->y + bullet->radius};
-    // 先处理子弹打向自己
-    Character *self = characterPool->characters[0];
-    if (bullet->flyCount > 10 && AABBBoxCollision(box, self->box))
+    int count = pool->bulletCount;
+    int i = 0;
+#if defined(__AVX2__)
+    const __m256i one8 = _mm256_set1_epi32(1);
+    for (; i + 8 <= count; i += 8)
     {
-        if (Bullet_Character_Collision(bullet, self))
+        _mm256_storeu_ps(&pool->x[i], _mm256_add_ps(_mm256_loadu_ps(&pool->x[i]), _mm256_loadu_ps(&pool->vx[i])));
+        _mm256_storeu_ps(&pool->y[i], _mm256_add_ps(_mm256_loadu_ps(&pool->y[i]), _mm256_loadu_ps(&pool->vy[i])));
+        __m256i fly = _mm256_loadu_si256((const __m256i *)&pool->flyCount[i]);
+        _mm256_storeu_si256((__m256i *)&pool->flyCount[i], _mm256_add_epi32(fly, one8));
+    }
+#endif
+#if defined(__SSE2__)
+    const __m128i one4 = _mm_set1_epi32(1);
+    for (; i + 4 <= count; i += 4)
+    {
+        _mm_storeu_ps(&pool->x[i], _mm_add_ps(_mm_loadu_ps(&pool->x[i]), _mm_loadu_ps(&pool->vx[i])));
+        _mm_storeu_ps(&pool->y[i], _mm_add_ps(_mm_loadu_ps(&pool->y[i]), _mm_loadu_ps(&pool->vy[i])));
+        __m128i fly = _mm_loadu_si128((const __m128i *)&pool->flyCount[i]);
+        _mm_storeu_si128((__m128i *)&pool->flyCount[i], _mm_add_epi32(fly, one4));
+    }
+#endif
+    for (; i < count; i++)
+    {
+        pool->x[i] += pool->vx[i];
+        pool->y[i] += pool->vy[i];
+        pool->flyCount[i]++;
+    }
+}
+
+// 处理第index颗子弹的碰撞,返回值表示是否命中(命中后要删掉该子弹)
+static bool BulletPool_Collide(BulletPool *pool, int index, CharacterPool *characterPool)
+{
+    float x = pool->x[index];
+    float y = pool->y[index];
+    float lastX = x - pool->vx[index];
+    float lastY = y - pool->vy[index];
+    float radius = pool->radius[index];
+    // 扫掠包围盒,用于在网格中查询附近的角色
+    AABBBox box = {fminf(lastX, x) - radius, fmaxf(lastX, x) + radius, fminf(lastY, y) - radius, fmaxf(lastY, y) + radius};
+    // 先处理子弹打向自己(flyCount已经包含了这一帧)
+    Character *self = CharacterPool_Get(characterPool, 0);
+    if (self && pool->flyCount[index] > BULLET_SELF_HIT_DELAY + 1 && AABBBoxCollision(box, self->box))
+    {
+        if (Bullet_Character_Collision(x, y, lastX, lastY, radius, self))
         {
-            damage(self, bullet, 0.25f);
+            damage(self, pool->damage[index], 0.25f);
             return true;
         }
     }
-    for (int i = 1; i < characterPool->size; i++)
+    // 再处理打向怪物:只检测网格中附近的候选者,命中多个时取编号最小的,和按顺序遍历整个角色池的结果一致
+    int hitIndex = -1;
+    SpatialGridQuery query;
+    SpatialGrid_QueryBegin(&characterPool->grid, box, &query);
+    int i;
+    while ((i = SpatialGrid_QueryNext(&characterPool->grid, &query)) >= 0)
     {
-        Character *character = characterPool->characters[i];
-        if (AABBBoxCollision(box, character->box))
+        if (i == 0 || (hitIndex >= 0 && i > hitIndex)) continue;
+        Character *character = CharacterPool_Get(characterPool, i);
+        if (character && AABBBoxCollision(box, character->box) && Bullet_Character_Collision(x, y, lastX, lastY, radius, character))
         {
-            if (Bullet_Character_Collision(bullet, character))
-            {
-                damage(character, bullet, 1.0f);
-                return true;
-            }
+            hitIndex = i;
         }
     }
-    bullet->flyCount++;
-    return bullet->flyCount > Max_FLY_COUNT;
+    if (hitIndex > 0)
+    {
+        damage(CharacterPool_Get(characterPool, hitIndex), pool->damage[index], 1.0f);
+        return true;
+    }
+    return false;
 }
+
+// 批量压缩:一次遍历删掉所有超过寿命的子弹(命中和被挤掉的子弹已被标记为超过寿命),保持剩余子弹的顺序
+static void BulletPool_Compact(BulletPool *pool)
+{
+    int write = 0;
+    for (int read = 0; read < pool->bulletCount; read++)
+    {
+        if (pool->flyCount[read] > Max_FLY_COUNT) continue;
+        if (write != read)
+        {
+            pool->x[write] = pool->x[read];
+            pool->y[write] = pool->y[read];
+            pool->vx[write] = pool->vx[read];
+            pool->vy[write] = pool->vy[read];
+            pool->flyCount[write] = pool->flyCount[read];
+            pool->damage[write] = pool->damage[read];
+            pool->radius[write] = pool->radius[read];
+            pool->color[write] = pool->color[read];
+        }
+        write++;
+    }
+    pool->bulletCount = write;
+    pool->liveCount = write;
+    pool->evictCursor = 0;
+}
+
 void BulletPool_Update(BulletPool *pool, CharacterPool *characterPool)
 {
+    // 角色池在上次建网格之后增删过角色,网格的编号已经对不上,需要重建
+    if (!characterPool->gridValid)
+    {
+        CharacterPool_RebuildGrid(characterPool);
+    }
+    // 先整体移动,再逐个处理碰撞(命中的标记为死亡),最后统一删除
+    // 每颗子弹每帧都恰好更新一次,每帧的代价只和数组长度有关
+    BulletPool_Integrate(pool);
     for (int i = 0; i < pool->bulletCount; i++)
     {
-        if (Bullet_Update(&pool->bullets[i], characterPool))
+        // 被标记死亡的子弹不参与碰撞(这一帧刚到期的子弹还要最后检测一次,和原来的顺序一致)
+        if (pool->flyCount[i] >= BULLET_DEAD_FLY_COUNT) continue;
+        if (BulletPool_Collide(pool, i, characterPool))
         {
-            BulletPool_Remove(pool, i);
+            pool->flyCount[i] = BULLET_DEAD_FLY_COUNT;
         }
     }
+    BulletPool_Compact(pool);
+}
+
+// 子弹插值后的位置:已经飞过至少一帧的子弹上一个逻辑帧在(x-vx,y-vy),还没飞过的停在发射位置
+static SDL_FPoint BulletPool_RenderPosition(const BulletPool *pool, int index, float back)
+{
+    SDL_FPoint p = {pool->x[index], pool->y[index]};
+    if (pool->flyCount[index] > 0)
+    {
+        p.x -= pool->vx[index] * back;
+        p.y -= pool->vy[index] * back;
+    }
+    return p;
 }
-void BulletPool_Render(BulletPool *pool, SDL_Renderer *renderer, const Camera *camera, BatchRenderer *batch)
+
+// 筛出插值位置在视野内的存活子弹
+void BulletPool_Cull(BulletPool *pool, AABBBox view, float alpha)
 {
+    if (!pool) return;
+
+    float back = 1.0f - SDL_clamp(alpha, 0.0f, 1.0f);
+    int count = 0;
+    int culled = 0;
     for (int i = 0; i < pool->bulletCount; i++)
     {
-        Polygon_DrawCircle(batch, pool->bullets[i].x, pool->bullets[i].y, pool->bullets[i].radius, 10, pool->bullets[i].bulletColor, camera);
+        if (pool->flyCount[i] > Max_FLY_COUNT) continue;
+        SDL_FPoint p = BulletPool_RenderPosition(pool, i, back);
+        float r = pool->radius[i];
+        if (p.x + r < view.minX || p.x - r > view.maxX || p.y + r < view.minY || p.y - r > view.maxY)
+        {
+            culled++;
+            continue;
+        }
+        pool->visible[count++] = i;
+    }
+    pool->visibleCount = count;
+    pool->culledCount = culled;
+}
+
+// 上一次剔除的结果
+void BulletPool_GetCullStats(const BulletPool *pool, int *drawn, int *culled)
+{
+    if (drawn) *drawn = pool ? pool->visibleCount : 0;
+    if (culled) *culled = pool ? pool->culledCount : 0;
+}
+
+void BulletPool_Render(BulletPool *pool, SDL_Renderer *renderer, const Camera *camera, BatchRenderer *batch, float alpha)
+{
+    if (!pool || !batch) return;
+
+    // 先算出要画的子弹一共需要多少顶点,整个子弹池只预留一次;每颗子弹的段数由屏幕上的半径决定
+    float zoom = camera ? camera->zoom : 1.0f;
+    int vertexCount = 0;
+    int indexCount = 0;
+    for (int k = 0; k < pool->visibleCount; k++)
+    {
+        int segments = Polygon_CircleSegments(pool->radius[pool->visible[k]] * zoom);
+        vertexCount += segments + 1;
+        indexCount += segments * 3;
+    }
+    if (vertexCount == 0) return;
+
+    Batch_UseCamera(batch, camera);
+    BatchSpan span;
+    if (!Batch_Reserve(batch, vertexCount, indexCount, &span)) return;
+
+    float back = 1.0f - SDL_clamp(alpha, 0.0f, 1.0f);
+    SDL_Vertex *v = span.vertices;
+    int *idx = span.indices;
+    int base = span.baseVertex;
+    for (int k = 0; k < pool->visibleCount; k++)
+    {
+        int i = pool->visible[k];
+        int segments = Polygon_CircleSegments(pool->radius[i] * zoom);
+        SDL_FPoint p = BulletPool_RenderPosition(pool, i, back);
+        Polygon_WriteCircle(v, idx, base, p.x, p.y, pool->radius[i], segments, pool->color[i]);
+        v += segments + 1;
+        idx += segments * 3;
+        base += segments + 1;
     }
 }
 
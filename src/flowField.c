@@ -0,0 +1,285 @@
+#include "flowField.h"
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
+
+// 八个相邻格子(前四个是上下左右)
+static const int neighborX[8] = {1, -1, 0, 0, 1, 1, -1, -1};
+static const int neighborY[8] = {0, 0, 1, -1, 1, -1, 1, -1};
+
+// 创建流场
+FlowField *FlowField_Create(AABBBox bounds, float cellSize)
+{
+    if (bounds.maxX <= bounds.minX || bounds.maxY <= bounds.minY) return NULL;
+    if (cellSize <= 0) cellSize = DEFALUT_FLOW_FIELD_CELL_SIZE;
+
+    FlowField *field = (FlowField *)calloc(1, sizeof(FlowField));
+    if (!field) return NULL;
+
+    field->minX = bounds.minX;
+    field->minY = bounds.minY;
+    field->cellSize = cellSize;
+    field->invCellSize = 1.0f / cellSize;
+    field->width = (int)ceilf((bounds.maxX - bounds.minX) * field->invCellSize);
+    field->height = (int)ceilf((bounds.maxY - bounds.minY) * field->invCellSize);
+    field->cellCount = field->width * field->height;
+    field->heapCapacity = field->cellCount * 8 + 1; // 每个格子最多被相邻格子放进队列8次
+
+    field->blocked = (bool *)calloc(field->cellCount, sizeof(bool));
+    field->blockedSum = (int *)malloc(sizeof(int) * (field->width + 1) * (field->height + 1));
+    field->cost = (int *)malloc(sizeof(int) * field->cellCount);
+    field->direction = (Vector *)malloc(sizeof(Vector) * field->cellCount);
+    field->direct = (bool *)malloc(sizeof(bool) * field->cellCount);
+    field->heap = (Uint64 *)malloc(sizeof(Uint64) * field->heapCapacity);
+    if (!field->blocked || !field->blockedSum || !field->cost || !field->direction || !field->direct || !field->heap)
+    {
+        FlowField_Destroy(field);
+        return NULL;
+    }
+    field->targetCell = -1;
+    return field;
+}
+
+// 销毁流场
+void FlowField_Destroy(FlowField *field)
+{
+    if (!field) return;
+    free(field->blocked);
+    free(field->blockedSum);
+    free(field->cost);
+    free(field->direction);
+    free(field->direct);
+    free(field->heap);
+    free(field);
+}
+
+// 世界坐标所在的格子坐标(可能在网格外)
+static void FlowField_CellOf(const FlowField *field, float x, float y, int *cellX, int *cellY)
+{
+    *cellX = (int)floorf((x - field->minX) * field->invCellSize);
+    *cellY = (int)floorf((y - field->minY) * field->invCellSize);
+}
+
+// 标记障碍
+void FlowField_AddObstacle(FlowField *field, AABBBox box)
+{
+    if (!field) return;
+    int x0, y0, x1, y1;
+    FlowField_CellOf(field, box.minX, box.minY, &x0, &y0);
+    FlowField_CellOf(field, box.maxX, box.maxY, &x1, &y1);
+    x0 = SDL_max(x0, 0);
+    y0 = SDL_max(y0, 0);
+    x1 = SDL_min(x1, field->width - 1);
+    y1 = SDL_min(y1, field->height - 1);
+    for (int y = y0; y <= y1; y++)
+    {
+        for (int x = x0; x <= x1; x++)
+        {
+            field->blocked[y * field->width + x] = true;
+        }
+    }
+    field->sumValid = false;
+    field->targetCell = -1;
+}
+
+// 强制重新计算
+void FlowField_Invalidate(FlowField *field)
+{
+    if (field) field->targetCell = -1;
+}
+
+// 重建障碍的前缀和:blockedSum[(y+1)*(width+1)+(x+1)]是(0,0)到(x,y)的矩形里的障碍数量
+static void FlowField_BuildBlockedSum(FlowField *field)
+{
+    const int stride = field->width + 1;
+    for (int x = 0; x <= field->width; x++) field->blockedSum[x] = 0;
+    for (int y = 0; y < field->height; y++)
+    {
+        int rowSum = 0;
+        field->blockedSum[(y + 1) * stride] = 0;
+        for (int x = 0; x < field->width; x++)
+        {
+            rowSum += field->blocked[y * field->width + x];
+            field->blockedSum[(y + 1) * stride + x + 1] = field->blockedSum[y * stride + x + 1] + rowSum;
+        }
+    }
+    field->sumValid = true;
+}
+
+// 目标格子和(x,y)张成的矩形里有没有障碍
+static bool FlowField_RectBlocked(const FlowField *field, int x, int y)
+{
+    const int stride = field->width + 1;
+    int targetX = field->targetCell % field->width, targetY = field->targetCell / field->width;
+    int x0 = SDL_min(x, targetX), x1 = SDL_max(x, targetX) + 1;
+    int y0 = SDL_min(y, targetY), y1 = SDL_max(y, targetY) + 1;
+    int count = field->blockedSum[y1 * stride + x1] - field->blockedSum[y0 * stride + x1] - field->blockedSum[y1 * stride + x0] + field->blockedSum[y0 * stride + x0];
+    return count > 0;
+}
+
+// 从(x,y)能不能走到第i个相邻格子:不能出界,不能进障碍,斜着走时不能穿过障碍的角
+static bool FlowField_CanStep(const FlowField *field, int x, int y, int i)
+{
+    int nx = x + neighborX[i], ny = y + neighborY[i];
+    if (nx < 0 || ny < 0 || nx >= field->width || ny >= field->height) return false;
+    if (field->blocked[ny * field->width + nx]) return false;
+    if (i >= 4 && (field->blocked[y * field->width + nx] || field->blocked[ny * field->width + x])) return false;
+    return true;
+}
+
+// 目标所在的格子是障碍时(玩家贴着墙,头部伸进了墙所在的格子),换成离目标最近的空格子
+static void FlowField_NearestFreeCell(const FlowField *field, SDL_FPoint target, int *cellX, int *cellY)
+{
+    if (!field->blocked[*cellY * field->width + *cellX]) return;
+    int maxRadius = SDL_max(field->width, field->height);
+    for (int radius = 1; radius < maxRadius; radius++)
+    {
+        // 一圈一圈往外找,找到空格子的那一圈里取格子中心离目标最近的
+        float bestDistance = -1.0f;
+        int bestX = 0, bestY = 0;
+        for (int y = *cellY - radius; y <= *cellY + radius; y++)
+        {
+            for (int x = *cellX - radius; x <= *cellX + radius; x++)
+            {
+                if (x < 0 || y < 0 || x >= field->width || y >= field->height) continue;
+                if (abs(x - *cellX) != radius && abs(y - *cellY) != radius) continue;
+                if (field->blocked[y * field->width + x]) continue;
+                float dx = field->minX + (x + 0.5f) * field->cellSize - target.x;
+                float dy = field->minY + (y + 0.5f) * field->cellSize - target.y;
+                float distance = dx * dx + dy * dy;
+                if (bestDistance < 0 || distance < bestDistance)
+                {
+                    bestDistance = distance;
+                    bestX = x;
+                    bestY = y;
+                }
+            }
+        }
+        if (bestDistance >= 0)
+        {
+            *cellX = bestX;
+            *cellY = bestY;
+            return;
+        }
+    }
+}
+
+// 小顶堆
+static void FlowField_HeapPush(FlowField *field, int *count, Uint64 value)
+{
+    Uint64 *heap = field->heap;
+    int i = (*count)++;
+    while (i > 0)
+    {
+        int parent = (i - 1) / 2;
+        if (heap[parent] <= value) break;
+        heap[i] = heap[parent];
+        i = parent;
+    }
+    heap[i] = value;
+}
+static Uint64 FlowField_HeapPop(FlowField *field, int *count)
+{
+    Uint64 *heap = field->heap;
+    Uint64 top = heap[0];
+    Uint64 last = heap[--(*count)];
+    int i = 0;
+    for (;;)
+    {
+        int child = i * 2 + 1;
+        if (child >= *count) break;
+        if (child + 1 < *count && heap[child + 1] < heap[child]) child++;
+        if (heap[child] >= last) break;
+        heap[i] = heap[child];
+        i = child;
+    }
+    heap[i] = last;
+    return top;
+}
+
+// 用目标位置更新流场
+bool FlowField_Update(FlowField *field, SDL_FPoint target)
+{
+    if (!field) return false;
+
+    int targetX, targetY;
+    FlowField_CellOf(field, target.x, target.y, &targetX, &targetY);
+    targetX = SDL_clamp(targetX, 0, field->width - 1);
+    targetY = SDL_clamp(targetY, 0, field->height - 1);
+    FlowField_NearestFreeCell(field, target, &targetX, &targetY);
+    int targetCell = targetY * field->width + targetX;
+    if (targetCell == field->targetCell) return false;
+    if (!field->sumValid) FlowField_BuildBlockedSum(field);
+    field->targetCell = targetCell;
+
+    // Dijkstra:从目标格子向外扩展
+    for (int i = 0; i < field->cellCount; i++) field->cost[i] = INT_MAX;
+    field->cost[targetCell] = 0;
+    int heapCount = 0;
+    FlowField_HeapPush(field, &heapCount, (Uint64)targetCell);
+    while (heapCount > 0)
+    {
+        Uint64 top = FlowField_HeapPop(field, &heapCount);
+        int cell = (int)(top & 0xFFFFFFFFu);
+        int cost = (int)(top >> 32);
+        if (cost > field->cost[cell]) continue; // 已经用更小的代价处理过了
+        int x = cell % field->width, y = cell / field->width;
+        for (int i = 0; i < 8; i++)
+        {
+            if (!FlowField_CanStep(field, x, y, i)) continue;
+            int next = (y + neighborY[i]) * field->width + x + neighborX[i];
+            int nextCost = cost + (i < 4 ? FLOW_FIELD_STRAIGHT_COST : FLOW_FIELD_DIAGONAL_COST);
+            if (nextCost >= field->cost[next]) continue;
+            field->cost[next] = nextCost;
+            FlowField_HeapPush(field, &heapCount, ((Uint64)nextCost << 32) | (Uint64)next);
+        }
+    }
+
+    // 每个格子朝代价最小的相邻格子走;和目标之间没有障碍的格子直接朝目标走
+    for (int y = 0; y < field->height; y++)
+    {
+        for (int x = 0; x < field->width; x++)
+        {
+            int cell = y * field->width + x;
+            field->direct[cell] = field->cost[cell] != INT_MAX && !FlowField_RectBlocked(field, x, y);
+            field->direction[cell] = (Vector){0, 0};
+            if (field->cost[cell] == INT_MAX || field->direct[cell]) continue;
+
+            int best = field->cost[cell];
+            for (int i = 0; i < 8; i++)
+            {
+                if (!FlowField_CanStep(field, x, y, i)) continue;
+                int next = (y + neighborY[i]) * field->width + x + neighborX[i];
+                if (field->cost[next] < best)
+                {
+                    best = field->cost[next];
+                    field->direction[cell] = (Vector){(float)neighborX[i], (float)neighborY[i]};
+                }
+            }
+            vector_Normalization(&field->direction[cell]);
+        }
+    }
+
+    field->updateCount++;
+    return true;
+}
+
+// 查询方向
+bool FlowField_Sample(const FlowField *field, SDL_FPoint position, SDL_FPoint target, Vector *direction)
+{
+    if (!field || !direction || field->targetCell < 0) return false;
+
+    int x, y;
+    FlowField_CellOf(field, position.x, position.y, &x, &y);
+    if (x < 0 || y < 0 || x >= field->width || y >= field->height) return false;
+    int cell = y * field->width + x;
+    if (field->cost[cell] == INT_MAX || field->cost[cell] == 0) return false;
+
+    if (field->direct[cell])
+    {
+        *direction = vector_get(position.x, position.y, target.x, target.y);
+        return true;
+    }
+    *direction = field->direction[cell];
+    return true;
+}
@@ -0,0 +1,65 @@
+#include "frameArena.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 初始化帧内存
+bool FrameArena_Init(FrameArena *arena, size_t capacity)
+{
+    if (!arena) return false;
+    memset(arena, 0, sizeof(FrameArena));
+    if (capacity == 0) capacity = DEFALUT_FRAME_ARENA_SIZE;
+
+    arena->base = (unsigned char *)malloc(capacity);
+    if (!arena->base)
+    {
+        fprintf(stderr, "Failed to allocate frame arena\n");
+        return false;
+    }
+    arena->capacity = capacity;
+    return true;
+}
+
+// 释放帧内存
+void FrameArena_Destroy(FrameArena *arena)
+{
+    if (!arena) return;
+    free(arena->base);
+    memset(arena, 0, sizeof(FrameArena));
+}
+
+// 重置帧内存
+void FrameArena_Reset(FrameArena *arena)
+{
+    if (!arena) return;
+    arena->used = 0;
+}
+
+// 分配内存(按FRAME_ARENA_ALIGN对齐)
+void *FrameArena_Alloc(FrameArena *arena, size_t size)
+{
+    if (!arena || !arena->base) return NULL;
+
+    uintptr_t address = (uintptr_t)(arena->base + arena->used);
+    size_t padding = (FRAME_ARENA_ALIGN - (address & (FRAME_ARENA_ALIGN - 1))) & (FRAME_ARENA_ALIGN - 1);
+    if (size > arena->capacity - arena->used || padding > arena->capacity - arena->used - size)
+    {
+        return NULL;
+    }
+
+    void *memory = arena->base + arena->used + padding;
+    arena->used += padding + size;
+    if (arena->used > arena->peak) arena->peak = arena->used;
+    return memory;
+}
+
+// 记录当前位置
+size_t FrameArena_Mark(const FrameArena *arena) { return arena ? arena->used : 0; }
+
+// 归还到记录的位置
+void FrameArena_Release(FrameArena *arena, size_t mark)
+{
+    if (!arena || mark > arena->used) return;
+    arena->used = mark;
+}
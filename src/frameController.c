@@ -31,6 +31,13 @@ int FrameController_Update(FrameController *fc)
     return updateNeeded;
 }
 
+// 获取渲染插值系数:渲染时在上一个逻辑帧和当前逻辑帧的状态之间按这个比例混合
+float FrameController_GetAlpha(const FrameController *fc)
+{
+    if (!fc || fc->logicAimDt <= 0) return 1.0f;
+    return (float)SDL_clamp(fc->accumulator / fc->logicAimDt, 0.0, 1.0);
+}
+
 // 增加渲染计数(每次更新完调用)
 void FrameController_AddRenderCount(FrameController *fc) { fc->renderCount++; }
 
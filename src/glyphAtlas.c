@@ -0,0 +1,129 @@
+#include "glyphAtlas.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// 图集里第ch个字形,不在图集里返回NULL
+static const Glyph *GlyphAtlas_GetGlyph(const GlyphAtlas *atlas, unsigned char ch)
+{
+    if (ch < GLYPH_ATLAS_FIRST_CHAR || ch > GLYPH_ATLAS_LAST_CHAR) return NULL;
+    return &atlas->glyphs[ch - GLYPH_ATLAS_FIRST_CHAR];
+}
+
+// 用字体创建图集
+GlyphAtlas *GlyphAtlas_Create(SDL_Renderer *renderer, TTF_Font *font)
+{
+    if (!renderer || !font) return NULL;
+
+    GlyphAtlas *atlas = (GlyphAtlas *)calloc(1, sizeof(GlyphAtlas));
+    if (!atlas) return NULL;
+
+    // 先渲染所有字形(白色,颜色在顶点里乘上去),按行排好位置
+    const SDL_Color white = {255, 255, 255, 255};
+    SDL_Surface *surfaces[GLYPH_ATLAS_CHAR_COUNT] = {0};
+    SDL_Rect placement[GLYPH_ATLAS_CHAR_COUNT] = {0};
+    int lineHeight = TTF_GetFontHeight(font);
+    int x = GLYPH_ATLAS_PADDING, y = GLYPH_ATLAS_PADDING, rowHeight = lineHeight;
+    for (int i = 0; i < GLYPH_ATLAS_CHAR_COUNT; i++)
+    {
+        char ch = (char)(GLYPH_ATLAS_FIRST_CHAR + i);
+        Glyph *glyph = &atlas->glyphs[i];
+        SDL_Surface *surface = TTF_RenderText_Blended(font, &ch, 1, white);
+        int advance = 0;
+        if (!TTF_GetGlyphMetrics(font, (Uint32)ch, NULL, NULL, NULL, NULL, &advance)) advance = surface ? surface->w : 0;
+        glyph->advance = (float)advance;
+        if (!surface) continue; // 字体里没有这个字(或者是空白),只前进不画
+
+        if (x + surface->w + GLYPH_ATLAS_PADDING > DEFALUT_GLYPH_ATLAS_WIDTH)
+        {
+            x = GLYPH_ATLAS_PADDING;
+            y += rowHeight + GLYPH_ATLAS_PADDING;
+            rowHeight = lineHeight;
+        }
+        placement[i] = (SDL_Rect){x, y, surface->w, surface->h};
+        rowHeight = SDL_max(rowHeight, surface->h);
+        x += surface->w + GLYPH_ATLAS_PADDING;
+        surfaces[i] = surface;
+    }
+    int atlasHeight = y + rowHeight + GLYPH_ATLAS_PADDING;
+
+    // 拼到一张透明的表面上,直接复制像素(不和透明背景混合)
+    SDL_Surface *atlasSurface = SDL_CreateSurface(DEFALUT_GLYPH_ATLAS_WIDTH, atlasHeight, SDL_PIXELFORMAT_RGBA32);
+    if (atlasSurface)
+    {
+        SDL_FillSurfaceRect(atlasSurface, NULL, 0);
+        for (int i = 0; i < GLYPH_ATLAS_CHAR_COUNT; i++)
+        {
+            if (!surfaces[i]) continue;
+            SDL_SetSurfaceBlendMode(surfaces[i], SDL_BLENDMODE_NONE);
+            SDL_BlitSurface(surfaces[i], NULL, atlasSurface, &placement[i]);
+
+            Glyph *glyph = &atlas->glyphs[i];
+            glyph->width = (float)placement[i].w;
+            glyph->uv = (SDL_FRect){(float)placement[i].x / DEFALUT_GLYPH_ATLAS_WIDTH, (float)placement[i].y / atlasHeight, (float)placement[i].w / DEFALUT_GLYPH_ATLAS_WIDTH, (float)placement[i].h / atlasHeight};
+        }
+        atlas->texture = SDL_CreateTextureFromSurface(renderer, atlasSurface);
+        SDL_DestroySurface(atlasSurface);
+    }
+    for (int i = 0; i < GLYPH_ATLAS_CHAR_COUNT; i++)
+    {
+        if (surfaces[i]) SDL_DestroySurface(surfaces[i]);
+    }
+
+    if (!atlas->texture)
+    {
+        fprintf(stderr, "字形图集创建失败: %s\n", SDL_GetError());
+        free(atlas);
+        return NULL;
+    }
+    SDL_SetTextureBlendMode(atlas->texture, SDL_BLENDMODE_BLEND);
+    atlas->lineHeight = (float)lineHeight;
+    return atlas;
+}
+
+// 销毁图集和纹理
+void GlyphAtlas_Destroy(GlyphAtlas *atlas)
+{
+    if (!atlas) return;
+    if (atlas->texture) SDL_DestroyTexture(atlas->texture);
+    free(atlas);
+}
+
+// 文字按字体原始大小排版时的宽度(最后一个字形可能比前进距离宽)
+float GlyphAtlas_MeasureText(const GlyphAtlas *atlas, const char *text)
+{
+    if (!atlas || !text) return 0;
+    float pen = 0, width = 0;
+    for (const char *c = text; *c; c++)
+    {
+        const Glyph *glyph = GlyphAtlas_GetGlyph(atlas, (unsigned char)*c);
+        if (!glyph) continue;
+        width = SDL_max(width, pen + glyph->width);
+        pen += glyph->advance;
+    }
+    return SDL_max(width, pen);
+}
+
+// 把文字拉伸到rect里,每个字形一个带纹理的矩形
+int GlyphAtlas_DrawText(const GlyphAtlas *atlas, BatchRenderer *batch, SDL_FRect rect, SDL_FColor color, const char *text)
+{
+    if (!atlas || !batch || !text) return 0;
+    float textWidth = GlyphAtlas_MeasureText(atlas, text);
+    if (textWidth <= 0) return 0;
+
+    // 横向按文字宽度缩放,纵向字形和字体一样高,直接拉伸到rect的高度
+    const float scaleX = rect.w / textWidth;
+    float pen = rect.x;
+    int count = 0;
+    for (const char *c = text; *c; c++)
+    {
+        const Glyph *glyph = GlyphAtlas_GetGlyph(atlas, (unsigned char)*c);
+        if (!glyph) continue;
+        if (glyph->width > 0)
+        {
+            SDL_FRect dst = {pen, rect.y, glyph->width * scaleX, rect.h};
+            if (Batch_AddTexturedQuad(batch, &dst, &glyph->uv, color) >= 0) count++;
+        }
+        pen += glyph->advance * scaleX;
+    }
+    return count;
+}
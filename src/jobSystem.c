@@ -0,0 +1,150 @@
+#include "jobSystem.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 领取并执行任务,直到这一批任务被领完
+static void JobSystem_RunJobs(JobSystem *jobs, int workerIndex)
+{
+    for (;;)
+    {
+        int jobIndex = SDL_AddAtomicInt(&jobs->nextJob, 1);
+        if (jobIndex >= jobs->jobCount) break;
+        jobs->function(jobs->userData, jobIndex, workerIndex);
+    }
+}
+
+// 后台线程:等待新的一批任务,执行完后通知主线程
+static int JobSystem_WorkerMain(void *data)
+{
+    JobWorker *worker = (JobWorker *)data;
+    JobSystem *jobs = worker->jobs;
+    int seenGeneration = 0;
+
+    for (;;)
+    {
+        SDL_LockMutex(jobs->mutex);
+        while (!jobs->quit && jobs->generation == seenGeneration)
+        {
+            SDL_WaitCondition(jobs->wakeCondition, jobs->mutex);
+        }
+        if (jobs->quit)
+        {
+            SDL_UnlockMutex(jobs->mutex);
+            break;
+        }
+        seenGeneration = jobs->generation;
+        SDL_UnlockMutex(jobs->mutex);
+
+        JobSystem_RunJobs(jobs, worker->workerIndex);
+
+        SDL_LockMutex(jobs->mutex);
+        if (--jobs->busyCount == 0)
+        {
+            SDL_SignalCondition(jobs->doneCondition);
+        }
+        SDL_UnlockMutex(jobs->mutex);
+    }
+    return 0;
+}
+
+// 创建线程池
+JobSystem *JobSystem_Create(int threadCount)
+{
+    if (threadCount < 0) threadCount = SDL_GetNumLogicalCPUCores() - 1;
+    if (threadCount < 0) threadCount = 0;
+    if (threadCount > MAX_JOB_WORKERS - 1) threadCount = MAX_JOB_WORKERS - 1;
+
+    JobSystem *jobs = (JobSystem *)malloc(sizeof(JobSystem));
+    if (!jobs) return NULL;
+    memset(jobs, 0, sizeof(JobSystem));
+
+    jobs->mutex = SDL_CreateMutex();
+    jobs->wakeCondition = SDL_CreateCondition();
+    jobs->doneCondition = SDL_CreateCondition();
+    if (!jobs->mutex || !jobs->wakeCondition || !jobs->doneCondition)
+    {
+        fprintf(stderr, "Failed to create job system: %s\n", SDL_GetError());
+        JobSystem_Destroy(jobs);
+        return NULL;
+    }
+
+    for (int i = 0; i < threadCount; i++)
+    {
+        JobWorker *worker = &jobs->workers[i];
+        worker->jobs = jobs;
+        worker->workerIndex = i + 1;
+        worker->thread = SDL_CreateThread(JobSystem_WorkerMain, "job worker", worker);
+        if (!worker->thread)
+        {
+            // 线程创建失败时用已经创建的线程继续工作
+            fprintf(stderr, "Failed to create job worker: %s\n", SDL_GetError());
+            break;
+        }
+        jobs->threadCount++;
+    }
+    return jobs;
+}
+
+// 销毁线程池
+void JobSystem_Destroy(JobSystem *jobs)
+{
+    if (!jobs) return;
+
+    if (jobs->mutex)
+    {
+        SDL_LockMutex(jobs->mutex);
+        jobs->quit = true;
+        if (jobs->wakeCondition) SDL_BroadcastCondition(jobs->wakeCondition);
+        SDL_UnlockMutex(jobs->mutex);
+    }
+    for (int i = 0; i < jobs->threadCount; i++)
+    {
+        SDL_WaitThread(jobs->workers[i].thread, NULL);
+    }
+
+    if (jobs->doneCondition) SDL_DestroyCondition(jobs->doneCondition);
+    if (jobs->wakeCondition) SDL_DestroyCondition(jobs->wakeCondition);
+    if (jobs->mutex) SDL_DestroyMutex(jobs->mutex);
+    free(jobs);
+}
+
+// 参与执行任务的线程数量
+int JobSystem_GetWorkerCount(const JobSystem *jobs) { return jobs ? jobs->threadCount + 1 : 1; }
+
+// 并行执行任务
+void JobSystem_ParallelFor(JobSystem *jobs, int jobCount, JobFunction function, void *userData)
+{
+    if (!function || jobCount <= 0) return;
+
+    // 没有后台线程或只有一个任务时直接在主线程执行
+    if (!jobs || jobs->threadCount == 0 || jobCount == 1)
+    {
+        for (int i = 0; i < jobCount; i++)
+        {
+            function(userData, i, 0);
+        }
+        return;
+    }
+
+    SDL_LockMutex(jobs->mutex);
+    jobs->function = function;
+    jobs->userData = userData;
+    jobs->jobCount = jobCount;
+    SDL_SetAtomicInt(&jobs->nextJob, 0);
+    jobs->busyCount = jobs->threadCount;
+    jobs->generation++;
+    SDL_BroadcastCondition(jobs->wakeCondition);
+    SDL_UnlockMutex(jobs->mutex);
+
+    // 主线程也参与执行
+    JobSystem_RunJobs(jobs, 0);
+
+    // 等后台线程都执行完手上的任务
+    SDL_LockMutex(jobs->mutex);
+    while (jobs->busyCount > 0)
+    {
+        SDL_WaitCondition(jobs->doneCondition, jobs->mutex);
+    }
+    SDL_UnlockMutex(jobs->mutex);
+}
@@ -2,8 +2,17 @@
 #include "batchingRender.h"
 #include "camera.h"
 #include "character.h"
+#include "flowField.h"
 #include "frameController.h"
+#include "glyphAtlas.h"
 #include "polygon.h"
+#include "presets.h"
+#include "profiler.h"
+#include "replay.h"
+#include "rng.h"
+#include "simulation.h"
+#include "spriteAtlas.h"
+#include "staticGeometry.h"
 #include "ui.h"
 #include <SDL3/SDL.h>
 #include <SDL3/SDL_main.h>
@@ -13,6 +22,7 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 
 // 屏幕尺寸
@@ -73,18 +83,22 @@ void GameOverScene_Render(void);
 // 全局变量
 static SDL_Window *g_window = NULL;
 static SDL_Renderer *g_renderer = NULL;
-static BatchRenderer *g_worldBatch = NULL; // 世界几何批次
-static UIManager *g_uiManager = NULL;      // UI管理器
+static BatchRenderer *g_worldBatch = NULL;   // 世界几何批次
+static StaticGeometry *g_staticLayer = NULL; // 墙和地面装饰(注册一次,每帧把可见部分复制进世界批次)
+static FlowField *g_flowField = NULL;        // 敌人寻路的流场(覆盖整个场地,墙为障碍)
+static UIManager *g_uiManager = NULL;        // UI管理器
+static JobSystem *g_jobSystem = NULL;        // 线程池
+static BatchRenderer *g_chunkBatches[MAX_JOB_WORKERS * RENDER_CHUNKS_PER_WORKER]; // 并行渲染时每段角色的批次
+static int g_chunkBatchCount = 0;
 static TTF_Font *g_font = NULL;
+static GlyphAtlas *g_glyphAtlas = NULL;   // 字形图集(字体加载后创建一次)
+static BatchRenderer *g_textBatch = NULL; // 一帧里所有文字的批次(屏幕坐标,使用图集纹理)
 static Camera *g_camera = NULL;
 float FPS = 0.0f;
 float UPS = 0.0f;
 
-int score = 0;
 int maxScore = 0;
-float playSceneTime = 0.0f;
-Uint64 start = 0;
-Uint64 now = 0;
+float playSceneTime = 0.0f; // 游戏时间(按逻辑帧数计算)
 bool select = false;
 
 float lastSpawnTime = 0.0f;
@@ -127,6 +141,7 @@ void ChangeScene(GameScene newScene)
 // 以下资源在不同场景间共享，但使用时要注意场景切换时的状态
 static CharacterPool g_characterPool;
 static BulletPool g_bulletPool;
+static Simulation g_simulation; // 游戏逻辑(角色池和子弹池的逻辑帧)
 static Character *g_playerCharacter = NULL; // 玩家角色
 static FrameController g_frameController;
 
@@ -144,41 +159,31 @@ static struct
     bool tailShoot;
 } g_gameControls;
 
-// 图片纹理
-SDL_Texture *shortGunTexture;
-SDL_Texture *longGunTexture;
-SDL_Texture *sniperGunTexture;
-SDL_Texture *textures[3];
-
-// 角色预设
-// 蛇1:
-const int SNAKE1_bodyCount = 16;
-const float SNAKE1_radiusList[16] = {30, 30, 25, 25, 25, 25, 25, 25, 25, 20, 20, 15, 15, 15, 10, 10};
-const float SNAKE1_distanceList[16] = {60, 60, 60, 60, 60, 60, 60, 60, 60, 60, 60, 60, 60, 60, 60, 60};
-const float SNAKE1_flexibility[16] = {45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f};
-// 蜥蜴
-const int LIZARD_bodyCount = 21;
-const float LIZARD_radiusList[21] = {55, 31, 58, 59, 60, 60, 48, 29, 18, 11, 8, 8, 8, 8, 8, 8, 8, 8, 7, 7, 7};
-const float LIZARD_distanceList[21] = {42, 37, 29, 30, 33, 33, 28, 18, 14, 14, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12};
-const float LIZARD_flexibility[21] = {45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f};
-const Chain3 LIZARD_legs[2] = {{{0, 0}, {0.0}, {0.0}, 40.0f, 20.0f, 20.0f, 70.0f, 35.0f}, {{0, 0}, {0.0}, {0.0}, 23.0f, 23.0f, 23.0f, 80.0f, 45.0f}};
-
-// 颜色预设
-const SDL_FColor darkGold = {0.85f, 0.64f, 0.13f, 1.0f};
-const SDL_FColor lightSkyBlue = {5.29f, 0.81f, 0.98f, 1.0f};
-const SDL_FColor purple = {0.58f, 0.0f, 0.83f, 1.0f};
-const SDL_FColor white = {1.0f, 1.0f, 1.0f, 1.0f};
-
-// 子弹预设
-const Bullet defalutBullet = {5, 5, 5, (SDL_FColor){1.0f, 1.0f, 1.0f, 1.0f}, 0, (Vector){0, 0}};
-const Bullet ammo = {10, 20, 10, darkGold, 0, (Vector){0, 0}};
-const Bullet bubble = {100, 5, 25, lightSkyBlue, 0, (Vector){0, 0}};
-const Bullet sniperBullet = {75, 40, 15, purple, 0, (Vector){0, 0}};
-
-// 枪预设
-const Gun shortGun = {SHORTGUN, defalutBullet, 90, 1.25, 0};
-const Gun longGun = {LONGGUN, defalutBullet, 20, 1.0, 0};
-const Gun sniperGun = {SNIPERGUN, defalutBullet, 150, 2.0, 0};
+// 武器选择:点击选择界面时只记下选择,在下一个逻辑帧开始时生效(录像里按逻辑帧记录)
+enum WeaponChoice
+{
+    WEAPON_CHOICE_NONE,
+    WEAPON_CHOICE_HEAD_BULLET, // 头部的枪换成新子弹
+    WEAPON_CHOICE_HEAD_GUN,    // 头部换成新枪(保留子弹)
+    WEAPON_CHOICE_TAIL_BULLET, // 尾部的枪换成新子弹
+    WEAPON_CHOICE_TAIL_GUN     // 尾部换成新枪(保留子弹)
+};
+static enum WeaponChoice g_weaponChoice = WEAPON_CHOICE_NONE;
+static SDL_FPoint g_mouseWorld = {0, 0}; // 这个逻辑帧的鼠标世界坐标(回放时来自录像)
+
+// 随机数和录像
+#define REPLAY_HEADLESS_TICKS_PER_ITERATE 600 // 无窗口回放时每次主循环执行的逻辑帧数
+static Rng g_rng;                             // 游戏逻辑用的随机数(每局开始时设置种子)
+static Replay g_replay;                       // 正在录制或回放的录像
+static const char *g_recordPath = NULL;       // --record: 每局游戏录制到这个文件(覆盖上一局)
+static bool g_headless = false;               // --headless: 回放时不创建窗口,不渲染
+static bool g_unthrottled = false;            // --unthrottled: 回放时不等待,尽快执行逻辑帧
+static Uint64 g_replayStartCounter = 0;       // 回放开始时的计数器
+
+// 图片纹理:所有图片拼成一张图集,下标和枪械类型(enum GunType)一致
+const char *const spritePaths[] = {"../image/shortGun.png", "../image/longGun.png", "../image/sniperGun.png"};
+static SpriteAtlas *g_spriteAtlas = NULL;
+static BatchRenderer *g_spriteBatch = NULL; // 精灵批次(屏幕坐标,使用图集纹理)
 
 // ui矩行
 const SDL_FRect titleRect = {SCREEN_WIDTH / 2.0f - 200, 100, 400, 80};
@@ -191,12 +196,14 @@ const SDL_FRect toMeneRect = {SCREEN_WIDTH / 2.0f - 100, 650, 200, 60};
 // 文本矩行
 const SDL_FRect scoreTextRect = {SCREEN_WIDTH / 2.0f - 125, 10, 250, 40};
 const SDL_FRect timeTextRect = {SCREEN_WIDTH / 2.0f - 100, SCREEN_HEIGHT - 60, 200, 60};
-// 墙BOX
+// 墙BOX(按SimulationWall的顺序:上,下,左,右)
 //-SCREEN_WIDTH*3,SCREEN_WIDTH*3,-SCREEN_HEIGHT*3,SCREEN_HEIGHT*3
-const AABBBox wallUpBox = {-SCREEN_WIDTH * 4, SCREEN_WIDTH * 4, SCREEN_HEIGHT * 3, SCREEN_HEIGHT * 4};
-const AABBBox wallDownBox = {-SCREEN_WIDTH * 4, SCREEN_WIDTH * 4, -SCREEN_HEIGHT * 4, -SCREEN_HEIGHT * 3};
-const AABBBox wallLeftBox = {-SCREEN_WIDTH * 4, -SCREEN_WIDTH * 3, -SCREEN_HEIGHT * 4, SCREEN_HEIGHT * 4};
-const AABBBox wallRightBox = {SCREEN_WIDTH * 3, SCREEN_WIDTH * 4, -SCREEN_HEIGHT * 4, SCREEN_HEIGHT * 4};
+const AABBBox wallBoxes[SIM_WALL_COUNT] = {
+    {-SCREEN_WIDTH * 4, SCREEN_WIDTH * 4, SCREEN_HEIGHT * 3, SCREEN_HEIGHT * 4},
+    {-SCREEN_WIDTH * 4, SCREEN_WIDTH * 4, -SCREEN_HEIGHT * 4, -SCREEN_HEIGHT * 3},
+    {-SCREEN_WIDTH * 4, -SCREEN_WIDTH * 3, -SCREEN_HEIGHT * 4, SCREEN_HEIGHT * 4},
+    {SCREEN_WIDTH * 3, SCREEN_WIDTH * 4, -SCREEN_HEIGHT * 4, SCREEN_HEIGHT * 4},
+};
 SDL_FRect wallUpRect;
 SDL_FRect wallDownRect;
 SDL_FRect wallLeftRect;
@@ -209,12 +216,10 @@ void CreatePlayerCharacter(void)
     if (!g_worldBatch) return;
 
     // 创建蜥蜴角色作为玩家
-    g_playerCharacter = Character_Creat(LIZARD, 100.f, 100.f, (Vector){-1.0f, -0.5f}, 5, LIZARD_radiusList, LIZARD_distanceList, LIZARD_flexibility, LIZARD_bodyCount, (SDL_FColor){1.0f, 0.5f, 0.0f, 1.0f}, (SDL_FColor){1.0f, 1.0f, 1.0f, 1.0f}, LIZARD_legs);
+    g_playerCharacter = CharacterPool_Creat(&g_characterPool, LIZARD, 100.f, 100.f, (Vector){-1.0f, -0.5f}, 5, LIZARD_radiusList, LIZARD_distanceList, LIZARD_flexibility, LIZARD_bodyCount, (SDL_FColor){1.0f, 0.5f, 0.0f, 1.0f}, (SDL_FColor){1.0f, 1.0f, 1.0f, 1.0f}, LIZARD_legs);
 
     if (g_playerCharacter)
     {
-        CharacterPool_Add(&g_characterPool, g_playerCharacter);
-
         // 设置武器
         g_playerCharacter->haveHeadGun = true;
         g_playerCharacter->haveTailGun = true;
@@ -227,6 +232,16 @@ void CreatePlayerCharacter(void)
     }
 }
 
+// 随机颜色(分量逐个取随机数,取随机数的顺序不依赖编译器对初始化列表的求值顺序)
+static SDL_FColor RandomColor(void)
+{
+    SDL_FColor color = {0, 0, 0, 1.0f};
+    color.r = Rng_Int(&g_rng, 255) / 255.0f;
+    color.g = Rng_Int(&g_rng, 255) / 255.0f;
+    color.b = Rng_Int(&g_rng, 255) / 255.0f;
+    return color;
+}
+
 void generateEnemyCharacter(void)
 {
     // 获取玩家位置
@@ -242,7 +257,7 @@ void generateEnemyCharacter(void)
     float spawnDistance = SDL_max(viewWidth, viewHeight) * 0.6f; // 生成距离为视野对角线长度的60%
 
     // 随机角度
-    float angle = (float)(rand() % 360) * 3.14159f / 180.0f;
+    float angle = (float)Rng_Int(&g_rng, 360) * 3.14159f / 180.0f;
 
     // 根据角度计算生成位置
     float spawnX = playerX + spawnDistance * cosf(angle);
@@ -256,90 +271,139 @@ void generateEnemyCharacter(void)
     Vector dirToPlayer = {playerX - spawnX, playerY - spawnY};
     vector_Normalization(&dirToPlayer);
 
-    // 随机颜色
-    SDL_FColor randColor = {(float)(rand() % 255) / 255.0f, (float)(rand() % 255) / 255.0f, (float)(rand() % 255) / 255.0f, 1.0f};
-    SDL_FColor randOutLineColor = {(float)(rand() % 255) / 255.0f, (float)(rand() % 255) / 255.0f, (float)(rand() % 255) / 255.0f, 1.0f};
+    // 随机颜色和速度
+    SDL_FColor randColor = RandomColor();
+    SDL_FColor randOutLineColor = RandomColor();
+    float speed = 3.0f + Rng_Int(&g_rng, 3);
 
     // 创建敌人
-    Character *enemyCharacter = Character_Creat(SNAKE, spawnX, spawnY, dirToPlayer, 3.0f + fmodf(rand(), 3.0f), SNAKE1_radiusList, SNAKE1_distanceList, SNAKE1_flexibility, SNAKE1_bodyCount, randColor, randOutLineColor, NULL); // 随机速度 3.0~6.0
-
-    if (enemyCharacter)
-    {
-        CharacterPool_Add(&g_characterPool, enemyCharacter);
-    }
+    CharacterPool_Creat(&g_characterPool, SNAKE, spawnX, spawnY, dirToPlayer, speed, SNAKE1_radiusList, SNAKE1_distanceList, SNAKE1_flexibility, SNAKE1_bodyCount, randColor, randOutLineColor, NULL); // 随机速度 3.0~6.0
 }
 
 void CreateTestCharacters(void) // for debug&&性能测试
 {
     g_playerCharacter->maxHP = 9999999;
     g_playerCharacter->HP = g_playerCharacter->maxHP;
-    srand(time(NULL));
     for (int i = 0; i < 500; i++)
     { // 减少数量以提升性能
-        SDL_FColor randColor = {(float)(rand() % 255) / 255.0f, (float)(rand() % 255) / 255.0f, (float)(rand() % 255) / 255.0f, 1.0f};
-        SDL_FColor randOutLineColor = {(float)(rand() % 255) / 255.0f, (float)(rand() % 255) / 255.0f, (float)(rand() % 255) / 255.0f, 1.0f};
-        Vector randDir = {(float)(rand() % 1000 - 500), (float)(rand() % 1000 - 500)};
-        Character *tempCharacter;
+        SDL_FColor randColor = RandomColor();
+        SDL_FColor randOutLineColor = RandomColor();
+        Vector randDir;
+        randDir.x = (float)(Rng_Int(&g_rng, 1000) - 500);
+        randDir.y = (float)(Rng_Int(&g_rng, 1000) - 500);
+        float x = (float)Rng_Int(&g_rng, 5000);
+        float y = (float)Rng_Int(&g_rng, 500);
         if (i % 2 == 0)
         {
 
-            tempCharacter = Character_Creat(SNAKE, rand() % 5000, rand() % 500, randDir, 5, SNAKE1_radiusList, SNAKE1_distanceList, SNAKE1_flexibility, SNAKE1_bodyCount, randColor, randOutLineColor, NULL);
+            CharacterPool_Creat(&g_characterPool, SNAKE, x, y, randDir, 5, SNAKE1_radiusList, SNAKE1_distanceList, SNAKE1_flexibility, SNAKE1_bodyCount, randColor, randOutLineColor, NULL);
         }
         else
         {
-            tempCharacter = Character_Creat(LIZARD, rand() % 5000, rand() % 500, randDir, 5, LIZARD_radiusList, LIZARD_distanceList, LIZARD_flexibility, LIZARD_bodyCount, randColor, randOutLineColor, LIZARD_legs);
+            CharacterPool_Creat(&g_characterPool, LIZARD, x, y, randDir, 5, LIZARD_radiusList, LIZARD_distanceList, LIZARD_flexibility, LIZARD_bodyCount, randColor, randOutLineColor, LIZARD_legs);
         }
-        if (tempCharacter)
+    }
+}
+
+#define DECOR_SPACING 1200.0f // 地面装饰之间的距离
+#define DECOR_STAR_POINTS 5    // 装饰星形的角数
+
+// 注册静态几何:四面墙和场地里的星形地面装饰(凹多边形)
+static void BuildStaticGeometry(void)
+{
+    g_staticLayer = StaticGeometry_Create();
+    if (!g_staticLayer) return;
+
+    StaticGeometry_AddRect(g_staticLayer, wallUpRect.x, wallUpRect.y, wallUpRect.w, wallUpRect.h, white);
+    StaticGeometry_AddRect(g_staticLayer, wallDownRect.x, wallDownRect.y, wallDownRect.w, wallDownRect.h, white);
+    StaticGeometry_AddRect(g_staticLayer, wallLeftRect.x, wallLeftRect.y, wallLeftRect.w, wallLeftRect.h, white);
+    StaticGeometry_AddRect(g_staticLayer, wallRightRect.x, wallRightRect.y, wallRightRect.w, wallRightRect.h, white);
+
+    // 装饰排成网格,隔行错开半格,每个星形的大小和朝向按位置变化
+    const SDL_FColor decorColor = {0.16f, 0.16f, 0.21f, 1.0f};
+    const float minX = wallBoxes[SIM_WALL_LEFT].maxX + DECOR_SPACING * 0.5f;
+    const float maxX = wallBoxes[SIM_WALL_RIGHT].minX - DECOR_SPACING * 0.5f;
+    const float minY = wallBoxes[SIM_WALL_DOWN].maxY + DECOR_SPACING * 0.5f;
+    const float maxY = wallBoxes[SIM_WALL_UP].minY - DECOR_SPACING * 0.5f;
+    int row = 0;
+    for (float y = minY; y <= maxY; y += DECOR_SPACING, row++)
+    {
+        int column = 0;
+        for (float x = minX + (row % 2) * DECOR_SPACING * 0.5f; x <= maxX; x += DECOR_SPACING, column++)
         {
-            CharacterPool_Add(&g_characterPool, tempCharacter);
+            float outer = 60.0f + ((row * 7 + column * 3) % 5) * 20.0f;
+            float rotation = (float)((row * 5 + column * 11) % 12) * (float)M_PI / 30.0f;
+            SDL_FPoint star[DECOR_STAR_POINTS * 2];
+            for (int i = 0; i < DECOR_STAR_POINTS * 2; i++)
+            {
+                float radius = i % 2 ? outer * 0.45f : outer;
+                float angle = rotation + i * (float)M_PI / DECOR_STAR_POINTS;
+                star[i] = (SDL_FPoint){x + radius * cosf(angle), y + radius * sinf(angle)};
+            }
+            StaticGeometry_AddPolygon(g_staticLayer, star, DECOR_STAR_POINTS * 2, decorColor);
         }
     }
 }
 
-// 渲染网格背景
-static void RenderGridBackground(Camera *camera, SDL_Renderer *renderer)
+// 创建覆盖整个场地(包括墙)的流场,墙注册为障碍
+static void BuildFlowField(void)
 {
-    if (!camera || !renderer) return;
-
-    // 获取屏幕中心对应的世界坐标
-    float centerWorldX = camera->x;
-    float centerWorldY = camera->y;
-
-    // 计算从屏幕中心到屏幕边缘的世界坐标距离
-    float maxWorldWidth = (float)camera->screenWidth / camera->zoom;
-    float maxWorldHeight = (float)camera->screenHeight / camera->zoom;
-
-    // 计算需要绘制的网格范围（世界坐标）
-    float leftWorld = centerWorldX - maxWorldWidth * 0.5f;
-    float rightWorld = centerWorldX + maxWorldWidth * 0.5f;
-    float bottomWorld = centerWorldY - maxWorldHeight * 0.5f;
-    float topWorld = centerWorldY + maxWorldHeight * 0.5f;
-
-    // 对齐到网格
-    int gridSize = 50;
-    int startX = (int)SDL_floorf(leftWorld / gridSize) * gridSize;
-    int endX = (int)SDL_ceilf(rightWorld / gridSize) * gridSize;
-    int startY = (int)SDL_floorf(bottomWorld / gridSize) * gridSize;
-    int endY = (int)SDL_ceilf(topWorld / gridSize) * gridSize;
-
-    // 设置绘制颜色
-    SDL_SetRenderDrawColor(renderer, 50, 50, 60, 255);
-
-    // 绘制垂直线
-    for (int x = startX; x <= endX; x += gridSize)
+    const AABBBox bounds = {wallBoxes[SIM_WALL_LEFT].minX, wallBoxes[SIM_WALL_RIGHT].maxX, wallBoxes[SIM_WALL_DOWN].minY, wallBoxes[SIM_WALL_UP].maxY};
+    g_flowField = FlowField_Create(bounds, DEFALUT_FLOW_FIELD_CELL_SIZE);
+    if (!g_flowField)
     {
-        SDL_FPoint p1 = Camera_WorldToScreen(camera, (float)x, (float)startY);
-        SDL_FPoint p2 = Camera_WorldToScreen(camera, (float)x, (float)endY);
-        SDL_RenderLine(renderer, p1.x, p1.y, p2.x, p2.y);
+        SDL_Log("Failed to create flow field, enemies will chase the player directly");
+        return;
     }
+    for (int i = 0; i < SIM_WALL_COUNT; i++)
+    {
+        FlowField_AddObstacle(g_flowField, wallBoxes[i]);
+    }
+}
 
-    // 绘制水平线
-    for (int y = startY; y <= endY; y += gridSize)
+// 渲染网格背景
+static void RenderGridBackground(const Camera *camera, BatchRenderer *batch)
+{
+    if (!camera || !batch) return;
+
+    // 网格线写进世界批次的最前面,和世界几何一起一次画完(线的数量和缩放无关)
+    const int gridSize = 50;
+    Polygon_DrawGrid(batch, (float)gridSize, DEFALUT_GRID_MIN_SPACING, 1.0f, (SDL_FColor){50 / 255.0f, 50 / 255.0f, 60 / 255.0f, 1.0f}, camera);
+}
+
+// 把文字写入文字批次,到FlushText时一次画完;没有图集时退回Draw_Text立即绘制
+static void DrawHUDText(SDL_FRect rect, SDL_FColor color, const char *text)
+{
+    if (g_glyphAtlas && g_textBatch)
     {
-        SDL_FPoint p1 = Camera_WorldToScreen(camera, (float)startX, (float)y);
-        SDL_FPoint p2 = Camera_WorldToScreen(camera, (float)endX, (float)y);
-        SDL_RenderLine(renderer, p1.x, p1.y, p2.x, p2.y);
+        GlyphAtlas_DrawText(g_glyphAtlas, g_textBatch, rect, color, text);
+        return;
     }
+    Draw_Text(g_font, g_renderer, rect, color, text);
+}
+
+// 画出这一帧写入的所有文字(单次drawcall)
+static void FlushText(void)
+{
+    if (!g_textBatch) return;
+    Batch_Render(g_textBatch, g_renderer);
+    Batch_Clear(g_textBatch);
+}
+
+// 渲染枪:把枪的精灵(图集里第gun->type张图片)写入屏幕坐标的精灵批次
+static void Gun_render(const Gun *gun, Vector direction, const Camera *camera)
+{
+    if (!g_spriteAtlas || !g_spriteBatch) return;
+    float angle = 57.3 * atan2f(direction.y, direction.x);
+    SpriteAtlas_Draw(g_spriteAtlas, g_spriteBatch, gun->type, Camera_WorldToScreen(camera, gun->x, gun->y), angle - 90, 5 * camera->zoom);
+}
+
+// 画出精灵批次里的所有精灵(单次drawcall)
+static void FlushSprites(void)
+{
+    if (!g_spriteBatch) return;
+    Batch_Render(g_spriteBatch, g_renderer);
+    Batch_Clear(g_spriteBatch);
 }
 
 // 渲染FPS/UPS
@@ -348,9 +412,105 @@ static void RenderFPSDisplay(float fps, float ups)
     if (!g_font || !g_renderer) return;
     char fpsText[64];
     snprintf(fpsText, sizeof(fpsText), "FPS: %.1f|UPS:%.1f", fps, ups);
-    Draw_Text(g_font, g_renderer, (SDL_FRect){10, 5, 250, 30}, (SDL_FColor){0.0f, 1.0f, 0.0f, 1.0f}, fpsText);
+    DrawHUDText((SDL_FRect){10, 5, 250, 30}, (SDL_FColor){0.0f, 1.0f, 0.0f, 1.0f}, fpsText);
+}
+
+// 渲染剔除统计:画出的数量/被剔除的数量
+static void RenderCullStatsDisplay(void)
+{
+    if (!g_font || !g_renderer) return;
+    int charactersDrawn = 0, charactersCulled = 0, bulletsDrawn = 0, bulletsCulled = 0;
+    CharacterPool_GetCullStats(&g_characterPool, &charactersDrawn, &charactersCulled);
+    BulletPool_GetCullStats(&g_bulletPool, &bulletsDrawn, &bulletsCulled);
+    char cullText[96];
+    snprintf(cullText, sizeof(cullText), "Chars:%d/%d|Bullets:%d/%d|Dropped:%d", charactersDrawn, charactersCulled, bulletsDrawn, bulletsCulled, g_characterPool.droppedCount);
+    DrawHUDText((SDL_FRect){10, 65, 330, 30}, (SDL_FColor){0.0f, 1.0f, 0.0f, 1.0f}, cullText);
+}
+
+// 渲染世界批次的顶点统计(共享顶点省下的顶点数量)
+static void RenderBatchStatsDisplay(const BatchRenderer *batch)
+{
+    if (!g_font || !g_renderer || !batch) return;
+    int vertexCount = 0, indexCount = 0, triangleCount = 0;
+    Batch_GetStats(batch, &vertexCount, &indexCount, &triangleCount);
+    char statsText[96];
+    snprintf(statsText, sizeof(statsText), "Tris:%d|Verts:%d|Saved:%d", triangleCount, vertexCount, Batch_GetSavedVertexCount(batch));
+    DrawHUDText((SDL_FRect){10, 35, 250, 30}, (SDL_FColor){0.0f, 1.0f, 0.0f, 1.0f}, statsText);
 }
 
+#ifdef ENABLE_PROFILER
+#define PROFILER_OVERLAY_FRAMES 180        // 叠加柱状图显示最近多少帧
+#define PROFILER_OVERLAY_BAR_WIDTH 4.0f    // 每帧柱子的宽度
+#define PROFILER_OVERLAY_HEIGHT 200.0f     // 柱状图高度
+#define PROFILER_OVERLAY_MAX_MS 33.3f      // 柱状图高度对应的毫秒数
+#define PROFILER_OVERLAY_AVERAGE_FRAMES 60 // 图例里的平均耗时取最近多少帧
+#define PROFILER_TRACE_PATH "profile_trace.json"
+
+static bool g_showProfiler = false; // F1切换,F2导出Chrome trace
+
+// 渲染性能分析叠加图:每帧一根柱子,按区段堆叠,灰色为没有被区段覆盖的时间,两条横线是16.7ms和33.3ms
+static void RenderProfilerOverlay(void)
+{
+    if (!g_showProfiler || !g_uiManager) return;
+
+    const float msToPixel = PROFILER_OVERLAY_HEIGHT / PROFILER_OVERLAY_MAX_MS;
+    const float right = SCREEN_WIDTH - 20.0f;
+    const float left = right - PROFILER_OVERLAY_FRAMES * PROFILER_OVERLAY_BAR_WIDTH;
+    const float bottom = 80.0f + PROFILER_OVERLAY_HEIGHT;
+    int frameCount = SDL_min(Profiler_GetFrameCount(), PROFILER_OVERLAY_FRAMES);
+
+    UI_BeginDraw(g_uiManager);
+    UI_DrawRect(g_uiManager, left - 10, bottom - PROFILER_OVERLAY_HEIGHT - 10, right - left + 20, PROFILER_OVERLAY_HEIGHT + 20 + PROFILE_ZONE_COUNT * 22.0f, (SDL_FColor){0.0f, 0.0f, 0.0f, 0.6f}, true);
+
+    // 柱子:最新的一帧在最右边
+    for (int f = 0; f < frameCount; f++)
+    {
+        const ProfileFrame *frame = Profiler_GetFrame(f);
+        float x = right - (f + 1) * PROFILER_OVERLAY_BAR_WIDTH;
+        float y = bottom;
+        Uint64 covered = 0;
+        for (int z = 0; z < PROFILE_ZONE_COUNT; z++)
+        {
+            covered += frame->zoneTime[z];
+            float height = SDL_min(Profiler_ToMilliseconds(frame->zoneTime[z]) * msToPixel, y - (bottom - PROFILER_OVERLAY_HEIGHT));
+            if (height <= 0) continue;
+            y -= height;
+            UI_DrawRect(g_uiManager, x, y, PROFILER_OVERLAY_BAR_WIDTH - 1, height, Profiler_GetZoneColor((ProfileZone)z), true);
+        }
+        Uint64 total = frame->end - frame->start;
+        float other = total > covered ? Profiler_ToMilliseconds(total - covered) * msToPixel : 0;
+        other = SDL_min(other, y - (bottom - PROFILER_OVERLAY_HEIGHT));
+        if (other > 0) UI_DrawRect(g_uiManager, x, y - other, PROFILER_OVERLAY_BAR_WIDTH - 1, other, (SDL_FColor){0.5f, 0.5f, 0.5f, 0.5f}, true);
+    }
+
+    // 16.7ms和33.3ms参考线
+    UI_DrawRect(g_uiManager, left, bottom - 16.7f * msToPixel, right - left, 1, (SDL_FColor){0.0f, 1.0f, 0.0f, 0.8f}, true);
+    UI_DrawRect(g_uiManager, left, bottom - 33.3f * msToPixel, right - left, 1, (SDL_FColor){1.0f, 0.0f, 0.0f, 0.8f}, true);
+
+    // 图例色块
+    for (int z = 0; z < PROFILE_ZONE_COUNT; z++)
+    {
+        UI_DrawRect(g_uiManager, left, bottom + 10 + z * 22.0f, 16, 16, Profiler_GetZoneColor((ProfileZone)z), true);
+    }
+    UI_EndDraw(g_uiManager, g_renderer);
+
+    // 图例文字:区段名称和最近几帧的平均耗时
+    if (!g_font) return;
+    int averageCount = SDL_min(frameCount, PROFILER_OVERLAY_AVERAGE_FRAMES);
+    for (int z = 0; z < PROFILE_ZONE_COUNT; z++)
+    {
+        Uint64 sum = 0;
+        for (int f = 0; f < averageCount; f++)
+        {
+            sum += Profiler_GetFrame(f)->zoneTime[z];
+        }
+        char text[64];
+        snprintf(text, sizeof(text), "%s: %.2fms", Profiler_GetZoneName((ProfileZone)z), averageCount > 0 ? Profiler_ToMilliseconds(sum) / averageCount : 0.0f);
+        DrawHUDText((SDL_FRect){left + 24, bottom + 8 + z * 22.0f, strlen(text) * 10.0f, 20}, white, text);
+    }
+}
+#endif
+
 // ==================== 主菜单场景实现 ====================
 
 void MainMenuScene_Init(void)
@@ -443,6 +603,7 @@ void MainMenuScene_Render(void)
     if (g_worldBatch)
     {
         Batch_Clear(g_worldBatch);
+        Batch_SetCamera(g_worldBatch, g_camera);
 
         // 绘制背景方块
         for (int i = 0; i < 20; i++)
@@ -478,25 +639,27 @@ void MainMenuScene_Render(void)
     {
 
         // 标题文字
-        Draw_Text(g_font, g_renderer, titleRect, white, "LIZARD, STAY ALIVE!");
+        DrawHUDText(titleRect, white, "LIZARD, STAY ALIVE!");
 
         // 开始按钮文字
-        Draw_Text(g_font, g_renderer, startRect, white, "START GAME");
+        DrawHUDText(startRect, white, "START GAME");
 
         // 退出按钮文字
-        Draw_Text(g_font, g_renderer, exitRect, white, "EXIT GAME");
+        DrawHUDText(exitRect, white, "EXIT GAME");
     }
 
     // 渲染测试纹理
     static float testangle = 0;
     testangle = fmodf(testangle + 0.1, 360.0f);
-    Render_Texture(g_renderer, shortGunTexture, (SDL_FPoint){100, 100}, testangle, 10);
-    Render_Texture(g_renderer, longGunTexture, (SDL_FPoint){SCREEN_WIDTH - 100, 100}, testangle, 10);
-    Render_Texture(g_renderer, sniperGunTexture, (SDL_FPoint){100, SCREEN_HEIGHT - 100}, testangle, 10);
+    SpriteAtlas_Draw(g_spriteAtlas, g_spriteBatch, SHORTGUN, (SDL_FPoint){100, 100}, testangle, 10);
+    SpriteAtlas_Draw(g_spriteAtlas, g_spriteBatch, LONGGUN, (SDL_FPoint){SCREEN_WIDTH - 100, 100}, testangle, 10);
+    SpriteAtlas_Draw(g_spriteAtlas, g_spriteBatch, SNIPERGUN, (SDL_FPoint){100, SCREEN_HEIGHT - 100}, testangle, 10);
+    FlushSprites();
 
     // 渲染FPS
     FrameController_UpdateFPS(&g_frameController, &FPS, &UPS);
     RenderFPSDisplay(FPS, UPS);
+    FlushText();
 
     SDL_RenderPresent(g_renderer);
     FrameController_AddRenderCount(&g_frameController);
@@ -504,6 +667,24 @@ void MainMenuScene_Render(void)
 
 // ==================== 游戏场景实现 ====================
 
+// 每局开始时设置随机数种子:回放时使用录像里的种子,否则用当前时间(录制时写进录像)
+static void BeginGameRandom(void)
+{
+    Uint64 seed = (Uint64)time(NULL) ^ SDL_GetPerformanceCounter();
+    if (g_replay.mode == REPLAY_PLAY)
+    {
+        seed = g_replay.header.seed;
+    }
+    else if (g_recordPath)
+    {
+        Replay_End(&g_replay);
+        if (Replay_BeginRecord(&g_replay, g_recordPath, seed, LOGIC_FRAME_RATE))
+            printf("开始录制: %s\n", g_recordPath);
+    }
+    Rng_Seed(&g_rng, seed);
+    g_replayStartCounter = SDL_GetPerformanceCounter();
+}
+
 void GamePlayScene_Init(void)
 {
     SDL_Log("Initializing Game Play scene");
@@ -534,6 +715,9 @@ void GamePlayScene_Init(void)
     CharacterPool_Clear(&g_characterPool);
     BulletPool_Clear(&g_bulletPool);
 
+    // 设置随机数种子,开始录制(刷怪要用随机数,必须在生成敌人之前)
+    BeginGameRandom();
+
     // 创建玩家角色
     CreatePlayerCharacter();
 
@@ -551,14 +735,15 @@ void GamePlayScene_Init(void)
 
     // 重置游玩时间
     playSceneTime = 0;
-    start = SDL_GetPerformanceCounter();
-    now = start;
 
     // 重置是否在选择武器
     select = false;
+    g_weaponChoice = WEAPON_CHOICE_NONE;
 
-    // 重置分数
-    score = 0;
+    // 重置游戏逻辑(包括分数)
+    Simulation_Init(&g_simulation, &g_characterPool, &g_bulletPool, g_jobSystem);
+    Simulation_SetWalls(&g_simulation, wallBoxes);
+    Simulation_SetFlowField(&g_simulation, g_flowField);
 
     // 重置刷怪
     lastSpawnTime = 0;
@@ -569,11 +754,117 @@ void GamePlayScene_Cleanup(void)
 {
     SDL_Log("Cleaning up Game Play scene");
     // 游戏场景清理时可以保留角色池数据，或根据需要清空
-    if (score > maxScore) maxScore = score;
+    if (g_simulation.score > maxScore) maxScore = g_simulation.score;
+
+    // 结束录制(回写帧数)
+    if (g_replay.mode == REPLAY_RECORD) Replay_End(&g_replay);
+}
+
+// 按键状态和录像里的按键位互相转换
+static Uint16 PackGameControls(void)
+{
+    return (Uint16)(g_gameControls.cameraMoveUP << 0 | g_gameControls.cameraMoveDown << 1 | g_gameControls.cameraMoveLeft << 2 | g_gameControls.cameraMoveRight << 3 |
+                    g_gameControls.moveForward << 4 | g_gameControls.turnLeft << 5 | g_gameControls.turnRight << 6 | g_gameControls.headShoot << 7 | g_gameControls.tailShoot << 8);
+}
+static void UnpackGameControls(Uint16 buttons)
+{
+    g_gameControls.cameraMoveUP = buttons & (1 << 0);
+    g_gameControls.cameraMoveDown = buttons & (1 << 1);
+    g_gameControls.cameraMoveLeft = buttons & (1 << 2);
+    g_gameControls.cameraMoveRight = buttons & (1 << 3);
+    g_gameControls.moveForward = buttons & (1 << 4);
+    g_gameControls.turnLeft = buttons & (1 << 5);
+    g_gameControls.turnRight = buttons & (1 << 6);
+    g_gameControls.headShoot = buttons & (1 << 7);
+    g_gameControls.tailShoot = buttons & (1 << 8);
+}
+
+// 读取这个逻辑帧的输入:回放时从录像读出,否则使用当前的按键和鼠标(录制时写进录像);录像放完时返回false
+static bool ReadTickInput(void)
+{
+    ReplayFrame frame;
+    if (g_replay.mode == REPLAY_PLAY)
+    {
+        if (!Replay_ReadFrame(&g_replay, &frame)) return false;
+        Replay_CheckSync(&g_replay, &frame, Rng_Checksum(&g_rng), Simulation_StateHash(&g_simulation));
+        UnpackGameControls(frame.buttons);
+        g_weaponChoice = (enum WeaponChoice)frame.action;
+        g_mouseWorld = (SDL_FPoint){frame.mouseX, frame.mouseY};
+        g_camera->zoom = frame.zoom;
+        return true;
+    }
+
+    if (g_renderer) g_mouseWorld = Camera_GetMouseWorldPosition(g_camera, g_renderer);
+    if (g_replay.mode == REPLAY_RECORD)
+    {
+        frame = (ReplayFrame){PackGameControls(), (Uint8)g_weaponChoice, 0, g_mouseWorld.x, g_mouseWorld.y, g_camera->zoom, Rng_Checksum(&g_rng), Simulation_StateHash(&g_simulation)};
+        Replay_WriteFrame(&g_replay, &frame);
+    }
+    return true;
+}
+
+// 执行选择的武器升级;做出了选择时关闭选择界面(回放时选择来自录像,界面和实际游戏时一样关闭)
+static void ApplyWeaponChoice(enum WeaponChoice choice)
+{
+    if (choice != WEAPON_CHOICE_NONE) select = false;
+    Bullet oldBullet;
+    switch (choice)
+    {
+    case WEAPON_CHOICE_HEAD_BULLET:
+        g_playerCharacter->headGun.bullet = selectedBullet;
+        break;
+    case WEAPON_CHOICE_HEAD_GUN:
+        oldBullet = g_playerCharacter->headGun.bullet;
+        g_playerCharacter->headGun = selectedGun;
+        g_playerCharacter->headGun.bullet = oldBullet;
+        break;
+    case WEAPON_CHOICE_TAIL_BULLET:
+        g_playerCharacter->tailGun.bullet = selectedBullet;
+        break;
+    case WEAPON_CHOICE_TAIL_GUN:
+        oldBullet = g_playerCharacter->tailGun.bullet;
+        g_playerCharacter->tailGun = selectedGun;
+        g_playerCharacter->tailGun.bullet = oldBullet;
+        break;
+    default:
+        break;
+    }
+}
+
+// 回放结束:打印耗时和结果,随机数不同步时返回失败(录像可以当作回归测试)
+static SDL_AppResult FinishReplay(const char *reason)
+{
+    Uint64 ticks = g_simulation.tickCount;
+    double seconds = (SDL_GetPerformanceCounter() - g_replayStartCounter) / (double)SDL_GetPerformanceFrequency();
+    double msPerCount = 1000.0 / (double)SDL_GetPerformanceFrequency() / (double)SDL_max(ticks, 1);
+    printf("回放结束(%s): %llu个逻辑帧, 用时%.3f秒, %.1f逻辑帧/秒, %.4f毫秒/逻辑帧\n", reason, (unsigned long long)ticks, seconds, seconds > 0 ? ticks / seconds : 0.0, ticks ? seconds * 1000.0 / ticks : 0.0);
+    for (int phase = 0; phase < SIM_PHASE_COUNT; phase++)
+    {
+        printf("  %-10s %.4f毫秒/逻辑帧\n", Simulation_PhaseName((SimulationPhase)phase), g_simulation.phaseTime[phase] * msPerCount);
+    }
+    printf("分数: %d, 玩家位置: (%.3f, %.3f), 随机数校验值: %08x, 状态哈希: %08x\n", g_simulation.score, g_playerCharacter->body[0].x, g_playerCharacter->body[0].y, (unsigned)Rng_Checksum(&g_rng), (unsigned)Simulation_StateHash(&g_simulation));
+
+    bool synced = g_replay.desyncFrame < 0;
+    if (synced)
+        printf("回放和录像一致\n");
+    else
+        printf("回放不同步: 第%lld个逻辑帧的随机数状态或游戏状态和录像不一致\n", (long long)g_replay.desyncFrame);
+    Replay_End(&g_replay);
+    return synced ? SDL_APP_SUCCESS : SDL_APP_FAILURE;
 }
 
 SDL_AppResult GamePlayScene_Event(SDL_Event *event)
 {
+    // 回放时输入全部来自录像,只处理退出
+    if (g_replay.mode == REPLAY_PLAY)
+    {
+        if (event->type == SDL_EVENT_QUIT || (event->type == SDL_EVENT_KEY_DOWN && event->key.key == SDLK_ESCAPE))
+        {
+            return FinishReplay("中途退出");
+        }
+        return SDL_APP_CONTINUE;
+    }
+
     switch (event->type)
     {
     case SDL_EVENT_QUIT:
@@ -588,6 +879,12 @@ SDL_AppResult GamePlayScene_Event(SDL_Event *event)
             return SDL_APP_CONTINUE;
         }
 
+#ifdef ENABLE_PROFILER
+        // 性能分析:F1显示叠加图,F2导出最近几秒的Chrome trace
+        if (event->key.key == SDLK_F1) g_showProfiler = !g_showProfiler;
+        if (event->key.key == SDLK_F2) Profiler_WriteChromeTrace(PROFILER_TRACE_PATH, DEFALUT_PROFILER_DUMP_SECONDS);
+#endif
+
         // 相机控制
         if (event->key.key == SDLK_UP) g_gameControls.cameraMoveUP = true;
         if (event->key.key == SDLK_DOWN) g_gameControls.cameraMoveDown = true;
@@ -621,14 +918,12 @@ SDL_AppResult GamePlayScene_Event(SDL_Event *event)
         {
             if (PointInRect(event->button.x, event->button.y, (SDL_FRect){SCREEN_WIDTH * 0.25f - 150, SCREEN_HEIGHT * 0.75f - 100, 300, 200}))
             {
-                g_playerCharacter->headGun.bullet = selectedBullet;
+                g_weaponChoice = WEAPON_CHOICE_HEAD_BULLET;
                 select = false;
             }
             else if (PointInRect(event->button.x, event->button.y, (SDL_FRect){SCREEN_WIDTH * 0.75f - 150, SCREEN_HEIGHT * 0.75f - 100, 300, 200}))
             {
-                Bullet oldBullet = g_playerCharacter->headGun.bullet;
-                g_playerCharacter->headGun = selectedGun;
-                g_playerCharacter->headGun.bullet = oldBullet;
+                g_weaponChoice = WEAPON_CHOICE_HEAD_GUN;
                 select = false;
             }
         }
@@ -636,14 +931,12 @@ SDL_AppResult GamePlayScene_Event(SDL_Event *event)
         {
             if (PointInRect(event->button.x, event->button.y, (SDL_FRect){SCREEN_WIDTH * 0.25f - 150, SCREEN_HEIGHT * 0.75f - 100, 300, 200}))
             {
-                g_playerCharacter->tailGun.bullet = selectedBullet;
+                g_weaponChoice = WEAPON_CHOICE_TAIL_BULLET;
                 select = false;
             }
             else if (PointInRect(event->button.x, event->button.y, (SDL_FRect){SCREEN_WIDTH * 0.75f - 150, SCREEN_HEIGHT * 0.75f - 100, 300, 200}))
             {
-                Bullet oldBullet = g_playerCharacter->tailGun.bullet;
-                g_playerCharacter->tailGun = selectedGun;
-                g_playerCharacter->tailGun.bullet = oldBullet;
+                g_weaponChoice = WEAPON_CHOICE_TAIL_GUN;
                 select = false;
             }
         }
@@ -674,15 +967,23 @@ SDL_AppResult GamePlayScene_Event(SDL_Event *event)
 
 SDL_AppResult GamePlayScene_Update(void)
 {
-    // 使用帧控制器进行逻辑更新
+    // 使用帧控制器进行逻辑更新(不限速回放时不看时间,每次执行固定数量的逻辑帧)
     int updates = FrameController_Update(&g_frameController);
-
-    // 记录游戏时间
-    now = SDL_GetPerformanceCounter();
-    playSceneTime = (now - start) / (float)SDL_GetPerformanceFrequency();
+    if (g_unthrottled) updates = g_headless ? REPLAY_HEADLESS_TICKS_PER_ITERATE : 1;
 
     for (int i = 0; i < updates; i++)
     {
+        // 这个逻辑帧的输入(回放时来自录像),上一帧选择的武器在这里生效
+        if (!ReadTickInput()) return FinishReplay("录像放完");
+        ApplyWeaponChoice(g_weaponChoice);
+        g_weaponChoice = WEAPON_CHOICE_NONE;
+
+        // 游戏时间按逻辑帧数计算,和机器快慢无关(回放时刷怪和升级的时机完全相同)
+        playSceneTime = g_simulation.tickCount / (float)LOGIC_FRAME_RATE;
+
+        // 渲染在这一帧开始和结束时的相机位置之间插值
+        Camera_SavePrevious(g_camera);
+
         // 摄像机移动处理(for debug)
         if (g_gameControls.cameraMoveUP) Camera_Move(g_camera, 0, 50);
         if (g_gameControls.cameraMoveDown) Camera_Move(g_camera, 0, -50);
@@ -690,66 +991,19 @@ SDL_AppResult GamePlayScene_Update(void)
         if (g_gameControls.cameraMoveRight) Camera_Move(g_camera, 50, 0);
         // 摄像机跟随玩家
         Camera_Move(g_camera, (g_playerCharacter->body[0].x - g_camera->x) * 0.02, (g_playerCharacter->body[0].y - g_camera->y) * 0.02);
-        // 更新玩家角色
-        if (g_playerCharacter)
-        {
-            if (g_gameControls.moveForward)
-            {
-                if (g_gameControls.turnLeft) Character_turn_left(g_playerCharacter);
-                if (g_gameControls.turnRight) Character_turn_right(g_playerCharacter);
-                Character_speed_add(g_playerCharacter, 2);
-            }
-            else
-            {
-                if (g_playerCharacter->speed > 0) Character_speed_add(g_playerCharacter, -5);
-                if (g_playerCharacter->speed < 0) Character_speed_set(g_playerCharacter, 0);
-            }
-
-            // 射击
-            if (g_playerCharacter->haveHeadGun) Gun_Try_Shoot(&g_playerCharacter->headGun, &g_bulletPool, g_gameControls.headShoot);
-            if (g_playerCharacter->haveTailGun) Gun_Try_Shoot(&g_playerCharacter->tailGun, &g_bulletPool, g_gameControls.tailShoot);
-        }
-
-        for (int i = 0; i < g_playerCharacter->bodyCount; i++)
-        {
-            AABBBox bodyBox = {g_playerCharacter->body[i].x - g_playerCharacter->body[i].radius, g_playerCharacter->body[i].x + g_playerCharacter->body[i].radius, g_playerCharacter->body[i].y - g_playerCharacter->body[i].radius, g_playerCharacter->body[i].y + g_playerCharacter->body[i].radius};
-            if (AABBBoxCollision(bodyBox, wallUpBox))
-            {
-                g_playerCharacter->body[i].y -= g_playerCharacter->body[i].radius * 0.5f;
-            }
-            if (AABBBoxCollision(bodyBox, wallDownBox))
-            {
-                g_playerCharacter->body[i].y += g_playerCharacter->body[i].radius * 0.5f;
-            }
-            if (AABBBoxCollision(bodyBox, wallLeftBox))
-            {
-                g_playerCharacter->body[i].x += g_playerCharacter->body[i].radius * 0.5f;
-            }
-            if (AABBBoxCollision(bodyBox, wallRightBox))
-            {
-                g_playerCharacter->body[i].x -= g_playerCharacter->body[i].radius * 0.5f;
-            }
-        }
-        // 敌人ai:面朝玩家
-
-        for (int i = 1; i < g_characterPool.size; i++)
-        {
-            Vector enemyToPlayer = vector_get(g_characterPool.characters[i]->body[0].x, g_characterPool.characters[i]->body[0].y, g_playerCharacter->body[0].x, g_playerCharacter->body[0].y);
-            Character_turn_to_vector(g_characterPool.characters[i], enemyToPlayer);
-        }
-
-        // 更新所有角色
-        CharacterPool_Update(&g_characterPool);
-
-        // 更新所有子弹
-        BulletPool_Update(&g_bulletPool, &g_characterPool);
-
-        // 检查所有怪物角色血量
-        CharacterPool_Check_Enemy_HP(&g_characterPool, &score);
+        // 执行一个逻辑帧(玩家操作,敌人ai,角色,子弹,计分)
+        SimulationInput input = {g_gameControls.moveForward, g_gameControls.turnLeft, g_gameControls.turnRight, g_gameControls.headShoot, g_gameControls.tailShoot};
+        Simulation_Tick(&g_simulation, &input);
 
         // 检查游戏结束条件（示例：玩家生命值低于0）
         if (g_playerCharacter && g_playerCharacter->HP <= 0)
         {
+            if (g_replay.mode == REPLAY_PLAY)
+            {
+                // 录像里还有剩下的帧说明玩家死得比录制时早
+                if (g_replay.cursor != g_replay.header.frameCount && g_replay.desyncFrame < 0) g_replay.desyncFrame = g_replay.cursor;
+                return FinishReplay("玩家死亡");
+            }
             ChangeScene(SCENE_GAME_OVER);
             break;
         }
@@ -771,13 +1025,16 @@ SDL_AppResult GamePlayScene_Update(void)
             lastSpawnTime = playSceneTime;
         }
 
-        // 升级武器
+        // 升级武器(每10秒的最后0.2秒显示选择界面,进入时随机一次候选)
+        float previousTime = playSceneTime - 1.0f / LOGIC_FRAME_RATE;
         if (fmodf(playSceneTime, 10) >= 9.8)
         {
             select = true;
-            srand(time(NULL));
-            enum BulletType BulletRand = rand() % 3;
-            enum GunType GunRand = rand() % 3;
+        }
+        if (fmodf(playSceneTime, 10) >= 9.8 && (previousTime < 0 || fmodf(previousTime, 10) < 9.8))
+        {
+            enum BulletType BulletRand = Rng_Int(&g_rng, 3);
+            enum GunType GunRand = Rng_Int(&g_rng, 3);
             if (BulletRand == AMMO)
             {
                 selectedBullet = ammo;
@@ -814,51 +1071,71 @@ SDL_AppResult GamePlayScene_Update(void)
 static void DrawCameraViewRectBorder(const Camera *camera);
 void GamePlayScene_Render(void)
 {
+    // 在上一个逻辑帧和当前逻辑帧之间插值,渲染帧率高于逻辑帧率时画面也是连续的
+    float alpha = g_unthrottled ? 1.0f : FrameController_GetAlpha(&g_frameController);
+    Camera renderCamera = Camera_Interpolate(g_camera, alpha);
+    Camera *camera = &renderCamera;
+
     // 清除屏幕
     SDL_SetRenderDrawColor(g_renderer, 30, 30, 40, 255);
     SDL_RenderClear(g_renderer);
 
-    // 渲染网格背景
-    RenderGridBackground(g_camera, g_renderer);
-
     // 世界批次
     if (g_worldBatch)
     {
-        // 先清空批次
+        // 先清空批次,再取本帧的相机快照
         Batch_Clear(g_worldBatch);
+        Batch_SetCamera(g_worldBatch, camera);
+
+        // 剔除:视野矩形整帧只算一次,静态几何,角色和子弹都只画视野里的
+        AABBBox viewBox = Rect_To_AABBBox(Camera_GetViewRect(camera));
 
-        // 渲染墙
-        Polygon_DrawRect(g_worldBatch, wallUpRect.x, wallUpRect.y, wallUpRect.w, wallUpRect.h, white, g_camera);
-        Polygon_DrawRect(g_worldBatch, wallDownRect.x, wallDownRect.y, wallDownRect.w, wallDownRect.h, white, g_camera);
-        Polygon_DrawRect(g_worldBatch, wallLeftRect.x, wallLeftRect.y, wallLeftRect.w, wallLeftRect.h, white, g_camera);
-        Polygon_DrawRect(g_worldBatch, wallRightRect.x, wallRightRect.y, wallRightRect.w, wallRightRect.h, white, g_camera);
+        // 渲染网格背景和静态几何(墙,地面装饰),最先写入,画在角色下面
+        PROFILE_BEGIN(PROFILE_ZONE_BACKGROUND);
+        RenderGridBackground(camera, g_worldBatch);
+        StaticGeometry_AppendToBatch(g_staticLayer, g_worldBatch, viewBox);
+        PROFILE_END(PROFILE_ZONE_BACKGROUND);
+
+        PROFILE_BEGIN(PROFILE_ZONE_GEOMETRY);
+        CharacterPool_Cull(&g_characterPool, viewBox);
+        BulletPool_Cull(&g_bulletPool, viewBox, alpha);
 
         // 渲染所有角色
-        CharacterPool_Render(&g_characterPool, g_renderer, g_camera, g_worldBatch);
+        CharacterPool_RenderParallel(&g_characterPool, g_renderer, camera, g_worldBatch, g_jobSystem, g_chunkBatches, g_chunkBatchCount, alpha);
 
         // 渲染子弹
-        BulletPool_Render(&g_bulletPool, g_renderer, g_camera, g_worldBatch);
+        BulletPool_Render(&g_bulletPool, g_renderer, camera, g_worldBatch, alpha);
 
         //  渲染相机视野边框（for debug）
-        // DrawCameraViewRectBorder(g_camera);
+        // DrawCameraViewRectBorder(camera);
+        PROFILE_END(PROFILE_ZONE_GEOMETRY);
         // 渲染批次
+        PROFILE_BEGIN(PROFILE_ZONE_BATCH_RENDER);
         if (!Batch_IsEmpty(g_worldBatch))
         {
             Batch_Render(g_worldBatch, g_renderer);
         }
+        PROFILE_END(PROFILE_ZONE_BATCH_RENDER);
     }
     // 渲染角色拥有的枪
-    if (g_playerCharacter->haveHeadGun)
+    PROFILE_BEGIN(PROFILE_ZONE_SPRITES);
+    Character playerView;
+    node playerBody[MAX_BODY_COUNT];
+    CharacterPool_Interpolate(&g_characterPool, 0, alpha, &playerView, playerBody);
+    if (playerView.haveHeadGun)
     {
-        Gun_render(&g_playerCharacter->headGun, g_playerCharacter->headGun.direction, g_renderer, g_camera, textures);
+        Gun_render(&playerView.headGun, playerView.headGun.direction, camera);
     }
-    if (g_playerCharacter->haveTailGun)
+    if (playerView.haveTailGun)
     {
-        Gun_render(&g_playerCharacter->tailGun, g_playerCharacter->tailGun.direction, g_renderer, g_camera, textures);
+        Gun_render(&playerView.tailGun, playerView.tailGun.direction, camera);
     }
+    FlushSprites();
+    PROFILE_END(PROFILE_ZONE_SPRITES);
     // 渲染UI（游戏内UI）
     if (g_uiManager)
     {
+        PROFILE_BEGIN(PROFILE_ZONE_UI);
         UI_BeginDraw(g_uiManager);
 
         SDL_FRect HPRect = {10, SCREEN_HEIGHT - 40, 390, 30};
@@ -878,60 +1155,79 @@ void GamePlayScene_Render(void)
             UI_DrawRect(g_uiManager, SCREEN_WIDTH * 0.75f - 150, SCREEN_HEIGHT * 0.75f - 100, 300, 200, white, true);
             // 渲染选择纹理
             // 子弹用文本代替
-            Draw_Text(g_font, g_renderer, (SDL_FRect){SCREEN_WIDTH * 0.25f - 150, SCREEN_HEIGHT * 0.75f - 300, 300, 50}, darkGold, selectedBulletName[selectedBulletType]);
+            DrawHUDText((SDL_FRect){SCREEN_WIDTH * 0.25f - 150, SCREEN_HEIGHT * 0.75f - 300, 300, 50}, darkGold, selectedBulletName[selectedBulletType]);
             // 枪的纹理
 
-            Render_Texture(g_renderer, textures[selectedGun.type], (SDL_FPoint){SCREEN_WIDTH * 0.75f, SCREEN_HEIGHT * 0.75f - 300}, 0, 10);
+            SpriteAtlas_Draw(g_spriteAtlas, g_spriteBatch, selectedGun.type, (SDL_FPoint){SCREEN_WIDTH * 0.75f, SCREEN_HEIGHT * 0.75f - 300}, 0, 10);
         }
 
         UI_EndDraw(g_uiManager, g_renderer);
+        FlushSprites(); // 选择界面的枪画在信息框上面
+        PROFILE_END(PROFILE_ZONE_UI);
 
         // 绘制文本
+        PROFILE_BEGIN(PROFILE_ZONE_TEXT);
         if (g_playerCharacter)
         {
             // 绘制血条文本
             char buffer[64];
             snprintf(buffer, sizeof(buffer), "%d/%d", (int)roundf(g_playerCharacter->HP), (int)roundf(g_playerCharacter->maxHP));
-            Draw_Text(g_font, g_renderer, HPtextRect, white, buffer);
+            DrawHUDText(HPtextRect, white, buffer);
 
             // 绘制分数文本
-            snprintf(buffer, sizeof(buffer), "Score: %d", score);
-            Draw_Text(g_font, g_renderer, scoreTextRect, white, buffer);
+            snprintf(buffer, sizeof(buffer), "Score: %d", g_simulation.score);
+            DrawHUDText(scoreTextRect, white, buffer);
 
             // 绘制时间文本
             snprintf(buffer, sizeof(buffer), "Survival Time: %.2fs", playSceneTime);
-            Draw_Text(g_font, g_renderer, timeTextRect, white, buffer);
+            DrawHUDText(timeTextRect, white, buffer);
 
             // 渲染选择信息
             if (select)
             {
                 // 左边:子弹
                 snprintf(buffer, sizeof(buffer), "Bullet");
-                Draw_Text(g_font, g_renderer, (SDL_FRect){SCREEN_WIDTH * 0.25f - 150, SCREEN_HEIGHT * 0.75f - 100, 300, 50}, darkGold, buffer);
+                DrawHUDText((SDL_FRect){SCREEN_WIDTH * 0.25f - 150, SCREEN_HEIGHT * 0.75f - 100, 300, 50}, darkGold, buffer);
                 snprintf(buffer, sizeof(buffer), "damage:%.1f", selectedBullet.damage);
-                Draw_Text(g_font, g_renderer, (SDL_FRect){SCREEN_WIDTH * 0.25f - 150, SCREEN_HEIGHT * 0.75f - 50, 300, 50}, darkGold, buffer);
+                DrawHUDText((SDL_FRect){SCREEN_WIDTH * 0.25f - 150, SCREEN_HEIGHT * 0.75f - 50, 300, 50}, darkGold, buffer);
                 snprintf(buffer, sizeof(buffer), "radius:%.1f", selectedBullet.radius);
-                Draw_Text(g_font, g_renderer, (SDL_FRect){SCREEN_WIDTH * 0.25f - 150, SCREEN_HEIGHT * 0.75f, 300, 50}, darkGold, buffer);
+                DrawHUDText((SDL_FRect){SCREEN_WIDTH * 0.25f - 150, SCREEN_HEIGHT * 0.75f, 300, 50}, darkGold, buffer);
                 snprintf(buffer, sizeof(buffer), "fly-speed:%.1f", selectedBullet.speed);
-                Draw_Text(g_font, g_renderer, (SDL_FRect){SCREEN_WIDTH * 0.25f - 150, SCREEN_HEIGHT * 0.75f + 50, 300, 50}, darkGold, buffer);
+                DrawHUDText((SDL_FRect){SCREEN_WIDTH * 0.25f - 150, SCREEN_HEIGHT * 0.75f + 50, 300, 50}, darkGold, buffer);
 
                 // 右边:枪
                 snprintf(buffer, sizeof(buffer), "Gun");
-                Draw_Text(g_font, g_renderer, (SDL_FRect){SCREEN_WIDTH * 0.75f - 150, SCREEN_HEIGHT * 0.75f - 100, 300, 50}, darkGold, buffer);
+                DrawHUDText((SDL_FRect){SCREEN_WIDTH * 0.75f - 150, SCREEN_HEIGHT * 0.75f - 100, 300, 50}, darkGold, buffer);
                 snprintf(buffer, sizeof(buffer), "RPM:%.1f", 60.0f * (LOGIC_FRAME_RATE / selectedGun.shootDelay));
-                Draw_Text(g_font, g_renderer, (SDL_FRect){SCREEN_WIDTH * 0.75f - 150, SCREEN_HEIGHT * 0.75f - 50, 300, 50}, darkGold, buffer);
+                DrawHUDText((SDL_FRect){SCREEN_WIDTH * 0.75f - 150, SCREEN_HEIGHT * 0.75f - 50, 300, 50}, darkGold, buffer);
                 snprintf(buffer, sizeof(buffer), "damage-factor:%.1f", selectedGun.damageK);
-                Draw_Text(g_font, g_renderer, (SDL_FRect){SCREEN_WIDTH * 0.75f - 150, SCREEN_HEIGHT * 0.75f, 300, 50}, darkGold, buffer);
+                DrawHUDText((SDL_FRect){SCREEN_WIDTH * 0.75f - 150, SCREEN_HEIGHT * 0.75f, 300, 50}, darkGold, buffer);
             }
             // Draw_Text(g_font, g_renderer, (SDL_FRect){SCREEN_WIDTH * 0.25f - 300, SCREEN_HEIGHT * 0.75f - 100, 300, 200}, darkGold, buffer);
         }
+        PROFILE_END(PROFILE_ZONE_TEXT);
     }
 
     // 渲染FPS
+    PROFILE_BEGIN(PROFILE_ZONE_TEXT);
     FrameController_UpdateFPS(&g_frameController, &FPS, &UPS);
     RenderFPSDisplay(FPS, UPS);
+    RenderBatchStatsDisplay(g_worldBatch);
+    RenderCullStatsDisplay();
+    PROFILE_END(PROFILE_ZONE_TEXT);
+
+#ifdef ENABLE_PROFILER
+    RenderProfilerOverlay();
+#endif
 
+    // 这一帧所有的文字(HUD,FPS,性能分析图例)一次画完
+    PROFILE_BEGIN(PROFILE_ZONE_TEXT);
+    FlushText();
+    PROFILE_END(PROFILE_ZONE_TEXT);
+
+    PROFILE_BEGIN(PROFILE_ZONE_PRESENT);
     SDL_RenderPresent(g_renderer);
+    PROFILE_END(PROFILE_ZONE_PRESENT);
     FrameController_AddRenderCount(&g_frameController);
 }
 
@@ -1032,6 +1328,7 @@ void GameOverScene_Render(void)
     if (g_worldBatch)
     {
         Batch_Clear(g_worldBatch);
+        Batch_SetCamera(g_worldBatch, g_camera);
 
         // 绘制红色背景方块
         for (int i = 0; i < 10; i++)
@@ -1067,34 +1364,35 @@ void GameOverScene_Render(void)
     {
 
         // 游戏结束文字
-        Draw_Text(g_font, g_renderer, gameoverTitleRect, white, "GAME OVER");
+        DrawHUDText(gameoverTitleRect, white, "GAME OVER");
 
         // 重新开始文字
-        Draw_Text(g_font, g_renderer, restartRect, white, "RESTART (R)");
+        DrawHUDText(restartRect, white, "RESTART (R)");
 
         // 主菜单文字
-        Draw_Text(g_font, g_renderer, toMeneRect, white, "MENU (M)");
+        DrawHUDText(toMeneRect, white, "MENU (M)");
 
         char buffer[32];
         // 分数文字
         SDL_FRect scoreTextRect = {SCREEN_WIDTH / 2.0f - 150, 200, 300, 60};
-        snprintf(buffer, sizeof(buffer), "Score: %d", score);
-        Draw_Text(g_font, g_renderer, scoreTextRect, white, buffer);
+        snprintf(buffer, sizeof(buffer), "Score: %d", g_simulation.score);
+        DrawHUDText(scoreTextRect, white, buffer);
         // 最高分
         snprintf(buffer, sizeof(buffer), "MAX Score: %d", maxScore);
         scoreTextRect.y += 50;
-        Draw_Text(g_font, g_renderer, scoreTextRect, white, buffer);
+        DrawHUDText(scoreTextRect, white, buffer);
 
         // 存活时间文字
         SDL_FRect TimeTextRect = {SCREEN_WIDTH / 2.0f - 150, 300, 300, 60};
 
         snprintf(buffer, sizeof(buffer), "Survival Time: %.1fs", playSceneTime);
-        Draw_Text(g_font, g_renderer, TimeTextRect, white, buffer);
+        DrawHUDText(TimeTextRect, white, buffer);
     }
 
     // 渲染FPS
     FrameController_UpdateFPS(&g_frameController, &FPS, &UPS);
     RenderFPSDisplay(FPS, UPS);
+    FlushText();
 
     SDL_RenderPresent(g_renderer);
     FrameController_AddRenderCount(&g_frameController);
@@ -1116,18 +1414,56 @@ static void DrawCameraViewRectBorder(const Camera *camera)
     Polygon_DrawLine(g_worldBatch, viewBox.maxX, viewBox.minY, viewBox.maxX, viewBox.maxY, 10.0f / camera->zoom, borderColor, camera);
 }
 
-// SDL3应用程序初始化回调
-SDL_AppResult SDL_AppInit(void **appstate, int argc, char *argv[])
+// 解析命令行:
+//   --record <文件>   每局游戏的输入和随机数种子录制到文件
+//   --replay <文件>   启动后直接回放录像,结束时打印每个逻辑帧的耗时
+//   --unthrottled     回放时不按逻辑帧率等待,尽快执行
+//   --headless        回放时不创建窗口,不渲染(包含--unthrottled)
+static bool ParseCommandLine(int argc, char *argv[])
 {
-    printf("=== 应用程序初始化开始 ===\n");
+    const char *replayPath = NULL;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+            g_recordPath = argv[++i];
+        else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+            replayPath = argv[++i];
+        else if (strcmp(argv[i], "--headless") == 0)
+            g_headless = g_unthrottled = true;
+        else if (strcmp(argv[i], "--unthrottled") == 0)
+            g_unthrottled = true;
+        else
+            printf("忽略未知的命令行参数: %s\n", argv[i]);
+    }
 
-    // 初始化SDL
-    if (!SDL_Init(SDL_INIT_VIDEO))
+    if (!replayPath)
     {
-        printf("SDL初始化失败: %s\n", SDL_GetError());
-        return SDL_APP_FAILURE;
+        if (g_headless || g_unthrottled) printf("--headless和--unthrottled只在回放时有效\n");
+        g_headless = g_unthrottled = false;
+        return true;
+    }
+    if (g_recordPath)
+    {
+        printf("回放时不能同时录制,忽略--record\n");
+        g_recordPath = NULL;
+    }
+    if (!Replay_BeginPlay(&g_replay, replayPath)) return false;
+    if (g_replay.header.tickRate != LOGIC_FRAME_RATE)
+    {
+        printf("录像的逻辑帧率(%u)和游戏(%d)不一致\n", (unsigned)g_replay.header.tickRate, LOGIC_FRAME_RATE);
+        Replay_End(&g_replay);
+        return false;
     }
+    printf("回放录像: %s (%u个逻辑帧%s)\n", replayPath, (unsigned)g_replay.header.frameCount, g_headless ? ", 无窗口" : "");
 
+    // 回放直接进入游戏场景
+    ChangeScene(SCENE_GAME_PLAY);
+    return true;
+}
+
+// 创建窗口,渲染器,字体和图集
+static SDL_AppResult InitGraphics(void)
+{
     // 创建窗口
     g_window = SDL_CreateWindow("场景切换演示 - 主菜单 | 游戏 | 失败画面", SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_RESIZABLE);
     if (!g_window)
@@ -1163,77 +1499,135 @@ SDL_AppResult SDL_AppInit(void **appstate, int argc, char *argv[])
     // 加载字体
     g_font = TTF_OpenFont("../font/fengwujiutian.ttf", 16);
 
-    // 加载纹理
-    shortGunTexture = IMG_LoadTexture(g_renderer, "../image/shortGun.png");
-    longGunTexture = IMG_LoadTexture(g_renderer, "../image/longGun.png");
-    sniperGunTexture = IMG_LoadTexture(g_renderer, "../image/sniperGun.png");
-    SDL_SetTextureScaleMode(shortGunTexture, SDL_SCALEMODE_NEAREST);
-    SDL_SetTextureScaleMode(longGunTexture, SDL_SCALEMODE_NEAREST);
-    SDL_SetTextureScaleMode(sniperGunTexture, SDL_SCALEMODE_NEAREST);
-    textures[0] = shortGunTexture;
-    textures[1] = longGunTexture;
-    textures[2] = sniperGunTexture;
+    // 用字体生成字形图集,所有文字写进同一个批次
+    g_glyphAtlas = GlyphAtlas_Create(g_renderer, g_font);
+    if (g_glyphAtlas)
+    {
+        g_textBatch = Batch_CreateRenderer(1024, 1536);
+        Batch_SetTexture(g_textBatch, g_glyphAtlas->texture);
+    }
+
+    // 加载纹理(拼成一张图集,所有精灵一次drawcall)
+    g_spriteAtlas = SpriteAtlas_Load(g_renderer, spritePaths, SDL_arraysize(spritePaths));
+    if (g_spriteAtlas)
+    {
+        g_spriteBatch = Batch_CreateRenderer(256, 384);
+        Batch_SetTexture(g_spriteBatch, g_spriteAtlas->texture);
+    }
+
+    return SDL_APP_CONTINUE;
+}
+
+// SDL3应用程序初始化回调
+SDL_AppResult SDL_AppInit(void **appstate, int argc, char *argv[])
+{
+    printf("=== 应用程序初始化开始 ===\n");
+
+    // 解析命令行
+    if (!ParseCommandLine(argc, argv)) return SDL_APP_FAILURE;
+
+    // 初始化SDL(无窗口回放时不需要视频子系统)
+    if (!SDL_Init(g_headless ? 0 : SDL_INIT_VIDEO))
+    {
+        printf("SDL初始化失败: %s\n", SDL_GetError());
+        return SDL_APP_FAILURE;
+    }
+
+    // 创建窗口,渲染器,字体和图集(无窗口回放时跳过)
+    if (!g_headless)
+    {
+        SDL_AppResult result = InitGraphics();
+        if (result != SDL_APP_CONTINUE) return result;
+    }
+
+    // 设置圆的细分误差(单位圆表在第一次画圆时算好)
+    Polygon_SetCircleMaxError(DEFALUT_CIRCLE_MAX_ERROR);
 
     // 创建墙矩行
-    wallUpRect = AABBBox_To_Rect(wallUpBox);
-    wallDownRect = AABBBox_To_Rect(wallDownBox);
-    wallLeftRect = AABBBox_To_Rect(wallLeftBox);
-    wallRightRect = AABBBox_To_Rect(wallRightBox);
+    wallUpRect = AABBBox_To_Rect(wallBoxes[SIM_WALL_UP]);
+    wallDownRect = AABBBox_To_Rect(wallBoxes[SIM_WALL_DOWN]);
+    wallLeftRect = AABBBox_To_Rect(wallBoxes[SIM_WALL_LEFT]);
+    wallRightRect = AABBBox_To_Rect(wallBoxes[SIM_WALL_RIGHT]);
+
+    // 静态几何图层
+    BuildStaticGeometry();
+    BuildFlowField();
 
     // 初始化角色池
-    CharacterPool_Init(&g_characterPool, 100);
+    CharacterPool_Init(&g_characterPool, DEFALUT_CHARACTER_POOL_CAPACITY);
 
     // 初始化子弹池
     BulletPool_Init(&g_bulletPool);
 
+    // 创建线程池和并行渲染用的批次(失败时退化为串行渲染)
+    g_jobSystem = JobSystem_Create(-1);
+    if (g_jobSystem)
+    {
+        int chunkCount = JobSystem_GetWorkerCount(g_jobSystem) * RENDER_CHUNKS_PER_WORKER;
+        for (g_chunkBatchCount = 0; g_chunkBatchCount < chunkCount; g_chunkBatchCount++)
+        {
+            g_chunkBatches[g_chunkBatchCount] = Batch_CreateRenderer(1024, 3072);
+            if (!g_chunkBatches[g_chunkBatchCount]) break;
+        }
+        printf("线程池: %d个线程, 角色渲染分为%d段\n", JobSystem_GetWorkerCount(g_jobSystem), g_chunkBatchCount);
+    }
+
     // 设置窗口位置
-    SDL_SetWindowPosition(g_window, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED);
+    if (g_window) SDL_SetWindowPosition(g_window, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED);
 
     // 加载最高分
     FILE *fp = fopen("../data/data.txt", "r");
     if (fp)
     {
         fscanf(fp, "%d", &maxScore);
+        fclose(fp);
     }
-    fclose(fp);
 
     printf("=== 应用程序初始化成功 ===\n");
-    printf("初始场景: 主菜单\n");
+    printf("初始场景: %s\n", g_replay.mode == REPLAY_PLAY ? "回放" : "主菜单");
 
     return SDL_APP_CONTINUE;
 }
-// SDL3事件处理回调
-SDL_AppResult SDL_AppEvent(void *appstate, SDL_Event *event)
+// 处理场景切换(事件回调和主循环里都会调用,无窗口回放时没有事件)
+static SDL_AppResult ProcessSceneChange(void)
 {
-    // 处理场景切换
-    if (g_sceneChanged)
-    {
-        // 检查退出场景
-        if (g_currentScene == SCENE_EXIT)
-        {
-            return SDL_APP_SUCCESS;
-        }
+    if (!g_sceneChanged) return SDL_APP_CONTINUE;
 
-        // 调用旧场景的清理函数
-        if (g_scenes[g_currentScene].cleanup)
-        {
-            g_scenes[g_currentScene].cleanup();
-        }
+    // 检查退出场景
+    if (g_currentScene == SCENE_EXIT)
+    {
+        return SDL_APP_SUCCESS;
+    }
 
-        // 切换到新场景
-        g_currentScene = g_nextScene;
-        g_sceneChanged = false;
+    // 调用旧场景的清理函数
+    if (g_scenes[g_currentScene].cleanup)
+    {
+        g_scenes[g_currentScene].cleanup();
+    }
 
-        // 调用新场景的初始化函数
-        if (g_scenes[g_currentScene].init)
-        {
-            g_scenes[g_currentScene].init();
-        }
+    // 切换到新场景
+    g_currentScene = g_nextScene;
+    g_sceneChanged = false;
 
-        char sceneName[3][10] = {"主菜单", "游戏", "失败"};
-        SDL_Log("切换到场景: %s", sceneName[g_scenes[g_currentScene].id]);
+    // 调用新场景的初始化函数
+    if (g_scenes[g_currentScene].init)
+    {
+        g_scenes[g_currentScene].init();
     }
 
+    char sceneName[3][10] = {"主菜单", "游戏", "失败"};
+    SDL_Log("切换到场景: %s", sceneName[g_scenes[g_currentScene].id]);
+
+    return SDL_APP_CONTINUE;
+}
+
+// SDL3事件处理回调
+SDL_AppResult SDL_AppEvent(void *appstate, SDL_Event *event)
+{
+    // 处理场景切换
+    SDL_AppResult result = ProcessSceneChange();
+    if (result != SDL_APP_CONTINUE) return result;
+
     // 将事件传递给当前场景
     if (g_scenes[g_currentScene].handle_event)
     {
@@ -1246,6 +1640,13 @@ SDL_AppResult SDL_AppEvent(void *appstate, SDL_Event *event)
 // SDL3主循环回调
 SDL_AppResult SDL_AppIterate(void *appstate)
 {
+    // 每次迭代(逻辑帧+渲染)是性能分析里的一帧
+    PROFILE_FRAME();
+
+    // 处理场景切换
+    SDL_AppResult sceneResult = ProcessSceneChange();
+    if (sceneResult != SDL_APP_CONTINUE) return sceneResult;
+
     // 检查退出场景
     if (g_currentScene == SCENE_EXIT)
     {
@@ -1262,8 +1663,8 @@ SDL_AppResult SDL_AppIterate(void *appstate)
         }
     }
 
-    // 渲染当前场景
-    if (g_scenes[g_currentScene].render)
+    // 渲染当前场景(无窗口回放时不渲染)
+    if (!g_headless && g_scenes[g_currentScene].render)
     {
         g_scenes[g_currentScene].render();
     }
@@ -1277,10 +1678,22 @@ void SDL_AppQuit(void *appstate, SDL_AppResult reason)
     printf("=== 应用程序清理开始 ===\n");
     printf("退出原因: %s\n", (reason == SDL_APP_SUCCESS) ? "正常退出" : "初始化失败");
 
+    // 结束录制或回放(中途关闭窗口时也回写录像的帧数)
+    Replay_End(&g_replay);
+
     // 清理资源
+    JobSystem_Destroy(g_jobSystem);
+    for (int i = 0; i < g_chunkBatchCount; i++)
+    {
+        Batch_DestroyRenderer(g_chunkBatches[i]);
+    }
     if (g_uiManager) UI_DestroyManager(g_uiManager);
     if (g_worldBatch) Batch_DestroyRenderer(g_worldBatch);
+    if (g_staticLayer) StaticGeometry_Destroy(g_staticLayer);
+    if (g_flowField) FlowField_Destroy(g_flowField);
     if (g_camera) Camera_Destroy(g_camera);
+    if (g_textBatch) Batch_DestroyRenderer(g_textBatch);
+    if (g_glyphAtlas) GlyphAtlas_Destroy(g_glyphAtlas);
     if (g_font) TTF_CloseFont(g_font);
 
     // 销毁所有角色和子弹
@@ -1289,9 +1702,8 @@ void SDL_AppQuit(void *appstate, SDL_AppResult reason)
 
     // 销毁SDL资源
     // 销毁纹理
-    SDL_DestroyTexture(shortGunTexture);
-    SDL_DestroyTexture(longGunTexture);
-    SDL_DestroyTexture(sniperGunTexture);
+    if (g_spriteBatch) Batch_DestroyRenderer(g_spriteBatch);
+    if (g_spriteAtlas) SpriteAtlas_Destroy(g_spriteAtlas);
     if (g_renderer)
     {
         SDL_DestroyRenderer(g_renderer);
@@ -2,128 +2,141 @@
 #include "vector.h"
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
 
-// ========== 批处理渲染函数 ==========
+// ========== 圆的细分 ==========
 
-// 绘制单个三角形到批次
-void Polygon_DrawTriangle(BatchRenderer *batch, float x1, float y1, float x2, float y2, float x3, float y3, SDL_FColor color, const Camera *camera)
+// 单位圆表:段数为n的单位圆存放在g_unitCircle[g_unitCircleStart[n]]开始的n个点
+#define UNIT_CIRCLE_TABLE_SIZE ((CIRCLE_MAX_SEGMENTS * (CIRCLE_MAX_SEGMENTS + 1) - (CIRCLE_MIN_SEGMENTS - 1) * CIRCLE_MIN_SEGMENTS) / 2)
+static SDL_FPoint g_unitCircle[UNIT_CIRCLE_TABLE_SIZE];
+static int g_unitCircleStart[CIRCLE_MAX_SEGMENTS + 1];
+static SDL_InitState g_unitCircleInit; // 单位圆表只计算一次(多个线程同时第一次使用时其它线程等它算完)
+static float g_circleSegmentK = 0.0f;  // 段数 = ceil(K * sqrt(屏幕半径)),0表示还没设置(使用默认误差)
+
+// 误差为maxError时的K
+// 半径r的圆分成n段时,弧和弦的最大距离为 r*(1-cos(π/n)) <= r*(π/n)^2/2,令它不超过maxError得到 n >= π*sqrt(r/(2*maxError))
+static float Polygon_SegmentK(float maxError)
 {
-    if (!batch) return;
+    if (maxError <= 0.0f) maxError = DEFALUT_CIRCLE_MAX_ERROR;
+    return (float)M_PI / sqrtf(2.0f * maxError);
+}
 
-    // 关键：将世界坐标转换为屏幕坐标
-    SDL_FPoint p1, p2, p3;
+// 第一次使用时计算单位圆表,没有设置过最大误差时使用默认误差;之后只读,工作线程可以同时读取
+static void Polygon_InitUnitCircle(void)
+{
+    if (!SDL_ShouldInit(&g_unitCircleInit)) return;
 
-    if (camera)
+    int start = 0;
+    for (int n = CIRCLE_MIN_SEGMENTS; n <= CIRCLE_MAX_SEGMENTS; n++)
     {
-        // 使用相机进行坐标转换
-        p1 = Camera_WorldToScreen(camera, x1, y1);
-        p2 = Camera_WorldToScreen(camera, x2, y2);
-        p3 = Camera_WorldToScreen(camera, x3, y3);
-    }
-    else
-    {
-        // 如果没有相机，假设已经是屏幕坐标
-        p1.x = x1;
-        p1.y = y1;
-        p2.x = x2;
-        p2.y = y2;
-        p3.x = x3;
-        p3.y = y3;
+        g_unitCircleStart[n] = start;
+        for (int i = 0; i < n; i++)
+        {
+            double angle = 2.0 * M_PI * i / n;
+            g_unitCircle[start + i] = (SDL_FPoint){(float)cos(angle), (float)sin(angle)};
+        }
+        start += n;
     }
+    if (g_circleSegmentK <= 0.0f) g_circleSegmentK = Polygon_SegmentK(DEFALUT_CIRCLE_MAX_ERROR);
+    SDL_SetInitialized(&g_unitCircleInit, true);
+}
 
-    // 将转换后的屏幕坐标添加到批次
-    // 注意：Batch_AddTriangle 期望的是屏幕坐标！
-    Batch_AddTriangle(batch, &p1, &p2, &p3, color);
+// 设置圆的最大误差(只改变K)
+void Polygon_SetCircleMaxError(float maxError)
+{
+    g_circleSegmentK = Polygon_SegmentK(maxError);
 }
 
-// 绘制凸多边形到批次（自动三角化）
-void Polygon_DrawConvex(BatchRenderer *batch, const SDL_FPoint *points, int pointCount, SDL_FColor color, const Camera *camera)
+// 按屏幕上的半径选择段数
+int Polygon_CircleSegments(float screenRadius)
 {
-    if (!batch || !points || pointCount < 3) return;
+    Polygon_InitUnitCircle();
+    if (!(screenRadius > 0.0f)) return CIRCLE_MIN_SEGMENTS;
 
-    // 凸多边形三角化：使用三角形扇形
-    // 从第一个顶点开始，创建三角形 (0, i, i+1)
+    float n = ceilf(g_circleSegmentK * sqrtf(screenRadius));
+    if (n < CIRCLE_MIN_SEGMENTS) return CIRCLE_MIN_SEGMENTS;
+    if (n > CIRCLE_MAX_SEGMENTS) return CIRCLE_MAX_SEGMENTS;
+    return (int)n;
+}
 
-    // 为转换后的点分配内存
-    SDL_FPoint *transformedPoints = (SDL_FPoint *)malloc(sizeof(SDL_FPoint) * pointCount);
-    if (!transformedPoints) return;
+// 获取单位圆
+const SDL_FPoint *Polygon_UnitCircle(int segments)
+{
+    Polygon_InitUnitCircle();
+    if (segments < CIRCLE_MIN_SEGMENTS) segments = CIRCLE_MIN_SEGMENTS;
+    if (segments > CIRCLE_MAX_SEGMENTS) segments = CIRCLE_MAX_SEGMENTS;
+    return &g_unitCircle[g_unitCircleStart[segments]];
+}
 
-    // 转换所有点到屏幕坐标
-    if (camera)
-    {
-        for (int i = 0; i < pointCount; i++)
-        {
-            transformedPoints[i] = Camera_WorldToScreen(camera, points[i].x, points[i].y);
-        }
-    }
-    else
+// 把一个圆写进预留好的空间
+void Polygon_WriteCircle(SDL_Vertex *vertices, int *indices, int baseVertex, float centerX, float centerY, float radius, int segments, SDL_FColor color)
+{
+    const SDL_FPoint *unit = Polygon_UnitCircle(segments);
+    Batch_WriteVertex(&vertices[0], centerX, centerY, color);
+    for (int i = 0; i < segments; i++)
     {
-        // 如果没有相机，直接复制
-        memcpy(transformedPoints, points, sizeof(SDL_FPoint) * pointCount);
+        Batch_WriteVertex(&vertices[i + 1], centerX + unit[i].x * radius, centerY + unit[i].y * radius, color);
+        indices[i * 3] = baseVertex;
+        indices[i * 3 + 1] = baseVertex + 1 + i;
+        indices[i * 3 + 2] = baseVertex + 1 + (i + 1 < segments ? i + 1 : 0);
     }
+}
 
-    // 添加三角形到批次（三角形扇形）
-    for (int i = 1; i < pointCount - 1; i++)
-    {
-        Batch_AddTriangle(batch, &transformedPoints[0], &transformedPoints[i], &transformedPoints[i + 1], color);
-    }
+// ========== 批处理渲染函数 ==========
+
+// 绘制单个三角形到批次
+void Polygon_DrawTriangle(BatchRenderer *batch, float x1, float y1, float x2, float y2, float x3, float y3, SDL_FColor color, const Camera *camera)
+{
+    if (!batch) return;
+    Batch_UseCamera(batch, camera);
 
-    // 清理
-    free(transformedPoints);
+    SDL_FPoint p1 = {x1, y1};
+    SDL_FPoint p2 = {x2, y2};
+    SDL_FPoint p3 = {x3, y3};
+    Batch_AddTriangle(batch, &p1, &p2, &p3, color);
 }
 
-// 绘制矩形到批次（由2个三角形组成）
+// 绘制凸多边形到批次（自动三角化）
+void Polygon_DrawConvex(BatchRenderer *batch, const SDL_FPoint *points, int pointCount, SDL_FColor color, const Camera *camera)
+{
+    if (!batch || !points || pointCount < 3) return;
+    Batch_UseCamera(batch, camera);
+
+    // 凸多边形三角化：以第一个顶点为中心的三角形扇形 (0, i, i+1)
+    Batch_AddFan(batch, &points[0], &points[1], pointCount - 1, false, color);
+}
+
+// 绘制矩形到批次（4个顶点,2个三角形）
 void Polygon_DrawRect(BatchRenderer *batch, float x, float y, float width, float height, SDL_FColor color, const Camera *camera)
 {
     if (!batch) return;
+    Batch_UseCamera(batch, camera);
 
     // 矩形的四个顶点（世界坐标）
-    SDL_FPoint worldPoints[4] = {
-        {x, y},                  // 左上角
-        {x + width, y},          // 右上角
-        {x + width, y + height}, // 右下角
-        {x, y + height}          // 左下角
-    };
-
-    // 第一个三角形：左上角 -> 右上角 -> 右下角
-    Polygon_DrawTriangle(batch, worldPoints[0].x, worldPoints[0].y, worldPoints[1].x, worldPoints[1].y, worldPoints[2].x, worldPoints[2].y, color, camera);
-
-    // 第二个三角形：左上角 -> 右下角 -> 左下角
-    Polygon_DrawTriangle(batch, worldPoints[0].x, worldPoints[0].y, worldPoints[2].x, worldPoints[2].y, worldPoints[3].x, worldPoints[3].y, color, camera);
+    SDL_FPoint p1 = {x, y};                  // 左上角
+    SDL_FPoint p2 = {x + width, y};          // 右上角
+    SDL_FPoint p3 = {x + width, y + height}; // 右下角
+    SDL_FPoint p4 = {x, y + height};         // 左下角
+    Batch_AddQuad(batch, &p1, &p2, &p3, &p4, color);
 }
 
 // 绘制圆形到批次（使用三角形扇形）
-void Polygon_DrawCircle(BatchRenderer *batch, float centerX, float centerY, float radius, int segments, SDL_FColor color, const Camera *camera)
+void Polygon_DrawCircle(BatchRenderer *batch, float centerX, float centerY, float radius, SDL_FColor color, const Camera *camera)
 {
-    if (!batch || segments < 3) return;
-
-    // 生成圆形顶点（世界坐标）
-    SDL_FPoint *circlePoints = (SDL_FPoint *)malloc(sizeof(SDL_FPoint) * segments);
-    if (!circlePoints) return;
-
-    float angleStep = 2.0f * M_PI / segments;
+    if (!batch || radius <= 0.0f) return;
+    Batch_UseCamera(batch, camera);
 
-    for (int i = 0; i < segments; i++)
-    {
-        float angle = i * angleStep;
-        circlePoints[i].x = centerX + cosf(angle) * radius;
-        circlePoints[i].y = centerY + sinf(angle) * radius;
-    }
+    // 段数由屏幕上的半径决定
+    int segments = Polygon_CircleSegments(camera ? radius * camera->zoom : radius);
 
-    // 使用三角形扇形绘制圆形
-    for (int i = 0; i < segments; i++)
-    {
-        int next = (i + 1) % segments;
-
-        // 每个三角形：圆心 -> 当前点 -> 下一个点
-        Polygon_DrawTriangle(batch, centerX, centerY, circlePoints[i].x, circlePoints[i].y, circlePoints[next].x, circlePoints[next].y, color, camera);
-    }
-
-    free(circlePoints);
+    // 圆心 + 首尾相连的边缘点:segments+1个顶点,一次预留后直接写入批次
+    BatchSpan span;
+    if (!Batch_Reserve(batch, segments + 1, segments * 3, &span)) return;
+    Polygon_WriteCircle(span.vertices, span.indices, span.baseVertex, centerX, centerY, radius, segments, color);
 }
 
-// 绘制粗线(矩行);width表示线的实际宽度
-four_SDL_FPoint Polygon_DrawLine(BatchRenderer *batch, float x1, float y1, float x2, float y2, float width, SDL_FColor color, const Camera *camera)
+// 计算粗线的四个角:p1左,p1右,p2左,p2右
+static four_SDL_FPoint Polygon_LineCorners(float x1, float y1, float x2, float y2, float width)
 {
     float halfWidth = width / 2.0f;
     Vector direction = vector_get(x1, y1, x2, y2);
@@ -135,34 +148,202 @@ four_SDL_FPoint Polygon_DrawLine(BatchRenderer *batch, float x1, float y1, float
     SDL_FPoint p1r = Get_FPoint_From_parametric_equation(p1, verticalDirection, halfWidth);
     SDL_FPoint p2l = Get_FPoint_From_parametric_equation(p2, verticalDirection_counter, halfWidth);
     SDL_FPoint p2r = Get_FPoint_From_parametric_equation(p2, verticalDirection, halfWidth);
-    Polygon_DrawTriangle(batch, p1l.x, p1l.y, p1r.x, p1r.y, p2l.x, p2l.y, color, camera);
-    Polygon_DrawTriangle(batch, p2l.x, p2l.y, p2r.x, p2r.y, p1r.x, p1r.y, color, camera);
     four_SDL_FPoint ret = {p1l, p1r, p2l, p2r};
     return ret;
 }
+
+// 绘制粗线(矩行);width表示线的实际宽度
+four_SDL_FPoint Polygon_DrawLine(BatchRenderer *batch, float x1, float y1, float x2, float y2, float width, SDL_FColor color, const Camera *camera)
+{
+    four_SDL_FPoint ret = Polygon_LineCorners(x1, y1, x2, y2, width);
+    if (!batch) return ret;
+    Batch_UseCamera(batch, camera);
+
+    // 顶点顺序:p1右,p2右,p2左,p1左(对角线为p1右-p2左)
+    Batch_AddQuad(batch, &ret.p2, &ret.p4, &ret.p3, &ret.p1, color);
+    return ret;
+}
+
+// 按顺序绘制粗线数组;每段线4个顶点,连接处直接引用相邻两段已有的顶点
+// 整条线一次预留:n段线共4n个顶点,6n个线段索引加6(n-1)个连接处索引
 void Polygon_DrawLines(BatchRenderer *batch, SDL_FPoint *pointList, int pointCount, float width, SDL_FColor color, const Camera *camera)
 {
-    SDL_FPoint lastp2l;
-    SDL_FPoint lastp2r;
-    for (int i = 0; i < pointCount - 1; i++)
+    if (!batch || !pointList || pointCount < 2) return;
+    Batch_UseCamera(batch, camera);
+
+    int segmentCount = pointCount - 1;
+    BatchSpan span;
+    if (!Batch_Reserve(batch, segmentCount * 4, segmentCount * 6 + (segmentCount - 1) * 6, &span)) return;
+
+    SDL_Vertex *v = span.vertices;
+    int *idx = span.indices;
+    for (int i = 0; i < segmentCount; i++)
     {
-        four_SDL_FPoint points = Polygon_DrawLine(batch, pointList[i].x, pointList[i].y, pointList[i + 1].x, pointList[i + 1].y, width, color, camera);
-        // 以下为平滑连接处的操作
-        SDL_FPoint p1l = points.p1;
-        SDL_FPoint p1r = points.p2;
-        SDL_FPoint p2l = points.p3;
-        SDL_FPoint p2r = points.p4;
+        four_SDL_FPoint points = Polygon_LineCorners(pointList[i].x, pointList[i].y, pointList[i + 1].x, pointList[i + 1].y, width);
+        // 顶点顺序:base+0 p1右,base+1 p2右,base+2 p2左,base+3 p1左(对角线为p1右-p2左)
+        int base = span.baseVertex + i * 4;
+        Batch_WriteVertex(v++, points.p2.x, points.p2.y, color);
+        Batch_WriteVertex(v++, points.p4.x, points.p4.y, color);
+        Batch_WriteVertex(v++, points.p3.x, points.p3.y, color);
+        Batch_WriteVertex(v++, points.p1.x, points.p1.y, color);
+        *idx++ = base;
+        *idx++ = base + 1;
+        *idx++ = base + 2;
+        *idx++ = base;
+        *idx++ = base + 2;
+        *idx++ = base + 3;
+        // 以下为平滑连接处的操作:上一段的p2左右和这一段的p1左/p1右
         if (i != 0)
         {
-            Polygon_DrawTriangle(batch, lastp2l.x, lastp2l.y, lastp2r.x, lastp2r.y, p1l.x, p1l.y, color, camera);
-            Polygon_DrawTriangle(batch, lastp2l.x, lastp2l.y, lastp2r.x, lastp2r.y, p1r.x, p1r.y, color, camera);
-            // SDL_Log("%f %f ,%f %f ,%f %f\n", lastp2l.x, lastp2l.y, lastp2r.x, lastp2r.y, p1l.x, p1l.y);
+            int lastBase = base - 4;
+            *idx++ = lastBase + 2;
+            *idx++ = lastBase + 1;
+            *idx++ = base + 3;
+            *idx++ = lastBase + 2;
+            *idx++ = lastBase + 1;
+            *idx++ = base;
         }
-        lastp2l = p2l;
-        lastp2r = p2r;
     }
 }
 
+// 往预留的空间里写一个轴对齐矩形(4个顶点,6个索引)
+static void Polygon_WriteAxisRect(SDL_Vertex *vertices, int *indices, int baseVertex, float minX, float minY, float maxX, float maxY, SDL_FColor color)
+{
+    Batch_WriteVertex(&vertices[0], minX, minY, color);
+    Batch_WriteVertex(&vertices[1], maxX, minY, color);
+    Batch_WriteVertex(&vertices[2], maxX, maxY, color);
+    Batch_WriteVertex(&vertices[3], minX, maxY, color);
+    indices[0] = baseVertex;
+    indices[1] = baseVertex + 1;
+    indices[2] = baseVertex + 2;
+    indices[3] = baseVertex;
+    indices[4] = baseVertex + 2;
+    indices[5] = baseVertex + 3;
+}
+
+// 绘制覆盖相机视野的网格
+float Polygon_DrawGrid(BatchRenderer *batch, float cellSize, float minScreenSpacing, float lineWidth, SDL_FColor color, const Camera *camera)
+{
+    if (!batch || !camera || cellSize <= 0.0f || camera->zoom <= 0.0f) return 0.0f;
+    Batch_UseCamera(batch, camera);
+
+    // 按缩放选择网格间距(翻倍后的线仍然和原来的网格对齐)
+    float spacing = cellSize;
+    while (spacing * camera->zoom < minScreenSpacing) spacing *= 2.0f;
+
+    // 相机视野(世界坐标),对齐到网格
+    float halfViewWidth = camera->screenWidth * 0.5f / camera->zoom;
+    float halfViewHeight = camera->screenHeight * 0.5f / camera->zoom;
+    float startX = SDL_floorf((camera->x - halfViewWidth) / spacing) * spacing;
+    float endX = SDL_ceilf((camera->x + halfViewWidth) / spacing) * spacing;
+    float startY = SDL_floorf((camera->y - halfViewHeight) / spacing) * spacing;
+    float endY = SDL_ceilf((camera->y + halfViewHeight) / spacing) * spacing;
+    int columns = (int)((endX - startX) / spacing + 0.5f) + 1;
+    int rows = (int)((endY - startY) / spacing + 0.5f) + 1;
+
+    // 所有线一次预留
+    BatchSpan span;
+    if (!Batch_Reserve(batch, (columns + rows) * 4, (columns + rows) * 6, &span)) return spacing;
+
+    const float halfWidth = lineWidth * 0.5f / camera->zoom;
+    int line = 0;
+    for (int i = 0; i < columns; i++, line++)
+    {
+        float x = startX + i * spacing;
+        Polygon_WriteAxisRect(&span.vertices[line * 4], &span.indices[line * 6], span.baseVertex + line * 4, x - halfWidth, startY, x + halfWidth, endY, color);
+    }
+    for (int i = 0; i < rows; i++, line++)
+    {
+        float y = startY + i * spacing;
+        Polygon_WriteAxisRect(&span.vertices[line * 4], &span.indices[line * 6], span.baseVertex + line * 4, startX, y - halfWidth, endX, y + halfWidth, color);
+    }
+    return spacing;
+}
+
+// 三角形abc的有向面积的两倍(逆时针为正)
+static float Polygon_Cross(SDL_FPoint a, SDL_FPoint b, SDL_FPoint c) { return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x); }
+
+// 点p是否在逆时针三角形abc内(包括边上)
+static bool Polygon_PointInTriangle(SDL_FPoint p, SDL_FPoint a, SDL_FPoint b, SDL_FPoint c) { return Polygon_Cross(a, b, p) >= 0 && Polygon_Cross(b, c, p) >= 0 && Polygon_Cross(c, a, p) >= 0; }
+
+// 耳切法三角化:每次找一个凸顶点,它和相邻两点组成的三角形里没有其它剩余顶点,就把这个三角形切下来
+int Polygon_Triangulate(const SDL_FPoint *points, int pointCount, int *outIndices)
+{
+    if (!points || !outIndices || pointCount < 3) return 0;
+
+    int *remaining = (int *)malloc(sizeof(int) * pointCount);
+    if (!remaining) return 0;
+
+    // 统一按逆时针处理:顺时针的多边形倒序遍历
+    float area = 0.0f;
+    for (int i = 0; i < pointCount; i++)
+    {
+        const SDL_FPoint a = points[i], b = points[(i + 1) % pointCount];
+        area += a.x * b.y - b.x * a.y;
+    }
+    for (int i = 0; i < pointCount; i++)
+    {
+        remaining[i] = area >= 0 ? i : pointCount - 1 - i;
+    }
+
+    int count = pointCount;
+    int triangleCount = 0;
+    int i = 0;
+    int misses = 0; // 连续没有找到耳朵的次数,转满一圈说明多边形不合法(自相交或重复点)
+    while (count > 3 && misses < count)
+    {
+        int prev = remaining[(i + count - 1) % count];
+        int curr = remaining[i];
+        int next = remaining[(i + 1) % count];
+        const SDL_FPoint a = points[prev], b = points[curr], c = points[next];
+
+        float turn = Polygon_Cross(a, b, c);
+        bool isEar = turn > 0; // 凸顶点
+        for (int j = 0; isEar && j < count; j++)
+        {
+            int other = remaining[j];
+            if (other == prev || other == curr || other == next) continue;
+            if (Polygon_PointInTriangle(points[other], a, b, c)) isEar = false;
+        }
+
+        if (turn != 0 && !isEar)
+        {
+            i = (i + 1) % count;
+            misses++;
+            continue;
+        }
+
+        // 切下耳朵;三点共线时只去掉中间的点,不生成三角形
+        if (isEar)
+        {
+            outIndices[triangleCount * 3] = prev;
+            outIndices[triangleCount * 3 + 1] = curr;
+            outIndices[triangleCount * 3 + 2] = next;
+            triangleCount++;
+        }
+
+        // 删除这个顶点
+        memmove(&remaining[i], &remaining[i + 1], sizeof(int) * (count - i - 1));
+        count--;
+        i %= count;
+        misses = 0;
+    }
+
+    if (count == 3)
+    {
+        outIndices[triangleCount * 3] = remaining[0];
+        outIndices[triangleCount * 3 + 1] = remaining[1];
+        outIndices[triangleCount * 3 + 2] = remaining[2];
+        triangleCount++;
+    }
+    else
+    {
+        triangleCount = 0;
+    }
+    free(remaining);
+    return triangleCount;
+}
+
 // 立即渲染多边形（不使用批处理，保持兼容）
 void Polygon_RenderImmediate(SDL_Renderer *renderer, const SDL_FPoint *points, int pointCount, SDL_FColor color, const Camera *camera)
 {
@@ -0,0 +1,31 @@
+#include "presets.h"
+
+// 角色预设
+// 蛇1:
+const int SNAKE1_bodyCount = SNAKE1_BODY_COUNT;
+const float SNAKE1_radiusList[SNAKE1_BODY_COUNT] = {30, 30, 25, 25, 25, 25, 25, 25, 25, 20, 20, 15, 15, 15, 10, 10};
+const float SNAKE1_distanceList[SNAKE1_BODY_COUNT] = {60, 60, 60, 60, 60, 60, 60, 60, 60, 60, 60, 60, 60, 60, 60, 60};
+const float SNAKE1_flexibility[SNAKE1_BODY_COUNT] = {45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f};
+// 蜥蜴
+const int LIZARD_bodyCount = LIZARD_BODY_COUNT;
+const float LIZARD_radiusList[LIZARD_BODY_COUNT] = {55, 31, 58, 59, 60, 60, 48, 29, 18, 11, 8, 8, 8, 8, 8, 8, 8, 8, 7, 7, 7};
+const float LIZARD_distanceList[LIZARD_BODY_COUNT] = {42, 37, 29, 30, 33, 33, 28, 18, 14, 14, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12};
+const float LIZARD_flexibility[LIZARD_BODY_COUNT] = {45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f, 45.0f};
+const Chain3 LIZARD_legs[2] = {{{0, 0}, {0.0}, {0.0}, 40.0f, 20.0f, 20.0f, 70.0f, 35.0f}, {{0, 0}, {0.0}, {0.0}, 23.0f, 23.0f, 23.0f, 80.0f, 45.0f}};
+
+// 颜色预设
+const SDL_FColor darkGold = {0.85f, 0.64f, 0.13f, 1.0f};
+const SDL_FColor lightSkyBlue = {5.29f, 0.81f, 0.98f, 1.0f};
+const SDL_FColor purple = {0.58f, 0.0f, 0.83f, 1.0f};
+const SDL_FColor white = {1.0f, 1.0f, 1.0f, 1.0f};
+
+// 子弹预设
+const Bullet defalutBullet = {5, 5, 5, (SDL_FColor){1.0f, 1.0f, 1.0f, 1.0f}, 0, (Vector){0, 0}};
+const Bullet ammo = {10, 20, 10, darkGold, 0, (Vector){0, 0}};
+const Bullet bubble = {100, 5, 25, lightSkyBlue, 0, (Vector){0, 0}};
+const Bullet sniperBullet = {75, 40, 15, purple, 0, (Vector){0, 0}};
+
+// 枪预设
+const Gun shortGun = {SHORTGUN, defalutBullet, 90, 1.25, 0};
+const Gun longGun = {LONGGUN, defalutBullet, 20, 1.0, 0};
+const Gun sniperGun = {SNIPERGUN, defalutBullet, 150, 2.0, 0};
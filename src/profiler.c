@@ -0,0 +1,178 @@
+#include "profiler.h"
+#include <stdio.h>
+#include <string.h>
+
+// 区段信息:名称,分类(逻辑或渲染),颜色
+typedef struct
+{
+    const char *name;
+    const char *category;
+    SDL_FColor color;
+} ProfileZoneInfo;
+
+static const ProfileZoneInfo g_zoneInfo[PROFILE_ZONE_COUNT] = {
+    {"ai", "update", {0.55f, 0.55f, 0.95f, 1.0f}},
+    {"spine", "update", {0.25f, 0.45f, 1.0f, 1.0f}},
+    {"collision", "update", {0.1f, 0.8f, 0.9f, 1.0f}},
+    {"legs", "update", {0.2f, 0.9f, 0.5f, 1.0f}},
+    {"bullets", "update", {0.95f, 0.85f, 0.2f, 1.0f}},
+    {"cleanup", "update", {0.7f, 0.6f, 0.4f, 1.0f}},
+    {"background", "render", {0.45f, 0.45f, 0.5f, 1.0f}},
+    {"geometry", "render", {1.0f, 0.5f, 0.1f, 1.0f}},
+    {"batch render", "render", {1.0f, 0.2f, 0.2f, 1.0f}},
+    {"sprites", "render", {0.9f, 0.3f, 0.7f, 1.0f}},
+    {"ui", "render", {0.6f, 0.3f, 0.9f, 1.0f}},
+    {"text", "render", {0.95f, 0.95f, 0.95f, 1.0f}},
+    {"present", "render", {0.3f, 0.3f, 0.3f, 1.0f}},
+};
+
+// 分析器状态(只在主线程访问)
+static struct
+{
+    ProfileEvent events[PROFILER_MAX_EVENTS]; // 环形缓冲区
+    Uint64 eventCount;                        // 一共记录过的事件数(写入位置取模)
+    ProfileFrame frames[PROFILER_HISTORY_FRAMES];
+    int frameCount;       // 一共记录过的帧数(写入位置取模)
+    ProfileFrame current; // 正在记录的帧
+    Uint64 stackStart[PROFILER_MAX_DEPTH];
+    Uint8 stackZone[PROFILER_MAX_DEPTH];
+    int depth;
+} g_profiler;
+
+// 开始一个区段
+void Profiler_Begin(ProfileZone zone)
+{
+    if (g_profiler.depth >= PROFILER_MAX_DEPTH) return;
+    g_profiler.stackZone[g_profiler.depth] = (Uint8)zone;
+    g_profiler.stackStart[g_profiler.depth] = SDL_GetPerformanceCounter();
+    g_profiler.depth++;
+}
+
+// 结束一个区段,记录事件并累计到当前帧
+void Profiler_End(ProfileZone zone)
+{
+    Uint64 end = SDL_GetPerformanceCounter();
+    if (g_profiler.depth <= 0) return;
+    g_profiler.depth--;
+    if (g_profiler.stackZone[g_profiler.depth] != zone)
+    {
+        SDL_Log("Profiler: zone %s ended without matching begin", Profiler_GetZoneName(zone));
+        return;
+    }
+
+    ProfileEvent *event = &g_profiler.events[g_profiler.eventCount % PROFILER_MAX_EVENTS];
+    event->start = g_profiler.stackStart[g_profiler.depth];
+    event->end = end;
+    event->zone = (Uint8)zone;
+    event->depth = (Uint8)g_profiler.depth;
+    g_profiler.eventCount++;
+
+    g_profiler.current.zoneTime[zone] += end - event->start;
+}
+
+// 标记一帧结束,同时开始下一帧(第一次调用只开始一帧)
+void Profiler_FrameMark(void)
+{
+    Uint64 now = SDL_GetPerformanceCounter();
+    if (g_profiler.current.start != 0)
+    {
+        g_profiler.current.end = now;
+        g_profiler.frames[g_profiler.frameCount % PROFILER_HISTORY_FRAMES] = g_profiler.current;
+        g_profiler.frameCount++;
+    }
+    memset(&g_profiler.current, 0, sizeof(ProfileFrame));
+    g_profiler.current.start = now;
+}
+
+// 已经记录的完整帧数
+int Profiler_GetFrameCount(void) { return SDL_min(g_profiler.frameCount, PROFILER_HISTORY_FRAMES); }
+
+// 获取最近的第framesAgo个完整帧
+const ProfileFrame *Profiler_GetFrame(int framesAgo)
+{
+    if (framesAgo < 0 || framesAgo >= Profiler_GetFrameCount()) return NULL;
+    return &g_profiler.frames[(g_profiler.frameCount - 1 - framesAgo) % PROFILER_HISTORY_FRAMES];
+}
+
+// 区段名称
+const char *Profiler_GetZoneName(ProfileZone zone)
+{
+    if (zone < 0 || zone >= PROFILE_ZONE_COUNT) return "unknown";
+    return g_zoneInfo[zone].name;
+}
+
+// 区段颜色
+SDL_FColor Profiler_GetZoneColor(ProfileZone zone)
+{
+    if (zone < 0 || zone >= PROFILE_ZONE_COUNT) return (SDL_FColor){1.0f, 1.0f, 1.0f, 1.0f};
+    return g_zoneInfo[zone].color;
+}
+
+// 性能计数器单位转毫秒
+float Profiler_ToMilliseconds(Uint64 ticks) { return (float)(ticks * 1000.0 / (double)SDL_GetPerformanceFrequency()); }
+
+// 性能计数器转trace里的微秒时间戳(相对于origin)
+static double Profiler_ToMicroseconds(Uint64 ticks, Uint64 origin) { return (ticks - origin) * 1000000.0 / (double)SDL_GetPerformanceFrequency(); }
+
+// 导出Chrome trace:每帧和每个区段都是一个完整事件("ph":"X"),按时间包含关系显示嵌套
+bool Profiler_WriteChromeTrace(const char *path, float seconds)
+{
+    if (!path) return false;
+    if (seconds <= 0) seconds = DEFALUT_PROFILER_DUMP_SECONDS;
+
+    Uint64 now = SDL_GetPerformanceCounter();
+    Uint64 window = (Uint64)(seconds * (double)SDL_GetPerformanceFrequency());
+    Uint64 from = now > window ? now - window : 0;
+
+    // 环形缓冲区里还保留着的事件范围
+    Uint64 firstEvent = g_profiler.eventCount > PROFILER_MAX_EVENTS ? g_profiler.eventCount - PROFILER_MAX_EVENTS : 0;
+    int frameCount = Profiler_GetFrameCount();
+
+    // 最早的时间作为时间戳原点
+    Uint64 origin = now;
+    for (int i = frameCount - 1; i >= 0; i--)
+    {
+        const ProfileFrame *frame = Profiler_GetFrame(i);
+        if (frame->start >= from)
+        {
+            origin = frame->start;
+            break;
+        }
+    }
+    for (Uint64 e = firstEvent; e < g_profiler.eventCount; e++)
+    {
+        const ProfileEvent *event = &g_profiler.events[e % PROFILER_MAX_EVENTS];
+        if (event->start >= from && event->start < origin) origin = event->start;
+    }
+
+    FILE *file = fopen(path, "w");
+    if (!file)
+    {
+        SDL_Log("Profiler: cannot open %s", path);
+        return false;
+    }
+
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"main\"}}");
+    int written = 0;
+    for (int i = frameCount - 1; i >= 0; i--)
+    {
+        const ProfileFrame *frame = Profiler_GetFrame(i);
+        if (frame->start < from) continue;
+        fprintf(file, ",\n{\"name\":\"frame\",\"cat\":\"frame\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}", Profiler_ToMicroseconds(frame->start, origin), Profiler_ToMicroseconds(frame->end, frame->start));
+        written++;
+    }
+    for (Uint64 e = firstEvent; e < g_profiler.eventCount; e++)
+    {
+        const ProfileEvent *event = &g_profiler.events[e % PROFILER_MAX_EVENTS];
+        if (event->start < from) continue;
+        const ProfileZoneInfo *info = &g_zoneInfo[event->zone];
+        fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}", info->name, info->category, Profiler_ToMicroseconds(event->start, origin), Profiler_ToMicroseconds(event->end, event->start));
+        written++;
+    }
+    fprintf(file, "\n]}\n");
+    fclose(file);
+
+    SDL_Log("Profiler: wrote %d events to %s", written, path);
+    return true;
+}
@@ -0,0 +1,98 @@
+#include "replay.h"
+#include <string.h>
+
+// 文件格式直接按结构体读写,这两个大小不能变
+_Static_assert(sizeof(ReplayHeader) == 24, "ReplayHeader大小改变会破坏录像格式");
+_Static_assert(sizeof(ReplayFrame) == 24, "ReplayFrame大小改变会破坏录像格式");
+
+// 开始录制
+bool Replay_BeginRecord(Replay *replay, const char *path, Uint64 seed, int tickRate)
+{
+    if (!replay || !path) return false;
+    memset(replay, 0, sizeof(Replay));
+    replay->desyncFrame = -1;
+
+    replay->file = fopen(path, "wb");
+    if (!replay->file)
+    {
+        fprintf(stderr, "录像文件创建失败: %s\n", path);
+        return false;
+    }
+    replay->header = (ReplayHeader){REPLAY_MAGIC, REPLAY_VERSION, (Uint32)tickRate, 0, seed};
+    if (fwrite(&replay->header, sizeof(ReplayHeader), 1, replay->file) != 1)
+    {
+        fprintf(stderr, "录像文件写入失败: %s\n", path);
+        fclose(replay->file);
+        replay->file = NULL;
+        return false;
+    }
+    replay->mode = REPLAY_RECORD;
+    return true;
+}
+
+// 打开录像准备回放
+bool Replay_BeginPlay(Replay *replay, const char *path)
+{
+    if (!replay || !path) return false;
+    memset(replay, 0, sizeof(Replay));
+    replay->desyncFrame = -1;
+
+    replay->file = fopen(path, "rb");
+    if (!replay->file)
+    {
+        fprintf(stderr, "录像文件打开失败: %s\n", path);
+        return false;
+    }
+    if (fread(&replay->header, sizeof(ReplayHeader), 1, replay->file) != 1 || replay->header.magic != REPLAY_MAGIC || replay->header.version != REPLAY_VERSION)
+    {
+        fprintf(stderr, "不是可以回放的录像文件: %s\n", path);
+        fclose(replay->file);
+        replay->file = NULL;
+        return false;
+    }
+    replay->mode = REPLAY_PLAY;
+    return true;
+}
+
+// 录制一帧
+bool Replay_WriteFrame(Replay *replay, const ReplayFrame *frame)
+{
+    if (!replay || replay->mode != REPLAY_RECORD || !frame) return false;
+    if (fwrite(frame, sizeof(ReplayFrame), 1, replay->file) != 1) return false;
+    replay->header.frameCount++;
+    return true;
+}
+
+// 回放一帧
+bool Replay_ReadFrame(Replay *replay, ReplayFrame *frame)
+{
+    if (!replay || replay->mode != REPLAY_PLAY || !frame) return false;
+    if (replay->cursor >= replay->header.frameCount) return false;
+    if (fread(frame, sizeof(ReplayFrame), 1, replay->file) != 1) return false;
+    replay->cursor++;
+    return true;
+}
+
+// 检查随机数校验值
+bool Replay_CheckSync(Replay *replay, const ReplayFrame *frame, Uint32 rngChecksum, Uint32 stateHash)
+{
+    if (!replay || !frame) return false;
+    if (frame->rngChecksum == rngChecksum && frame->stateHash == stateHash) return true;
+    if (replay->desyncFrame < 0) replay->desyncFrame = (Sint64)replay->cursor - 1;
+    return false;
+}
+
+// 结束录制或回放
+void Replay_End(Replay *replay)
+{
+    if (!replay || !replay->file) return;
+    if (replay->mode == REPLAY_RECORD)
+    {
+        // 回写帧数
+        fseek(replay->file, 0, SEEK_SET);
+        fwrite(&replay->header, sizeof(ReplayHeader), 1, replay->file);
+    }
+    fclose(replay->file);
+    replay->file = NULL;
+    replay->mode = REPLAY_OFF;
+}
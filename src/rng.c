@@ -0,0 +1,36 @@
+#include "rng.h"
+
+// 设置种子:先用splitmix64打散,避免相近的种子生成相近的序列,也避免状态为0
+void Rng_Seed(Rng *rng, Uint64 seed)
+{
+    if (!rng) return;
+    Uint64 z = seed + 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    z ^= z >> 31;
+    rng->state = z ? z : 0x9E3779B97F4A7C15ull;
+}
+
+// 下一个32位随机数
+Uint32 Rng_Next(Rng *rng)
+{
+    Uint64 x = rng->state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    rng->state = x;
+    return (Uint32)((x * 0x2545F4914F6CDD1Dull) >> 32);
+}
+
+// [0,n)的随机整数
+int Rng_Int(Rng *rng, int n)
+{
+    if (n <= 0) return 0;
+    return (int)(((Uint64)Rng_Next(rng) * (Uint64)n) >> 32);
+}
+
+// [0,1)的随机小数(取高24位,正好是float的精度)
+float Rng_Float(Rng *rng) { return (Rng_Next(rng) >> 8) * (1.0f / 16777216.0f); }
+
+// 当前状态的低32位
+Uint32 Rng_Checksum(const Rng *rng) { return rng ? (Uint32)rng->state : 0; }
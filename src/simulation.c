@@ -0,0 +1,198 @@
+#include "simulation.h"
+#include "profiler.h"
+#include <string.h>
+
+static const char *g_phaseNames[SIM_PHASE_COUNT] = {"player", "ai", "characters", "bullets", "cleanup"};
+
+// 初始化游戏逻辑
+void Simulation_Init(Simulation *sim, CharacterPool *characters, BulletPool *bullets, JobSystem *jobs)
+{
+    if (!sim) return;
+    memset(sim, 0, sizeof(Simulation));
+    sim->characters = characters;
+    sim->bullets = bullets;
+    sim->jobs = jobs;
+}
+
+// 设置四面墙
+void Simulation_SetWalls(Simulation *sim, const AABBBox walls[SIM_WALL_COUNT])
+{
+    if (!sim || !walls) return;
+    memcpy(sim->walls, walls, sizeof(sim->walls));
+    sim->haveWalls = true;
+}
+
+// 设置流场
+void Simulation_SetFlowField(Simulation *sim, FlowField *field)
+{
+    if (!sim) return;
+    sim->flowField = field;
+    FlowField_Invalidate(field);
+}
+
+// 获取玩家角色
+Character *Simulation_GetPlayer(const Simulation *sim)
+{
+    if (!sim || !sim->characters) return NULL;
+    return CharacterPool_Get(sim->characters, 0);
+}
+
+// 把一个32位值按字节混进FNV-1a哈希
+static Uint32 Simulation_HashWord(Uint32 hash, Uint32 word)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        hash ^= (word >> (i * 8)) & 0xFF;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// 游戏状态的哈希(浮点数按位参与,任何一位不同都会改变结果)
+Uint32 Simulation_StateHash(const Simulation *sim)
+{
+    Uint32 hash = 2166136261u;
+    if (!sim || !sim->characters) return hash;
+
+    const Character *player = Simulation_GetPlayer(sim);
+    if (player)
+    {
+        const float values[3] = {player->body[0].x, player->body[0].y, player->HP};
+        Uint32 bits[3];
+        memcpy(bits, values, sizeof(bits));
+        for (int i = 0; i < 3; i++) hash = Simulation_HashWord(hash, bits[i]);
+    }
+    hash = Simulation_HashWord(hash, (Uint32)sim->characters->size);
+    hash = Simulation_HashWord(hash, (Uint32)sim->score);
+    return hash;
+}
+
+// 清零计时
+void Simulation_ResetStats(Simulation *sim)
+{
+    if (!sim) return;
+    sim->tickCount = 0;
+    memset(sim->phaseTime, 0, sizeof(sim->phaseTime));
+}
+
+// 阶段名称
+const char *Simulation_PhaseName(SimulationPhase phase)
+{
+    if (phase < 0 || phase >= SIM_PHASE_COUNT) return "unknown";
+    return g_phaseNames[phase];
+}
+
+// 玩家操作,射击,撞墙后推回
+static void Simulation_UpdatePlayer(Simulation *sim, Character *player, const SimulationInput *input)
+{
+    if (input->moveForward)
+    {
+        if (input->turnLeft) Character_turn_left(player);
+        if (input->turnRight) Character_turn_right(player);
+        Character_speed_add(player, 2);
+    }
+    else
+    {
+        if (player->speed > 0) Character_speed_add(player, -5);
+        if (player->speed < 0) Character_speed_set(player, 0);
+    }
+
+    // 射击
+    if (player->haveHeadGun) Gun_Try_Shoot(&player->headGun, sim->bullets, input->headShoot);
+    if (player->haveTailGun) Gun_Try_Shoot(&player->tailGun, sim->bullets, input->tailShoot);
+
+    if (!sim->haveWalls) return;
+    for (int i = 0; i < player->bodyCount; i++)
+    {
+        node *n = &player->body[i];
+        AABBBox bodyBox = {n->x - n->radius, n->x + n->radius, n->y - n->radius, n->y + n->radius};
+        if (AABBBoxCollision(bodyBox, sim->walls[SIM_WALL_UP])) n->y -= n->radius * 0.5f;
+        if (AABBBoxCollision(bodyBox, sim->walls[SIM_WALL_DOWN])) n->y += n->radius * 0.5f;
+        if (AABBBoxCollision(bodyBox, sim->walls[SIM_WALL_LEFT])) n->x += n->radius * 0.5f;
+        if (AABBBoxCollision(bodyBox, sim->walls[SIM_WALL_RIGHT])) n->x -= n->radius * 0.5f;
+    }
+}
+
+// 敌人ai:按流场转向玩家,和玩家之间没有障碍(或者没有流场)时直接面朝玩家
+static void Simulation_UpdateAI(Simulation *sim, const Character *player)
+{
+    CharacterPool *pool = sim->characters;
+    SDL_FPoint target = {player->body[0].x, player->body[0].y};
+
+    // 流场由上一帧的任务和子弹同时算好,这里只在还没有算过时(第一帧或刚设置流场)同步计算
+    // 玩家这一帧走进了别的格子时继续用上一帧的流场,下一帧的任务会追上;直线可达的格子仍然直接朝玩家当前的位置走
+    if (sim->flowField && sim->flowField->targetCell < 0) FlowField_Update(sim->flowField, target);
+    for (int i = 1; i < pool->size; i++)
+    {
+        SDL_FPoint head = {pool->characters[i].body[0].x, pool->characters[i].body[0].y};
+        Vector direction;
+        if (!FlowField_Sample(sim->flowField, head, target, &direction))
+        {
+            direction = vector_get(head.x, head.y, target.x, target.y);
+        }
+        Character_turn_to_vector(&pool->characters[i], direction);
+    }
+}
+
+// 子弹和流场互不依赖:一个任务更新子弹,另一个任务用玩家移动后的位置为下一帧更新流场
+static void Simulation_BulletsJob(void *userData, int jobIndex, int workerIndex)
+{
+    Simulation *sim = (Simulation *)userData;
+    if (jobIndex == 0)
+    {
+        BulletPool_Update(sim->bullets, sim->characters);
+    }
+    else
+    {
+        Character *player = Simulation_GetPlayer(sim);
+        if (player) FlowField_Update(sim->flowField, (SDL_FPoint){player->body[0].x, player->body[0].y});
+    }
+}
+
+// 执行一个逻辑帧,每个阶段结束时记录耗时
+void Simulation_Tick(Simulation *sim, const SimulationInput *input)
+{
+    if (!sim || !sim->characters || !sim->bullets) return;
+    static const SimulationInput noInput = {0};
+    if (!input) input = &noInput;
+
+    Uint64 last = SDL_GetPerformanceCounter();
+    Uint64 now;
+    Character *player = Simulation_GetPlayer(sim);
+
+    // 渲染在这一帧开始和结束时的状态之间插值
+    CharacterPool_SavePrevious(sim->characters);
+
+    PROFILE_BEGIN(PROFILE_ZONE_AI);
+    if (player) Simulation_UpdatePlayer(sim, player, input);
+    now = SDL_GetPerformanceCounter();
+    sim->phaseTime[SIM_PHASE_PLAYER] += now - last;
+    last = now;
+
+    if (player) Simulation_UpdateAI(sim, player);
+    PROFILE_END(PROFILE_ZONE_AI);
+    now = SDL_GetPerformanceCounter();
+    sim->phaseTime[SIM_PHASE_AI] += now - last;
+    last = now;
+
+    // 角色池内部分为脊椎,碰撞,四肢三个区段
+    CharacterPool_Update(sim->characters, sim->jobs);
+    now = SDL_GetPerformanceCounter();
+    sim->phaseTime[SIM_PHASE_CHARACTERS] += now - last;
+    last = now;
+
+    PROFILE_BEGIN(PROFILE_ZONE_BULLETS);
+    JobSystem_ParallelFor(sim->jobs, sim->flowField ? 2 : 1, Simulation_BulletsJob, sim);
+    PROFILE_END(PROFILE_ZONE_BULLETS);
+    now = SDL_GetPerformanceCounter();
+    sim->phaseTime[SIM_PHASE_BULLETS] += now - last;
+    last = now;
+
+    PROFILE_BEGIN(PROFILE_ZONE_CLEANUP);
+    CharacterPool_Check_Enemy_HP(sim->characters, &sim->score);
+    PROFILE_END(PROFILE_ZONE_CLEANUP);
+    now = SDL_GetPerformanceCounter();
+    sim->phaseTime[SIM_PHASE_CLEANUP] += now - last;
+
+    sim->tickCount++;
+}
@@ -0,0 +1,184 @@
+#include "spatialGrid.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MIN_BUCKET_COUNT 64
+
+// 两个包围盒是否发生碰撞
+bool AABBBoxCollision(AABBBox a, AABBBox b) { return !(a.minY > b.maxY || a.minX > b.maxX || b.minY > a.maxY || b.minX > a.maxX); }
+
+AABBBox Rect_To_AABBBox(SDL_FRect rect) { return (AABBBox){rect.x, rect.x + rect.w, rect.y - rect.h, rect.y}; }
+SDL_FRect AABBBox_To_Rect(AABBBox box) { return (SDL_FRect){box.minX, box.minY, box.maxX - box.minX, box.maxY - box.minY}; }
+
+// 格子坐标的哈希值
+static inline int SpatialGrid_Hash(const SpatialGrid *grid, int cellX, int cellY) { return (int)(((unsigned)cellX * 73856093u ^ (unsigned)cellY * 19349663u) & (unsigned)(grid->bucketCount - 1)); }
+
+// 世界坐标转格子坐标
+static inline int SpatialGrid_Cell(const SpatialGrid *grid, float v) { return (int)floorf(v * grid->invCellSize); }
+
+// 初始化网格
+void SpatialGrid_Init(SpatialGrid *grid, float cellSize)
+{
+    if (!grid) return;
+    memset(grid, 0, sizeof(SpatialGrid));
+    grid->cellSize = cellSize > 0 ? cellSize : DEFALUT_GRID_CELL_SIZE;
+    grid->invCellSize = 1.0f / grid->cellSize;
+}
+
+// 释放网格内存
+void SpatialGrid_Destroy(SpatialGrid *grid)
+{
+    if (!grid) return;
+    free(grid->bucketStart);
+    free(grid->entries);
+    free(grid->firstCell);
+    memset(grid, 0, sizeof(SpatialGrid));
+}
+
+// 确保数组容量足够(按2倍增长)
+static bool SpatialGrid_Reserve(void **array, int *capacity, int required, size_t elementSize)
+{
+    if (required <= *capacity) return true;
+    int newCapacity = *capacity > 0 ? *capacity : 64;
+    while (newCapacity < required)
+    {
+        newCapacity *= 2;
+    }
+    void *newArray = realloc(*array, elementSize * newCapacity);
+    if (!newArray) return false;
+    *array = newArray;
+    *capacity = newCapacity;
+    return true;
+}
+
+// 用包围盒数组重建网格:先数每个桶的记录数,前缀和得到每个桶的位置,再倒序填入(计数排序,桶内物体编号保持升序)
+bool SpatialGrid_Build(SpatialGrid *grid, const AABBBox *boxes, int count)
+{
+    if (!grid || (!boxes && count > 0)) return false;
+    grid->objectCount = 0;
+    grid->entryCount = 0;
+    if (count <= 0) return true;
+
+    int bucketCount = MIN_BUCKET_COUNT;
+    while (bucketCount < count * 2)
+    {
+        bucketCount *= 2;
+    }
+    if (!SpatialGrid_Reserve((void **)&grid->bucketStart, &grid->bucketCapacity, bucketCount + 1, sizeof(int)) || !SpatialGrid_Reserve((void **)&grid->firstCell, &grid->objectCapacity, count * 2, sizeof(int)))
+    {
+        return false;
+    }
+    grid->bucketCount = bucketCount;
+    memset(grid->bucketStart, 0, sizeof(int) * (bucketCount + 1));
+
+    // 第一遍:统计每个桶的记录数
+    int entryCount = 0;
+    for (int i = 0; i < count; i++)
+    {
+        int x0 = SpatialGrid_Cell(grid, boxes[i].minX);
+        int x1 = SpatialGrid_Cell(grid, boxes[i].maxX);
+        int y0 = SpatialGrid_Cell(grid, boxes[i].minY);
+        int y1 = SpatialGrid_Cell(grid, boxes[i].maxY);
+        grid->firstCell[i * 2] = x0;
+        grid->firstCell[i * 2 + 1] = y0;
+        for (int cy = y0; cy <= y1; cy++)
+        {
+            for (int cx = x0; cx <= x1; cx++)
+            {
+                grid->bucketStart[SpatialGrid_Hash(grid, cx, cy)]++;
+                entryCount++;
+            }
+        }
+    }
+    if (!SpatialGrid_Reserve((void **)&grid->entries, &grid->entryCapacity, entryCount, sizeof(SpatialGridEntry)))
+    {
+        grid->bucketCount = 0;
+        return false;
+    }
+
+    // 前缀和:bucketStart[b]暂存桶b的结束位置
+    int sum = 0;
+    for (int b = 0; b < bucketCount; b++)
+    {
+        sum += grid->bucketStart[b];
+        grid->bucketStart[b] = sum;
+    }
+    grid->bucketStart[bucketCount] = sum;
+
+    // 第二遍:倒序填入,填完后bucketStart[b]正好是桶b的起始位置
+    for (int i = count - 1; i >= 0; i--)
+    {
+        int x0 = grid->firstCell[i * 2];
+        int y0 = grid->firstCell[i * 2 + 1];
+        int x1 = SpatialGrid_Cell(grid, boxes[i].maxX);
+        int y1 = SpatialGrid_Cell(grid, boxes[i].maxY);
+        for (int cy = y1; cy >= y0; cy--)
+        {
+            for (int cx = x1; cx >= x0; cx--)
+            {
+                int pos = --grid->bucketStart[SpatialGrid_Hash(grid, cx, cy)];
+                grid->entries[pos] = (SpatialGridEntry){i, cx, cy};
+            }
+        }
+    }
+
+    grid->objectCount = count;
+    grid->entryCount = entryCount;
+    return true;
+}
+
+// 开始查询
+void SpatialGrid_QueryBegin(const SpatialGrid *grid, AABBBox box, SpatialGridQuery *query)
+{
+    if (!query) return;
+    memset(query, 0, sizeof(SpatialGridQuery));
+    if (!grid || grid->objectCount == 0)
+    {
+        // 空网格:让第一次QueryNext直接结束
+        query->y0 = 1;
+        query->cy = 1;
+        return;
+    }
+    query->x0 = SpatialGrid_Cell(grid, box.minX);
+    query->x1 = SpatialGrid_Cell(grid, box.maxX);
+    query->y0 = SpatialGrid_Cell(grid, box.minY);
+    query->y1 = SpatialGrid_Cell(grid, box.maxY);
+    query->cx = query->x0 - 1; // 第一次QueryNext会前进到(x0,y0)
+    query->cy = query->y0;
+}
+
+// 获取下一个候选物体
+// 一个物体可能占据多个格子,只在它和查询范围重叠的第一个格子里返回它,这样不需要额外的标记数组
+int SpatialGrid_QueryNext(const SpatialGrid *grid, SpatialGridQuery *query)
+{
+    if (!grid || !query) return -1;
+
+    for (;;)
+    {
+        while (query->cursor < query->end)
+        {
+            const SpatialGridEntry *entry = &grid->entries[query->cursor++];
+            // 哈希冲突:记录属于别的格子
+            if (entry->cellX != query->cx || entry->cellY != query->cy) continue;
+            // 去重:只在重叠区域的第一个格子返回
+            int firstX = grid->firstCell[entry->index * 2];
+            int firstY = grid->firstCell[entry->index * 2 + 1];
+            if (query->cx != (firstX > query->x0 ? firstX : query->x0) || query->cy != (firstY > query->y0 ? firstY : query->y0)) continue;
+            return entry->index;
+        }
+
+        // 前进到下一个格子
+        query->cx++;
+        if (query->cx > query->x1)
+        {
+            query->cx = query->x0;
+            query->cy++;
+        }
+        if (query->cy > query->y1) return -1;
+
+        int bucket = SpatialGrid_Hash(grid, query->cx, query->cy);
+        query->cursor = grid->bucketStart[bucket];
+        query->end = grid->bucketStart[bucket + 1];
+    }
+}
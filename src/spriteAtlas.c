@@ -0,0 +1,98 @@
+#include "spriteAtlas.h"
+#include <SDL3_image/SDL_image.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// 加载图片并拼成图集
+SpriteAtlas *SpriteAtlas_Load(SDL_Renderer *renderer, const char *const paths[], int count)
+{
+    if (!renderer || !paths || count <= 0 || count > MAX_ATLAS_SPRITES) return NULL;
+
+    SpriteAtlas *atlas = (SpriteAtlas *)calloc(1, sizeof(SpriteAtlas));
+    if (!atlas) return NULL;
+
+    // 先加载所有图片并统一成RGBA格式,按行排好位置
+    SDL_Surface *surfaces[MAX_ATLAS_SPRITES] = {0};
+    SDL_Rect placement[MAX_ATLAS_SPRITES] = {0};
+    bool loaded = true;
+    int x = SPRITE_ATLAS_PADDING, y = SPRITE_ATLAS_PADDING, rowHeight = 0;
+    for (int i = 0; i < count; i++)
+    {
+        SDL_Surface *image = IMG_Load(paths[i]);
+        if (!image)
+        {
+            fprintf(stderr, "图片加载失败: %s\n", paths[i]);
+            loaded = false;
+            break;
+        }
+        surfaces[i] = SDL_ConvertSurface(image, SDL_PIXELFORMAT_RGBA32);
+        SDL_DestroySurface(image);
+        if (!surfaces[i] || surfaces[i]->w + 2 * SPRITE_ATLAS_PADDING > DEFALUT_SPRITE_ATLAS_WIDTH)
+        {
+            fprintf(stderr, "图片无法放进图集: %s\n", paths[i]);
+            loaded = false;
+            break;
+        }
+
+        if (x + surfaces[i]->w + SPRITE_ATLAS_PADDING > DEFALUT_SPRITE_ATLAS_WIDTH)
+        {
+            x = SPRITE_ATLAS_PADDING;
+            y += rowHeight + SPRITE_ATLAS_PADDING;
+            rowHeight = 0;
+        }
+        placement[i] = (SDL_Rect){x, y, surfaces[i]->w, surfaces[i]->h};
+        rowHeight = SDL_max(rowHeight, surfaces[i]->h);
+        x += surfaces[i]->w + SPRITE_ATLAS_PADDING;
+    }
+    int atlasHeight = y + rowHeight + SPRITE_ATLAS_PADDING;
+
+    // 拼到一张透明的表面上,直接复制像素
+    SDL_Surface *atlasSurface = loaded ? SDL_CreateSurface(DEFALUT_SPRITE_ATLAS_WIDTH, atlasHeight, SDL_PIXELFORMAT_RGBA32) : NULL;
+    if (atlasSurface)
+    {
+        SDL_FillSurfaceRect(atlasSurface, NULL, 0);
+        for (int i = 0; i < count; i++)
+        {
+            SDL_SetSurfaceBlendMode(surfaces[i], SDL_BLENDMODE_NONE);
+            SDL_BlitSurface(surfaces[i], NULL, atlasSurface, &placement[i]);
+
+            Sprite *sprite = &atlas->sprites[i];
+            sprite->width = (float)placement[i].w;
+            sprite->height = (float)placement[i].h;
+            sprite->uv = (SDL_FRect){(float)placement[i].x / DEFALUT_SPRITE_ATLAS_WIDTH, (float)placement[i].y / atlasHeight, (float)placement[i].w / DEFALUT_SPRITE_ATLAS_WIDTH, (float)placement[i].h / atlasHeight};
+        }
+        atlas->texture = SDL_CreateTextureFromSurface(renderer, atlasSurface);
+        SDL_DestroySurface(atlasSurface);
+    }
+    for (int i = 0; i < count; i++)
+    {
+        if (surfaces[i]) SDL_DestroySurface(surfaces[i]);
+    }
+
+    if (!atlas->texture)
+    {
+        fprintf(stderr, "精灵图集创建失败: %s\n", SDL_GetError());
+        free(atlas);
+        return NULL;
+    }
+    SDL_SetTextureScaleMode(atlas->texture, SDL_SCALEMODE_NEAREST);
+    SDL_SetTextureBlendMode(atlas->texture, SDL_BLENDMODE_BLEND);
+    atlas->count = count;
+    return atlas;
+}
+
+// 销毁图集和纹理
+void SpriteAtlas_Destroy(SpriteAtlas *atlas)
+{
+    if (!atlas) return;
+    if (atlas->texture) SDL_DestroyTexture(atlas->texture);
+    free(atlas);
+}
+
+// 画第index张图片(颜色为白色,保持图片原色)
+bool SpriteAtlas_Draw(const SpriteAtlas *atlas, BatchRenderer *batch, int index, SDL_FPoint pos, float angle, float scale)
+{
+    if (!atlas || !batch || index < 0 || index >= atlas->count) return false;
+    const Sprite *sprite = &atlas->sprites[index];
+    return Batch_AddSprite(batch, &sprite->uv, pos, sprite->width * scale, sprite->height * scale, angle, (SDL_FColor){1.0f, 1.0f, 1.0f, 1.0f}) >= 0;
+}
@@ -0,0 +1,198 @@
+#include "staticGeometry.h"
+#include "batchingRender.h"
+#include "polygon.h"
+#include <stdlib.h>
+#include <string.h>
+
+// 默认初始容量
+#define DEFAULT_STATIC_VERTEX_CAPACITY 256
+#define DEFAULT_STATIC_INDEX_CAPACITY 768
+#define DEFAULT_STATIC_MESH_CAPACITY 32
+
+// 剔除缓存
+#define STATIC_CULL_MARGIN 0.5f       // 剔除区域每边比视野多出视野大小的这个比例
+#define STATIC_CULL_SHRINK_RATIO 4.0f // 剔除区域比视野宽这么多倍时(放大了很多)重新剔除
+
+// 创建静态几何图层
+StaticGeometry *StaticGeometry_Create(void)
+{
+    StaticGeometry *layer = (StaticGeometry *)calloc(1, sizeof(StaticGeometry));
+    if (!layer) return NULL;
+
+    layer->vertices = (SDL_Vertex *)malloc(sizeof(SDL_Vertex) * DEFAULT_STATIC_VERTEX_CAPACITY);
+    layer->visibleVertices = (SDL_Vertex *)malloc(sizeof(SDL_Vertex) * DEFAULT_STATIC_VERTEX_CAPACITY);
+    layer->indices = (int *)malloc(sizeof(int) * DEFAULT_STATIC_INDEX_CAPACITY);
+    layer->visibleIndices = (int *)malloc(sizeof(int) * DEFAULT_STATIC_INDEX_CAPACITY);
+    layer->meshes = (StaticMesh *)malloc(sizeof(StaticMesh) * DEFAULT_STATIC_MESH_CAPACITY);
+    if (!layer->vertices || !layer->visibleVertices || !layer->indices || !layer->visibleIndices || !layer->meshes)
+    {
+        StaticGeometry_Destroy(layer);
+        return NULL;
+    }
+    layer->vertexCapacity = DEFAULT_STATIC_VERTEX_CAPACITY;
+    layer->indexCapacity = DEFAULT_STATIC_INDEX_CAPACITY;
+    layer->meshCapacity = DEFAULT_STATIC_MESH_CAPACITY;
+    return layer;
+}
+
+// 销毁静态几何图层
+void StaticGeometry_Destroy(StaticGeometry *layer)
+{
+    if (!layer) return;
+    free(layer->vertices);
+    free(layer->visibleVertices);
+    free(layer->indices);
+    free(layer->visibleIndices);
+    free(layer->meshes);
+    free(layer);
+}
+
+// 确保能再放下vertexCount个顶点,indexCount个索引和一个网格(按2倍增长)
+static bool StaticGeometry_Reserve(StaticGeometry *layer, int vertexCount, int indexCount)
+{
+    int vertexCapacity = layer->vertexCapacity;
+    while (vertexCapacity < layer->vertexCount + vertexCount) vertexCapacity *= 2;
+    if (vertexCapacity != layer->vertexCapacity)
+    {
+        SDL_Vertex *vertices = (SDL_Vertex *)realloc(layer->vertices, sizeof(SDL_Vertex) * vertexCapacity);
+        if (!vertices) return false;
+        layer->vertices = vertices;
+        SDL_Vertex *visibleVertices = (SDL_Vertex *)realloc(layer->visibleVertices, sizeof(SDL_Vertex) * vertexCapacity);
+        if (!visibleVertices) return false;
+        layer->visibleVertices = visibleVertices;
+        layer->vertexCapacity = vertexCapacity;
+    }
+
+    int indexCapacity = layer->indexCapacity;
+    while (indexCapacity < layer->indexCount + indexCount) indexCapacity *= 2;
+    if (indexCapacity != layer->indexCapacity)
+    {
+        int *indices = (int *)realloc(layer->indices, sizeof(int) * indexCapacity);
+        if (!indices) return false;
+        layer->indices = indices;
+        int *visibleIndices = (int *)realloc(layer->visibleIndices, sizeof(int) * indexCapacity);
+        if (!visibleIndices) return false;
+        layer->visibleIndices = visibleIndices;
+        layer->indexCapacity = indexCapacity;
+    }
+
+    if (layer->meshCount >= layer->meshCapacity)
+    {
+        StaticMesh *meshes = (StaticMesh *)realloc(layer->meshes, sizeof(StaticMesh) * layer->meshCapacity * 2);
+        if (!meshes) return false;
+        layer->meshes = meshes;
+        layer->meshCapacity *= 2;
+    }
+    return true;
+}
+
+// 注册一个简单多边形
+int StaticGeometry_AddPolygon(StaticGeometry *layer, const SDL_FPoint *points, int pointCount, SDL_FColor color)
+{
+    if (!layer || !points || pointCount < 3) return -1;
+    if (!StaticGeometry_Reserve(layer, pointCount, (pointCount - 2) * 3)) return -1;
+
+    // 三角化,索引直接写在图层的索引数组末尾
+    int *indices = &layer->indices[layer->indexCount];
+    int triangleCount = Polygon_Triangulate(points, pointCount, indices);
+    if (triangleCount <= 0) return -1;
+
+    StaticMesh *mesh = &layer->meshes[layer->meshCount];
+    mesh->firstVertex = layer->vertexCount;
+    mesh->vertexCount = pointCount;
+    mesh->firstIndex = layer->indexCount;
+    mesh->indexCount = triangleCount * 3;
+    mesh->bounds = (AABBBox){points[0].x, points[0].x, points[0].y, points[0].y};
+    for (int i = 0; i < pointCount; i++)
+    {
+        Batch_WriteVertex(&layer->vertices[mesh->firstVertex + i], points[i].x, points[i].y, color);
+        mesh->bounds.minX = SDL_min(mesh->bounds.minX, points[i].x);
+        mesh->bounds.maxX = SDL_max(mesh->bounds.maxX, points[i].x);
+        mesh->bounds.minY = SDL_min(mesh->bounds.minY, points[i].y);
+        mesh->bounds.maxY = SDL_max(mesh->bounds.maxY, points[i].y);
+    }
+    for (int i = 0; i < mesh->indexCount; i++)
+    {
+        indices[i] += mesh->firstVertex;
+    }
+    layer->vertexCount += pointCount;
+    layer->indexCount += mesh->indexCount;
+    layer->cacheValid = false;
+    return layer->meshCount++;
+}
+
+// 注册一个矩形
+int StaticGeometry_AddRect(StaticGeometry *layer, float x, float y, float width, float height, SDL_FColor color)
+{
+    const SDL_FPoint points[4] = {{x, y}, {x + width, y}, {x + width, y + height}, {x, y + height}};
+    return StaticGeometry_AddPolygon(layer, points, 4, color);
+}
+
+// 视野是否完全在缓存区域里,而且没有比缓存时小太多(放大很多倍后缩小缓存区域,少复制视野外的网格)
+static bool StaticGeometry_CacheCovers(const StaticGeometry *layer, AABBBox viewBox)
+{
+    const AABBBox *c = &layer->cullBox;
+    if (viewBox.minX < c->minX || viewBox.maxX > c->maxX || viewBox.minY < c->minY || viewBox.maxY > c->maxY) return false;
+    return (viewBox.maxX - viewBox.minX) * STATIC_CULL_SHRINK_RATIO >= c->maxX - c->minX;
+}
+
+// 用视野外扩一圈的区域剔除整个网格,把可见网格的世界坐标顶点和索引收集到一起
+static void StaticGeometry_Cull(StaticGeometry *layer, AABBBox viewBox)
+{
+    float marginX = (viewBox.maxX - viewBox.minX) * STATIC_CULL_MARGIN;
+    float marginY = (viewBox.maxY - viewBox.minY) * STATIC_CULL_MARGIN;
+    AABBBox cullBox = {viewBox.minX - marginX, viewBox.maxX + marginX, viewBox.minY - marginY, viewBox.maxY + marginY};
+
+    layer->visibleVertexCount = 0;
+    layer->visibleIndexCount = 0;
+    layer->visibleMeshCount = 0;
+    for (int m = 0; m < layer->meshCount; m++)
+    {
+        const StaticMesh *mesh = &layer->meshes[m];
+        if (!AABBBoxCollision(mesh->bounds, cullBox)) continue;
+
+        memcpy(&layer->visibleVertices[layer->visibleVertexCount], &layer->vertices[mesh->firstVertex], sizeof(SDL_Vertex) * mesh->vertexCount);
+        // 索引从图层里的位置改成紧凑数组里的位置
+        int offset = layer->visibleVertexCount - mesh->firstVertex;
+        int *dst = &layer->visibleIndices[layer->visibleIndexCount];
+        const int *src = &layer->indices[mesh->firstIndex];
+        for (int i = 0; i < mesh->indexCount; i++)
+        {
+            dst[i] = src[i] + offset;
+        }
+        layer->visibleVertexCount += mesh->vertexCount;
+        layer->visibleIndexCount += mesh->indexCount;
+        layer->visibleMeshCount++;
+    }
+
+    layer->cullBox = cullBox;
+    layer->cacheValid = true;
+}
+
+// 视野超出缓存区域时重新剔除,然后把可见顶点原样复制进世界批次
+bool StaticGeometry_AppendToBatch(StaticGeometry *layer, BatchRenderer *batch, AABBBox viewBox)
+{
+    if (!layer || !batch || !batch->worldSpace) return false;
+
+    if (!layer->cacheValid || !StaticGeometry_CacheCovers(layer, viewBox))
+    {
+        StaticGeometry_Cull(layer, viewBox);
+    }
+    if (layer->visibleIndexCount == 0) return true;
+
+    BatchSpan span;
+    if (!Batch_Reserve(batch, layer->visibleVertexCount, layer->visibleIndexCount, &span)) return false;
+    memcpy(span.vertices, layer->visibleVertices, sizeof(SDL_Vertex) * layer->visibleVertexCount);
+    for (int i = 0; i < layer->visibleIndexCount; i++)
+    {
+        span.indices[i] = layer->visibleIndices[i] + span.baseVertex;
+    }
+    return true;
+}
+
+// 获取统计
+void StaticGeometry_GetStats(const StaticGeometry *layer, int *meshCount, int *visibleMeshCount)
+{
+    if (meshCount) *meshCount = layer ? layer->meshCount : 0;
+    if (visibleMeshCount) *visibleMeshCount = layer ? layer->visibleMeshCount : 0;
+}
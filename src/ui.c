@@ -57,18 +57,8 @@ void UI_DrawRect(UIManager *manager, float x, float y, float width, float height
         // 使用批处理绘制填充矩形
         SDL_FPoint points[4] = {{x, y}, {x + width, y}, {x + width, y + height}, {x, y + height}};
 
-        // 转换为三角形并添加到批次
-        // 第一个三角形
-        SDL_FPoint p1 = points[0];
-        SDL_FPoint p2 = points[1];
-        SDL_FPoint p3 = points[2];
-        Batch_AddTriangle(manager->uiBatch, &p1, &p2, &p3, color);
-
-        // 第二个三角形
-        SDL_FPoint p4 = points[0];
-        SDL_FPoint p5 = points[2];
-        SDL_FPoint p6 = points[3];
-        Batch_AddTriangle(manager->uiBatch, &p4, &p5, &p6, color);
+        // 作为四边形添加到批次（4个顶点,2个三角形）
+        Batch_AddQuad(manager->uiBatch, &points[0], &points[1], &points[2], &points[3], color);
 
         manager->elementCount++;
     }
@@ -88,18 +78,15 @@ void UI_DrawCircle(UIManager *manager, float centerX, float centerY, float radiu
     const int segments = 32;
     float angleStep = 2.0f * M_PI / segments;
 
-    // 使用三角形扇形绘制圆形
+    // 使用三角形扇形绘制圆形(边缘点首尾相连)
+    SDL_FPoint center = {centerX, centerY};
+    SDL_FPoint rim[32];
     for (int i = 0; i < segments; i++)
     {
-        float angle1 = i * angleStep;
-        float angle2 = (i + 1) * angleStep;
-
-        SDL_FPoint center = {centerX, centerY};
-        SDL_FPoint p1 = {centerX + cosf(angle1) * radius, centerY + sinf(angle1) * radius};
-        SDL_FPoint p2 = {centerX + cosf(angle2) * radius, centerY + sinf(angle2) * radius};
-
-        Batch_AddTriangle(manager->uiBatch, &center, &p1, &p2, color);
+        float angle = i * angleStep;
+        rim[i] = (SDL_FPoint){centerX + cosf(angle) * radius, centerY + sinf(angle) * radius};
     }
+    Batch_AddFan(manager->uiBatch, &center, rim, segments, true, color);
 
     manager->elementCount++;
 }
@@ -31,6 +31,12 @@ Vector clockwise_90(Vector v) { return (Vector){v.y, -v.x}; }
 Vector counterclockwise_45(Vector v) { return (Vector){COS45 * (v.x - v.y), COS45 * (v.x + v.y)}; }
 
 Vector clockwise_45(Vector v) { return (Vector){COS45 * (v.x + v.y), COS45 * (v.y - v.x)}; }
+
+// 逆时针/顺时针转30度和60度(固定角度的旋转矩阵,不调用三角函数;cos60=sin30,sin60=cos30)
+Vector counterclockwise_30(Vector v) { return (Vector){COS30 * v.x - SIN30 * v.y, COS30 * v.y + SIN30 * v.x}; }
+Vector clockwise_30(Vector v) { return (Vector){COS30 * v.x + SIN30 * v.y, COS30 * v.y - SIN30 * v.x}; }
+Vector counterclockwise_60(Vector v) { return (Vector){SIN30 * v.x - COS30 * v.y, SIN30 * v.y + COS30 * v.x}; }
+Vector clockwise_60(Vector v) { return (Vector){SIN30 * v.x + COS30 * v.y, SIN30 * v.y - COS30 * v.x}; }
 Vector counterclockwise(Vector v, float angle)
 {
     float cosB = cosf(Angle_To_Rad(angle));
@@ -44,4 +50,7 @@ SDL_FPoint Get_FPoint_From_parametric_equation(const SDL_FPoint p0, Vector direc
 }
 
 // 角度转弧度
-inline float Angle_To_Rad(float angle) { return angle * 0.0174533; }
\ No newline at end of file
+inline float Angle_To_Rad(float angle) { return angle * 0.0174533; }
+
+// 线性插值
+SDL_FPoint Lerp_FPoint(SDL_FPoint a, SDL_FPoint b, float t) { return (SDL_FPoint){a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t}; }